@@ -4,11 +4,17 @@
  Author:	lesley wagner
 
  Description: Test for the FFT functions of the CMSIS DSP library.
+ At start up the FFTs are timed at 1024 to 8192 points in q15, q31 and f32, the results are printed as CSV
+ in the format of the host benchmark (Host/bench_main.cpp), so desk_light_bench --compare can read them.
+ After that every fft of the microphone input is sent as binary telemetry: the first harmonics as a spectrum
+ frame and the sampling and fft times as a profile frame, decode them with desk_light_telemetry.
 */
 
 #include "FastLED.h"
 #include "arm_math.h"
 #include "arm_const_structs.h"
+#include "Fft_Engine.h" // libraries/Desk_Light_Common, shared with Music_Reactive_Desk_Light
+#include "Telemetry_Writer.h"
 
 #define numLeds 117
 #define dataPin 14
@@ -21,24 +27,40 @@
 #define midUpper 1500 // mid upper frequency in Hz
 #define trebUpper 5000 // treble upper frequency in Hz
 #define fundamentalFreq 273 // fundamental frequency in deciHz
+#define N_HARMONICS 50 // bins sent per fft
+#define PROFILE_INTERVAL 32 // ffts between two profile frames
 
 
 
 double getAverage(short* samples);
 double getRms(short* samples);
+void benchmarkFft();
 
 CRGB leds[numLeds];
 short ledsOn; // number of leds that are turned on
 
 q15_t samples[N_SAMPLES];
 q15_t fftOutput[N_SAMPLES*2];
-q15_t frequencies[N_SAMPLES];
 
 double average;
 double rms;
 double peak;
 
-arm_rfft_instance_q15 fftInstance;
+Fft_Engine fft; // plan for fftLength is built once
+
+/*
+* Binary telemetry over the USB serial port, see Telemetry_Protocol.h of libraries/Desk_Light_Common
+*/
+class Serial_Port : public Telemetry_Port {
+public:
+    uint32_t writable() override { return Serial.availableForWrite(); }
+    uint32_t write(const uint8_t* data, uint32_t count) override { return Serial.write(data, count); }
+};
+
+Serial_Port serialPort;
+Telemetry_Writer telemetry;
+Stage_Profiler profiler; // sampling time as the copy stage, fft time as the fft stage
+uint32_t frameNumber = 0;
 
 void setup() {
     // put your setup code here, to run once:
@@ -51,13 +73,16 @@ void setup() {
 
     FastLED.addLeds<1, WS2813, dataPin, GRB>(leds, numLeds);
     Serial.begin(115200);
+    while (!Serial && millis() < 3000) {
+    }
     Serial.println("Hello");
+    benchmarkFft();
+    profiler.begin();
 }
 
 void loop() {
     // reading 100000 samples takes approximately 574 milliseconds
-    long micros1, micros2;
-    micros1 = micros();
+    uint32_t start = Stage_Profiler::now();
     // Sample window = 36.6 ms, fundamental frequency 27.3 Hz
     for (int i = 0; i < N_SAMPLES; i++) {
         delayMicroseconds(30);
@@ -68,80 +93,18 @@ void loop() {
         samples[i] = (analogRead(A1) - sampleBias) * 26; // scale samples to maximise resolution
         // samples[i] = arm_sin_q15((i*128) % 32768); // sample 4 periods of a sine wave
     }
-    micros2 = micros();
-    Serial.print("Time to compute fft: ");
-    Serial.println(micros2 - micros1);
-    
+    start = profiler.lap(PIPELINE_STAGE::COPY, start); // sampling time
 
     // peak = getPeak(samples);
-    // Serial.println(peak);
-    arm_rfft_init_q15(&fftInstance, fftLength, 0, 1);
-    arm_rfft_q15(&fftInstance, samples, fftOutput); // Q10.6 output format
-
-    /*Serial.println("Fundamental frequency: ");
-    Serial.print("Real: ");
-    Serial.println(fftOutput[2]); 
-    Serial.print("Imaginary: ");
-    Serial.println(fftOutput[3]);*/
-
-    q15_t max;
-    uint32_t maxIndex;
-    arm_max_q15(fftOutput, fftLength, &max, &maxIndex);
-    Serial.print("Max value in fft output: ");
-    Serial.println(max);
-    arm_cmplx_mag_q15(fftOutput, frequencies, N_SAMPLES); // output is in Q2,14 format
-
-    Serial.print("Fundamental frequency (170 Hz): ");
-    unsigned char* p1 = (unsigned char*)(frequencies + 1);
-    for (int i = (sizeof *frequencies) - 1; i >= 0; i--) {
-        Serial.print(p1[i], HEX);
-    }
-    Serial.println();
-
-    /*Serial.print("4th harmonic : ");
-    unsigned char* p2 = (unsigned char*)(frequencies + 4);
-    for (int i = (sizeof * frequencies) - 1; i >= 0; i--) {
-        Serial.print(p2[i], HEX);
-    }
-    Serial.println();
-
-    Serial.print("Real: ");
-    unsigned char* p3 = (unsigned char*)(fftOutput + 8);
-    for (int i = (sizeof * fftOutput) - 1; i >= 0; i--) {
-        Serial.print(p3[i], HEX);
-    }
-    Serial.println();
-    Serial.println(fftOutput[8]);
-    Serial.print("Imaginary: ");
-    unsigned char* p4 = (unsigned char*)(fftOutput + 9);
-    for (int i = (sizeof * fftOutput) - 1; i >= 0; i--) {
-        Serial.print(p4[i], HEX);
-    }
-    Serial.println(fftOutput[9]);*/
-
-    for (int i = 2; i < 50; i++) {
-        Serial.print("Harmonic ");
-        Serial.print(i);
-        Serial.print(": ");
-        unsigned char* p = (unsigned char*)(frequencies + i);
-        for (int j = (sizeof *frequencies) - 1; j >= 0 ; j--) {
-            Serial.print(p[j], HEX);
-        }
-        Serial.println();
-        /*Serial.print("Real: ");
+    fft.rfft(samples, fftOutput, fftLength); // Q10.6 output format
+    profiler.lap(PIPELINE_STAGE::FFT, start);
 
-        unsigned char* p5 = (unsigned char*)(fftOutput + 2*i);
-        for (int j = (sizeof * fftOutput) - 1; j >= 0; j--) {
-            Serial.print(p5[j], HEX);
-        }
-        Serial.println();
-        Serial.print("Imaginary: ");
-        unsigned char* p6 = (unsigned char*)(fftOutput + 2*i + 1);
-        for (int j = (sizeof * fftOutput) - 1; j >= 0; j--) {
-            Serial.print(p6[j], HEX);
-        }
-        Serial.println();*/
+    // the harmonics of the 27.3 Hz fundamental as one spectrum frame instead of hex dumps, desk_light_telemetry decodes it
+    telemetry.sendSpectrum(frameNumber, fftOutput, N_HARMONICS, fundamentalFreq * 100, 1);
+    if (++frameNumber % PROFILE_INTERVAL == 0) {
+        telemetry.sendProfile(profiler);
     }
+    telemetry.pump(serialPort);
 
     /*    ledsOn = numLeds * peak / maxPeak;
 
@@ -192,3 +155,97 @@ double getPeak(short* samples) {
     return sqrt(2 * sum / (long double)N_SAMPLES); // sqrt(2)*rms
 }
 
+
+/*
+ * Nanoseconds per call of run, fastest and median of 5 repetitions of iterations calls.
+ */
+template <class Function>
+void timeFft(const char* variant, uint32_t size, Function run) {
+    const uint32_t iterations = 20;
+    const uint8_t repetitions = 5;
+    float perCall[repetitions];
+    for (uint8_t r = 0; r < repetitions; r++) {
+        uint32_t start = ARM_DWT_CYCCNT;
+        for (uint32_t i = 0; i < iterations; i++) {
+            run();
+        }
+        uint32_t cycles = ARM_DWT_CYCCNT - start;
+        perCall[r] = cycles * (1e9f / F_CPU_ACTUAL) / iterations;
+    }
+    for (uint8_t i = 1; i < repetitions; i++) { // insertion sort
+        for (uint8_t j = i; j > 0 && perCall[j] < perCall[j - 1]; j--) {
+            float swap = perCall[j];
+            perCall[j] = perCall[j - 1];
+            perCall[j - 1] = swap;
+        }
+    }
+    Serial.printf("fft,%s,%u,%u,%.2f,%.2f,%.0f\n", variant, size, iterations, perCall[0], perCall[repetitions / 2],
+        size * 1e9f / perCall[repetitions / 2]);
+}
+
+/*
+ * Times the CMSIS real FFTs in every format and Fft_Engine at 1024 to 8192 points.
+ * The CMSIS q15 and q31 transforms use their input as scratch, so it's copied before every call, like for Fft_Engine.
+ * arm_rfft_fast_f32 doesn't support every size in older CMSIS versions, those sizes are skipped.
+ */
+void benchmarkFft() {
+    const uint32_t sizes[] = { 1024, 2048, 4096, 8192 };
+    const uint32_t maxSize = 8192;
+    q15_t* input15 = new q15_t[maxSize];
+    q15_t* scratch15 = new q15_t[maxSize];
+    q15_t* output15 = new q15_t[2 * maxSize];
+    q31_t* input31 = new q31_t[maxSize];
+    q31_t* scratch31 = new q31_t[maxSize];
+    q31_t* output31 = new q31_t[2 * maxSize];
+    float32_t* input32 = new float32_t[maxSize];
+    float32_t* scratch32 = new float32_t[maxSize];
+    float32_t* output32 = new float32_t[maxSize];
+    for (uint32_t i = 0; i < maxSize; i++) {
+        float value = 0.5f * sinf(2 * PI * 27 * i / 1024.0f) + 0.1f * sinf(2 * PI * 300 * i / 1024.0f);
+        input15[i] = (q15_t)(value * 32767);
+        input31[i] = (q31_t)(value * 2147483647.0f);
+        input32[i] = value;
+    }
+
+    Serial.println("name,variant,size,iterations,ns_min,ns_median,items_per_s");
+    for (uint32_t size : sizes) {
+        timeFft("engine_rfft_q15", size, [&]() {
+            memcpy(scratch15, input15, size * sizeof(q15_t));
+            fft.rfft(scratch15, output15, size);
+        });
+
+        arm_rfft_instance_q15 rfft15;
+        if (arm_rfft_init_q15(&rfft15, size, 0, 1) == ARM_MATH_SUCCESS) {
+            timeFft("cmsis_rfft_q15", size, [&]() {
+                memcpy(scratch15, input15, size * sizeof(q15_t));
+                arm_rfft_q15(&rfft15, scratch15, output15);
+            });
+        }
+
+        arm_rfft_instance_q31 rfft31;
+        if (arm_rfft_init_q31(&rfft31, size, 0, 1) == ARM_MATH_SUCCESS) {
+            timeFft("cmsis_rfft_q31", size, [&]() {
+                memcpy(scratch31, input31, size * sizeof(q31_t));
+                arm_rfft_q31(&rfft31, scratch31, output31);
+            });
+        }
+
+        arm_rfft_fast_instance_f32 rfft32;
+        if (arm_rfft_fast_init_f32(&rfft32, size) == ARM_MATH_SUCCESS) {
+            timeFft("cmsis_rfft_fast_f32", size, [&]() {
+                memcpy(scratch32, input32, size * sizeof(float32_t));
+                arm_rfft_fast_f32(&rfft32, scratch32, output32, 0);
+            });
+        }
+    }
+
+    delete[] input15;
+    delete[] scratch15;
+    delete[] output15;
+    delete[] input31;
+    delete[] scratch31;
+    delete[] output31;
+    delete[] input32;
+    delete[] scratch32;
+    delete[] output32;
+}
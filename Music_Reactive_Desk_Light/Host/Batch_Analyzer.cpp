@@ -0,0 +1,206 @@
+/*
+ Name:		Batch_Analyzer.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Offline analysis of many audio files on all cores.
+*/
+
+#include "Batch_Analyzer.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <set>
+
+Batch_Analyzer::Worker::Worker(bool fullFft) : pruned(fft), full(fft),
+pipeline(source, fullFft ? static_cast<Fft_Backend&>(full) : static_cast<Fft_Backend&>(pruned), sink), open_file(-1) {
+	sink.open(nullptr);
+}
+
+/* Constructor
+*   No files until add().
+*/
+Batch_Analyzer::Batch_Analyzer() : engine(ANALYSIS_ENGINE::FFT), full_fft(false), raw_rate(0), frames_per_job(1), total_samples(0), total_frames(0) {
+}
+
+bool Batch_Analyzer::begin(ANALYSIS_ENGINE analysis, bool fullFft, uint32_t rawSampleRate, double windowSeconds) {
+	engine = analysis;
+	full_fft = fullFft;
+	raw_rate = rawSampleRate;
+	const double frames = windowSeconds * Config::sampleRate / frameStride();
+	if (frames < 1) {
+		return false;
+	}
+	frames_per_job = frames > 1e6 ? 1000000 : (uint32_t)frames;
+	file_list.clear();
+	job_list.clear();
+	workers.clear();
+	total_samples = 0;
+	total_frames = 0;
+	return true;
+}
+
+/* Count the frames of the file and cut them in windows of frames_per_job
+*   The file is only mapped to get its length, the workers map it again.
+*/
+bool Batch_Analyzer::add(const char* path) {
+	File_Source source;
+	if (!source.open(path, raw_rate, Config::sampleRate)) {
+		return false;
+	}
+	const uint64_t length = source.length();
+	uint64_t frames = length < Config::fftSize ? 0 : (length - Config::fftSize) / frameStride() + 1;
+	if (frames > UINT32_MAX) {
+		return false;
+	}
+
+	File_Result result;
+	result.path = path;
+	result.frames = (uint32_t)frames;
+	result.levels.resize((size_t)frames * Config::numBands);
+	result.leds.resize((size_t)frames * Config::numLeds * 3);
+	file_list.push_back(std::move(result));
+
+	for (uint32_t first = 0; first < frames; first += frames_per_job) {
+		Job job;
+		job.file = (uint32_t)(file_list.size() - 1);
+		job.firstFrame = first;
+		job.frames = frames - first < frames_per_job ? (uint32_t)(frames - first) : frames_per_job;
+		job_list.push_back(job);
+	}
+	total_samples += length;
+	total_frames += frames;
+	return true;
+}
+
+/* Run the frames of a job from the first sample its first frame covers
+*   The pipeline is set up again for every job, so nothing carries over from the previous window.
+*/
+bool Batch_Analyzer::analyse(Worker& worker, const Job& job) {
+	File_Result& file = file_list[job.file];
+	if (worker.open_file != job.file) {
+		worker.open_file = -1;
+		if (!worker.source.open(file.path.c_str(), raw_rate, Config::sampleRate)) {
+			return false;
+		}
+		worker.open_file = job.file;
+	}
+	worker.source.seek((uint64_t)job.firstFrame * frameStride());
+
+	Audio_Pipeline<Config>& pipeline = worker.pipeline;
+	if (!pipeline.begin(engine, fftWindow, inputGain, goertzelFiltersPerBand)) {
+		return false;
+	}
+	pipeline.setMaxLevel(0, maxBass);
+	pipeline.setMaxLevel(1, maxMid);
+	pipeline.setMaxLevel(2, maxTreble);
+
+	uint32_t frame = job.firstFrame;
+	const uint32_t end = job.firstFrame + job.frames;
+	while (frame < end) {
+		if (!pipeline.process()) {
+			if (worker.source.finished()) {
+				return false; // the file is shorter than add() counted
+			}
+			continue;
+		}
+		q31_t* levels = &file.levels[(size_t)frame * Config::numBands];
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			levels[b] = pipeline.level(b);
+		}
+		uint8_t* rgb = &file.leds[(size_t)frame * Config::numLeds * 3];
+		const Rgb* leds = pipeline.ledFrame();
+		for (uint16_t i = 0; i < Config::numLeds; i++) {
+			rgb[3 * i] = leds[i].r;
+			rgb[3 * i + 1] = leds[i].g;
+			rgb[3 * i + 2] = leds[i].b;
+		}
+		frame++;
+	}
+	return true;
+}
+
+/* One set of stages per thread, created on first use and kept for later runs
+*
+*/
+bool Batch_Analyzer::run(Work_Stealing_Pool& pool, double& seconds) {
+	while (workers.size() < pool.threads()) {
+		workers.emplace_back(new Worker(full_fft));
+	}
+	for (std::unique_ptr<Worker>& worker : workers) {
+		worker->open_file = -1;
+	}
+
+	std::atomic<bool> failed(false);
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pool.run(job_list.size(), [&](unsigned worker, size_t task) {
+		if (!analyse(*workers[worker], job_list[task])) {
+			failed = true;
+		}
+	});
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return !failed;
+}
+
+/* Output name: the file name without directory and extension, a number is added if two files have the same name
+*
+*/
+bool Batch_Analyzer::write(const char* directory) const {
+	std::set<std::string> used;
+	for (size_t f = 0; f < file_list.size(); f++) {
+		const File_Result& file = file_list[f];
+		std::string name = file.path;
+		const size_t slash = name.find_last_of('/');
+		if (slash != std::string::npos) {
+			name = name.substr(slash + 1);
+		}
+		const size_t dot = name.find_last_of('.');
+		if (dot != std::string::npos && dot > 0) {
+			name = name.substr(0, dot);
+		}
+		if (!used.insert(name).second) {
+			name += "_" + std::to_string(f);
+			used.insert(name);
+		}
+		const std::string base = std::string(directory) + "/" + name;
+
+		FILE* binary = fopen((base + ".dlb").c_str(), "wb");
+		if (binary == nullptr) {
+			return false;
+		}
+		const Batch_Header header = { BATCH_MAGIC, BATCH_VERSION, Config::sampleRate, Config::fftSize, frameStride(),
+			Config::numBands, Config::numLeds, file.frames };
+		bool ok = fwrite(&header, sizeof(header), 1, binary) == 1;
+		for (uint32_t k = 0; ok && k < file.frames; k++) {
+			ok = fwrite(&file.levels[(size_t)k * Config::numBands], sizeof(q31_t), Config::numBands, binary) == Config::numBands
+				&& fwrite(&file.leds[(size_t)k * Config::numLeds * 3], 3, Config::numLeds, binary) == Config::numLeds;
+		}
+		ok = fclose(binary) == 0 && ok;
+		if (!ok) {
+			return false;
+		}
+
+		FILE* csv = fopen((base + ".csv").c_str(), "w");
+		if (csv == nullptr) {
+			return false;
+		}
+		fprintf(csv, "frame,seconds");
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			fprintf(csv, ",band_%u", b);
+		}
+		fprintf(csv, "\n");
+		for (uint32_t k = 0; k < file.frames; k++) {
+			// time of the newest sample of the frame
+			fprintf(csv, "%u,%.4f", k, ((double)k * frameStride() + Config::fftSize) / Config::sampleRate);
+			for (uint8_t b = 0; b < Config::numBands; b++) {
+				fprintf(csv, ",%d", (int)file.levels[(size_t)k * Config::numBands + b]);
+			}
+			fprintf(csv, "\n");
+		}
+		if (fclose(csv) != 0) {
+			return false;
+		}
+	}
+	return true;
+}
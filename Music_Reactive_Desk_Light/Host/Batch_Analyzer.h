@@ -0,0 +1,156 @@
+/*
+ Name:		Batch_Analyzer.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Offline analysis of many audio files on all cores. Every file is cut into windows
+ that are analysed independently, the results are the band levels and led frames of the desk light.
+*/
+#ifndef Batch_Analyzer_H
+#define Batch_Analyzer_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Fft_Engine.h"
+#include "Pruned_Rfft.h"
+#include "Full_Rfft.h"
+#include "File_Source.h"
+#include "File_Led_Sink.h"
+#include "Work_Stealing_Pool.h"
+
+#define BATCH_MAGIC 0x31424C44 // "DLB1" in a little endian file
+#define BATCH_VERSION 1
+
+/** Struct Batch_Header: start of a .dlb result file
+*
+*   All fields are little endian uint32. The header is followed by frames records of
+*   numBands int32 band levels (RMS bin magnitude with BAND_ENERGY_FRACTION_BITS fractional bits)
+*   and numLeds * 3 bytes r g b.
+*   Frame k is computed from the samples frameStride * k up to frameStride * k + fftSize.
+*/
+struct Batch_Header {
+	uint32_t magic; // BATCH_MAGIC
+	uint32_t version; // BATCH_VERSION
+	uint32_t sampleRate; // capture rate the file was resampled to
+	uint32_t fftSize;
+	uint32_t frameStride; // samples between frames, the hop or for the Goertzel engine the block
+	uint32_t numBands;
+	uint32_t numLeds;
+	uint32_t frames;
+};
+
+/** Class Batch_Analyzer: the pipeline of the desk light over a list of files, in parallel
+*
+*   Usage:
+*   \code
+*   Batch_Analyzer batch;
+*   batch.begin(ANALYSIS_ENGINE::FFT, false, 0, 30);
+*   batch.add("song.wav");
+*   Work_Stealing_Pool pool(8);
+*   double seconds;
+*   batch.run(pool, seconds);
+*   batch.write("results");
+*   \endcode
+*   A frame only depends on the fftSize samples it covers: the STFT history starts zeroed, fills
+*   during the first fftSize samples and every later hop replaces the oldest one. So reading a window
+*   from the first sample of its first frame gives the same frames as reading the file from the start,
+*   and the result doesn't depend on the number of threads or the window length.
+*   Every worker has its own source, FFT and pipeline, workers only share the read only file mappings.
+*/
+class Batch_Analyzer {
+
+public:
+
+	//! Constructor
+	Batch_Analyzer();
+
+	//! Set the analysis of all files
+	/** \param analysis analysis engine.
+	*   \param fullFft use the full size FFT instead of the pruned FFT.
+	*   \param rawSampleRate sample rate of raw PCM files.
+	*   \param windowSeconds audio per task, the last window of a file can be shorter.
+	*   \return false if the window is shorter than a frame.
+	*/
+	bool begin(ANALYSIS_ENGINE analysis, bool fullFft, uint32_t rawSampleRate, double windowSeconds);
+
+	//! Add a file to the batch
+	/** \return false if the file can't be read.
+	*/
+	bool add(const char* path);
+
+	//! Analyse all files
+	/** \param pool runs the windows, one set of stages per thread of the pool.
+	*   \param seconds time taken.
+	*   \return false if a window couldn't be analysed.
+	*/
+	bool run(Work_Stealing_Pool& pool, double& seconds);
+
+	//! Write name.dlb and name.csv for every file
+	/** \param directory output directory, must exist.
+	*   \return false if a file can't be written.
+	*/
+	bool write(const char* directory) const;
+
+	//! Number of files
+	size_t files() const { return file_list.size(); }
+
+	//! Number of windows
+	size_t windows() const { return job_list.size(); }
+
+	//! Number of samples at the capture rate in all files
+	uint64_t samples() const { return total_samples; }
+
+	//! Number of frames in all files
+	uint64_t frames() const { return total_frames; }
+
+private:
+	//! A file and its results
+	struct File_Result {
+		std::string path;
+		uint32_t frames;
+		std::vector<q31_t> levels; // frames * numBands
+		std::vector<uint8_t> leds; // frames * numLeds * 3
+	};
+
+	//! Frames firstFrame up to firstFrame + frames of a file
+	struct Job {
+		uint32_t file;
+		uint32_t firstFrame;
+		uint32_t frames;
+	};
+
+	//! Stages of one thread
+	struct Worker {
+		Worker(bool fullFft);
+
+		File_Source source;
+		File_Led_Sink sink; // only counts, the frames are copied from the pipeline
+		Fft_Engine fft;
+		Pruned_Rfft pruned;
+		Full_Rfft full;
+		Audio_Pipeline<Config> pipeline;
+		int64_t open_file; // file mapped by source, -1 for none
+	};
+
+	//! Analyse the window of a job
+	bool analyse(Worker& worker, const Job& job);
+
+	//! Samples between frames
+	uint32_t frameStride() const { return engine == ANALYSIS_ENGINE::GOERTZEL ? Config::fftSize : Config::hopSize; }
+
+	ANALYSIS_ENGINE engine;
+	bool full_fft;
+	uint32_t raw_rate;
+	uint32_t frames_per_job;
+
+	std::vector<File_Result> file_list;
+	std::vector<Job> job_list;
+	std::vector<std::unique_ptr<Worker>> workers;
+	uint64_t total_samples;
+	uint64_t total_frames;
+};
+
+#endif // Batch_Analyzer_H
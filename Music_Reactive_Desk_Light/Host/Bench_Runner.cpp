@@ -0,0 +1,129 @@
+/*
+ Name:		Bench_Runner.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Timing of benchmark cases with machine readable results.
+*/
+
+#include "Bench_Runner.h"
+#include <string.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+
+Bench_Runner::Bench_Runner(uint32_t repetitions, double minSeconds, const char* filter) :
+	repetitions(repetitions > 0 ? repetitions : 1), min_seconds(minSeconds), filter(filter != nullptr ? filter : "") {
+}
+
+//! Seconds to run body iterations times
+static double timeIterations(const std::function<void()>& body, uint64_t iterations) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (uint64_t i = 0; i < iterations; i++) {
+		body();
+	}
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/* Calibrate, then time the repetitions
+*   The calibration runs double as warm up of the caches and the plan tables.
+*/
+void Bench_Runner::run(const char* name, const char* variant, uint32_t size, uint32_t items, const std::function<void()>& body) {
+	const std::string id = std::string(name) + "/" + variant;
+	if (!filter.empty() && id.find(filter) == std::string::npos) {
+		return;
+	}
+
+	uint64_t iterations = 1;
+	while (timeIterations(body, iterations) < min_seconds && iterations < (1ull << 40)) {
+		iterations *= 2;
+	}
+
+	std::vector<double> perIteration(repetitions);
+	for (uint32_t r = 0; r < repetitions; r++) {
+		perIteration[r] = timeIterations(body, iterations) * 1e9 / iterations;
+	}
+	std::sort(perIteration.begin(), perIteration.end());
+
+	Bench_Result result;
+	result.name = name;
+	result.variant = variant;
+	result.size = size;
+	result.iterations = iterations;
+	result.nsMin = perIteration.front();
+	result.nsMedian = perIteration[repetitions / 2];
+	result.itemsPerSecond = result.nsMedian > 0 ? items * 1e9 / result.nsMedian : 0;
+	result_list.push_back(result);
+	fprintf(stderr, "%-12s %-22s %6u %12.1f ns\n", name, variant, size, result.nsMedian);
+}
+
+void Bench_Runner::print(FILE* file, BENCH_FORMAT format) const {
+	if (format == BENCH_FORMAT::CSV) {
+		fprintf(file, "name,variant,size,iterations,ns_min,ns_median,items_per_s\n");
+		for (const Bench_Result& result : result_list) {
+			fprintf(file, "%s,%s,%u,%llu,%.2f,%.2f,%.0f\n", result.name.c_str(), result.variant.c_str(), result.size,
+				(unsigned long long)result.iterations, result.nsMin, result.nsMedian, result.itemsPerSecond);
+		}
+		return;
+	}
+
+	fprintf(file, "[\n");
+	for (size_t i = 0; i < result_list.size(); i++) {
+		const Bench_Result& result = result_list[i];
+		fprintf(file, "  {\"name\": \"%s\", \"variant\": \"%s\", \"size\": %u, \"iterations\": %llu, \"ns_min\": %.2f, \"ns_median\": %.2f, \"items_per_s\": %.0f}%s\n",
+			result.name.c_str(), result.variant.c_str(), result.size, (unsigned long long)result.iterations, result.nsMin,
+			result.nsMedian, result.itemsPerSecond, i + 1 < result_list.size() ? "," : "");
+	}
+	fprintf(file, "]\n");
+}
+
+/* Read name, variant, size and ns_median of every line after the header
+*   Cases without a baseline are listed as new and don't count as regressions.
+*/
+bool Bench_Runner::compare(const char* path, double tolerance, uint32_t& regressions) const {
+	FILE* file = fopen(path, "r");
+	if (file == nullptr) {
+		return false;
+	}
+	std::vector<Bench_Result> baseline;
+	char line[512];
+	bool header = true;
+	while (fgets(line, sizeof(line), file) != nullptr) {
+		if (header) {
+			header = false;
+			continue;
+		}
+		char name[128];
+		char variant[128];
+		Bench_Result result;
+		unsigned long long iterations;
+		if (sscanf(line, "%127[^,],%127[^,],%u,%llu,%lf,%lf", name, variant, &result.size, &iterations, &result.nsMin, &result.nsMedian) == 6) {
+			result.name = name;
+			result.variant = variant;
+			baseline.push_back(result);
+		}
+	}
+	fclose(file);
+
+	regressions = 0;
+	fprintf(stdout, "name,variant,size,baseline_ns,ns,ratio,status\n");
+	for (const Bench_Result& result : result_list) {
+		const Bench_Result* before = nullptr;
+		for (const Bench_Result& candidate : baseline) {
+			if (candidate.name == result.name && candidate.variant == result.variant && candidate.size == result.size) {
+				before = &candidate;
+				break;
+			}
+		}
+		if (before == nullptr) {
+			fprintf(stdout, "%s,%s,%u,,%.2f,,new\n", result.name.c_str(), result.variant.c_str(), result.size, result.nsMedian);
+			continue;
+		}
+		const double ratio = before->nsMedian > 0 ? result.nsMedian / before->nsMedian : 1;
+		const bool slower = ratio > 1 + tolerance;
+		regressions += slower ? 1 : 0;
+		fprintf(stdout, "%s,%s,%u,%.2f,%.2f,%.3f,%s\n", result.name.c_str(), result.variant.c_str(), result.size, before->nsMedian,
+			result.nsMedian, ratio, slower ? "slower" : (ratio < 1 - tolerance ? "faster" : "same"));
+	}
+	return true;
+}
@@ -0,0 +1,97 @@
+/*
+ Name:		Bench_Runner.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Timing of benchmark cases with machine readable results and a comparison against a
+ previous run, for catching performance regressions between commits.
+*/
+#ifndef Bench_Runner_H
+#define Bench_Runner_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+//! Keep a value the compiler would otherwise drop as unused
+template <class T>
+inline void benchKeep(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+//! Output formats
+enum class BENCH_FORMAT : uint8_t {
+	CSV,
+	JSON
+};
+
+/** Struct Bench_Result: timing of one case
+*
+*   A case is identified by name, variant and size, e.g. fft, pruned_q15, 8192.
+*/
+struct Bench_Result {
+	std::string name;
+	std::string variant;
+	uint32_t size;
+	uint64_t iterations; // per repetition
+	double nsMin; // per iteration, fastest repetition
+	double nsMedian; // per iteration, median of the repetitions
+	double itemsPerSecond; // items per iteration / nsMedian, the item is given by the case (samples, leds, ...)
+};
+
+/** Class Bench_Runner: runs cases and collects their results
+*
+*   Usage:
+*   \code
+*   Bench_Runner bench(9, 0.01, "");
+*   bench.run("fft", "pruned_q15", 8192, 8192, [&]() { backend.transform(input, output); benchKeep(output[0]); });
+*   bench.print(stdout, BENCH_FORMAT::CSV);
+*   \endcode
+*   Every case is first calibrated: the number of iterations is doubled until a repetition takes
+*   minSeconds. Then it is repeated, the median is the figure to compare, the minimum shows the noise.
+*/
+class Bench_Runner {
+
+public:
+
+	//! Constructor
+	/** \param repetitions timed repetitions per case.
+	*   \param minSeconds minimum time of a repetition.
+	*   \param filter only cases with this text in "name/variant" run, empty for all.
+	*/
+	Bench_Runner(uint32_t repetitions, double minSeconds, const char* filter);
+
+	//! Time a case
+	/** \param name group of the case.
+	*   \param variant implementation or setting.
+	*   \param size problem size, e.g. FFT points.
+	*   \param items items per iteration for the throughput.
+	*   \param body one iteration.
+	*/
+	void run(const char* name, const char* variant, uint32_t size, uint32_t items, const std::function<void()>& body);
+
+	//! Write all results
+	void print(FILE* file, BENCH_FORMAT format) const;
+
+	//! Compare the results with an earlier CSV output
+	/** Prints the ratio of the medians per case found in both.
+	*   \param path CSV file written by print().
+	*   \param tolerance allowed slowdown, 0.1 for 10 %.
+	*   \param regressions number of cases slower than the tolerance.
+	*   \return false if the file can't be read.
+	*/
+	bool compare(const char* path, double tolerance, uint32_t& regressions) const;
+
+	//! Results so far
+	const std::vector<Bench_Result>& results() const { return result_list; }
+
+private:
+	uint32_t repetitions;
+	double min_seconds;
+	std::string filter;
+	std::vector<Bench_Result> result_list;
+};
+
+#endif // Bench_Runner_H
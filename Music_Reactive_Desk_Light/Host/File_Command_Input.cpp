@@ -0,0 +1,54 @@
+/*
+ Name:		File_Command_Input.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Non-blocking command input from a file descriptor.
+*/
+
+#include "File_Command_Input.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+File_Command_Input::File_Command_Input() : fd(-1), buffer{}, fill(0), position(0) {
+}
+
+File_Command_Input::~File_Command_Input() {
+	close();
+}
+
+/* O_NONBLOCK also keeps open() of a fifo from waiting for a writer
+*
+*/
+bool File_Command_Input::open(const char* path) {
+	close();
+	fd = ::open(path, O_RDONLY | O_NONBLOCK | O_NOCTTY);
+	return fd >= 0;
+}
+
+void File_Command_Input::close() {
+	if (fd >= 0) {
+		::close(fd);
+	}
+	fd = -1;
+	fill = 0;
+	position = 0;
+}
+
+/* Refill the buffer when it is empty, one read() of what the descriptor has
+*   EAGAIN (nothing written yet), the end of a file and a closed terminal all read as -1.
+*/
+int File_Command_Input::read() {
+	if (position == fill) {
+		if (fd < 0) {
+			return -1;
+		}
+		const ssize_t count = ::read(fd, buffer, sizeof(buffer));
+		if (count <= 0) {
+			return -1;
+		}
+		fill = (uint32_t)count;
+		position = 0;
+	}
+	return buffer[position++];
+}
@@ -0,0 +1,46 @@
+/*
+ Name:		File_Command_Input.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Command input for the host build: a file, a fifo or a pseudo-terminal, read without blocking.
+*/
+#ifndef File_Command_Input_H
+#define File_Command_Input_H
+
+#include <stdint.h>
+#include "Command_Channel.h"
+
+/** Class File_Command_Input: commands from a file descriptor in non-blocking mode
+*
+*   A pseudo-terminal (e.g. one end of socat -d -d pty,raw,echo=0 pty,raw,echo=0) or a fifo behaves like
+*   the serial port of the desk light: read() returns -1 until the other side writes a line.
+*/
+class File_Command_Input : public Command_Input {
+
+public:
+
+	//! Constructor
+	File_Command_Input();
+
+	~File_Command_Input();
+
+	//! Open the input
+	/** \param path file, fifo or terminal device.
+	*   \return false if it can't be opened.
+	*/
+	bool open(const char* path);
+
+	//! Close the input
+	void close();
+
+	int read() override;
+
+private:
+	int fd;
+	uint8_t buffer[256];
+	uint32_t fill; // bytes in buffer
+	uint32_t position; // next byte of buffer
+};
+
+#endif // File_Command_Input_H
@@ -0,0 +1,50 @@
+/*
+ Name:		File_Led_Sink.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Led sink for the host build, writes every frame to a file.
+*/
+
+#include "File_Led_Sink.h"
+
+/* Constructor
+*   Counts frames until a file is opened.
+*/
+File_Led_Sink::File_Led_Sink() : file(nullptr), frame_count(0) {
+}
+
+File_Led_Sink::~File_Led_Sink() {
+	close();
+}
+
+void File_Led_Sink::close() {
+	if (file != nullptr) {
+		fclose(file);
+		file = nullptr;
+	}
+}
+
+bool File_Led_Sink::open(const char* path) {
+	close();
+	frame_count = 0;
+	if (path == nullptr) {
+		return true;
+	}
+	file = fopen(path, "wb");
+	return file != nullptr;
+}
+
+/* Write r g b of every led
+*
+*/
+void File_Led_Sink::show(const Rgb* leds, uint16_t count) {
+	frame_count++;
+	if (file == nullptr) {
+		return;
+	}
+	for (uint16_t i = 0; i < count; i++) {
+		const uint8_t rgb[3] = { leds[i].r, leds[i].g, leds[i].b };
+		fwrite(rgb, 1, sizeof(rgb), file);
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ Name:		File_Led_Sink.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Led sink for the host build, writes every frame to a file.
+*/
+#ifndef File_Led_Sink_H
+#define File_Led_Sink_H
+
+#include <stdio.h>
+#include "Led_Sink.h"
+
+/** Class File_Led_Sink: led frames to a file
+*
+*   Every frame is count * 3 bytes, r g b per led, frames follow each other without separator.
+*   Without a file the frames are only counted, for timing the pipeline without I/O.
+*/
+class File_Led_Sink : public Led_Sink {
+
+public:
+
+	//! Constructor
+	File_Led_Sink();
+
+	~File_Led_Sink();
+
+	//! Create the output file
+	/** \param path output file, nullptr to only count frames.
+	*   \return false if the file can't be created.
+	*/
+	bool open(const char* path);
+
+	//! Close the file
+	void close();
+
+	void show(const Rgb* leds, uint16_t count) override;
+
+	//! Number of frames received
+	uint32_t frames() const { return frame_count; }
+
+private:
+	FILE* file;
+	uint32_t frame_count;
+};
+
+#endif // File_Led_Sink_H
@@ -0,0 +1,251 @@
+/*
+ Name:		File_Source.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Sample source for the host build, memory maps a WAV file or raw 16 bit PCM.
+*/
+
+#include "File_Source.h"
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static_assert(FILE_SOURCE_PHASES == 256, "the phase is the top 8 bits of the fraction of the position");
+
+/* Constructor
+*   No file until open().
+*/
+File_Source::File_Source() : mapping(nullptr), mapping_size(0), data(nullptr), frame_count(0), channels(1), file_rate(0), output_rate(0),
+resample(false), position(0), step(1ull << 32), samples_read(0), at_end(true) {
+}
+
+File_Source::~File_Source() {
+	close();
+}
+
+void File_Source::close() {
+	if (mapping != nullptr) {
+		munmap((void*)mapping, mapping_size);
+		mapping = nullptr;
+	}
+	data = nullptr;
+	frame_count = 0;
+	at_end = true;
+}
+
+/* Map the whole file read only and find the samples
+*   The kernel is told the file is read sequentially, so it reads ahead.
+*/
+bool File_Source::open(const char* path, uint32_t rawSampleRate, uint32_t captureRate) {
+	close();
+
+	const int descriptor = ::open(path, O_RDONLY);
+	if (descriptor < 0) {
+		return false;
+	}
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+		::close(descriptor);
+		return false;
+	}
+	void* address = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	::close(descriptor); // the mapping stays valid
+	if (address == MAP_FAILED) {
+		return false;
+	}
+	mapping = (const uint8_t*)address;
+	mapping_size = (size_t)status.st_size;
+	madvise(address, mapping_size, MADV_SEQUENTIAL);
+
+	// the magic, not the name: TRACK.WAV or a WAV without extension would otherwise be played as raw noise.
+	// A RIFF file that isn't a complete 16 bit WAVE is rejected rather than played as raw samples.
+	if (mapping_size >= 4 && memcmp(mapping, "RIFF", 4) == 0) {
+		if (!parseWav(mapping, mapping_size)) {
+			close();
+			return false;
+		}
+	}
+	else {
+		if (rawSampleRate == 0) {
+			close();
+			return false;
+		}
+		file_rate = rawSampleRate;
+		channels = 1;
+		data = (const int16_t*)mapping;
+		frame_count = mapping_size / sizeof(int16_t);
+	}
+
+	output_rate = captureRate != 0 ? captureRate : file_rate;
+	resample = output_rate != file_rate;
+	step = ((uint64_t)file_rate << 32) / output_rate;
+	position = 0;
+	samples_read = 0;
+	at_end = frame_count == 0;
+	if (resample) {
+		buildFilter();
+	}
+	return true;
+}
+
+//! Little endian values from the header
+static uint32_t littleEndian32(const uint8_t* bytes) {
+	return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+static uint16_t littleEndian16(const uint8_t* bytes) {
+	return (uint16_t)(bytes[0] | (bytes[1] << 8));
+}
+
+/* RIFF header, then chunks of id + size + data. The fmt chunk has to come before the data chunk.
+*   Only PCM (format 1, or WAVE_FORMAT_EXTENSIBLE) with 16 bits per sample is supported.
+*   Chunks are padded to an even size, so the samples are always 16 bit aligned in the mapping.
+*/
+bool File_Source::parseWav(const uint8_t* file, size_t size) {
+	if (size < 12 || memcmp(file, "RIFF", 4) != 0 || memcmp(file + 8, "WAVE", 4) != 0) {
+		return false;
+	}
+
+	bool haveFormat = false;
+	size_t offset = 12;
+	while (offset + 8 <= size) {
+		const uint8_t* chunk = file + offset;
+		const uint32_t chunkSize = littleEndian32(chunk + 4);
+		const uint8_t* body = chunk + 8;
+		const size_t available = size - offset - 8;
+
+		if (memcmp(chunk, "fmt ", 4) == 0) {
+			if (chunkSize < 16 || available < 16) {
+				return false;
+			}
+			const uint16_t tag = littleEndian16(body);
+			channels = littleEndian16(body + 2);
+			file_rate = littleEndian32(body + 4);
+			const uint16_t bits = littleEndian16(body + 14);
+			if ((tag != 1 && tag != 0xFFFE) || bits != 16 || channels == 0 || file_rate == 0) {
+				return false;
+			}
+			haveFormat = true;
+		}
+		else if (memcmp(chunk, "data", 4) == 0) {
+			if (!haveFormat) {
+				return false;
+			}
+			const size_t bytes = chunkSize < available ? chunkSize : available; // a truncated file is read up to its end
+			data = (const int16_t*)body;
+			frame_count = bytes / (channels * sizeof(int16_t));
+			return true;
+		}
+		offset += 8 + (size_t)chunkSize + (chunkSize & 1);
+	}
+	return false;
+}
+
+/* Windowed sinc low pass, one row of taps per fractional position
+*   Row p is used for positions p / PHASES past an input frame, tap k then sits at input frame k - TAPS / 2 + 1.
+*   The cutoff is 90 % of the lower of the two Nyquist frequencies, every row is normalised to a gain of 1.
+*/
+void File_Source::buildFilter() {
+	const double cutoff = 0.9 * (output_rate < file_rate ? (double)output_rate / file_rate : 1.0); // relative to the file's Nyquist frequency
+	const double halfSpan = FILE_SOURCE_TAPS / 2.0;
+	filter.assign(FILE_SOURCE_PHASES * FILE_SOURCE_TAPS, 0.0f);
+
+	for (uint32_t p = 0; p < FILE_SOURCE_PHASES; p++) {
+		const double fraction = (double)p / FILE_SOURCE_PHASES;
+		double sum = 0;
+		double taps[FILE_SOURCE_TAPS];
+		for (uint32_t k = 0; k < FILE_SOURCE_TAPS; k++) {
+			const double distance = (double)k - (FILE_SOURCE_TAPS / 2 - 1) - fraction; // input frame - position
+			const double x = M_PI * cutoff * distance;
+			const double sinc = distance == 0 ? 1.0 : sin(x) / x;
+			const double w = 0.42 + 0.5 * cos(M_PI * distance / halfSpan) + 0.08 * cos(2 * M_PI * distance / halfSpan); // Blackman
+			taps[k] = fabs(distance) < halfSpan ? sinc * w : 0;
+			sum += taps[k];
+		}
+		for (uint32_t k = 0; k < FILE_SOURCE_TAPS; k++) {
+			filter[p * FILE_SOURCE_TAPS + k] = (float)(taps[k] / sum);
+		}
+	}
+}
+
+/* Mono value of a frame, the channels are averaged
+*
+*/
+float File_Source::frame(int64_t index) const {
+	if (index < 0 || (uint64_t)index >= frame_count) {
+		return 0;
+	}
+	const int16_t* samples = data + index * channels;
+	int32_t sum = 0;
+	for (uint16_t c = 0; c < channels; c++) {
+		sum += samples[c];
+	}
+	return (float)sum / channels;
+}
+
+uint64_t File_Source::framesConsumed() const {
+	const uint64_t consumed = position >> 32;
+	return consumed < frame_count ? consumed : frame_count;
+}
+
+/* Output samples k with k * step < frame_count in 32.32 fixed point
+*
+*/
+uint64_t File_Source::length() const {
+	const uint64_t end = frame_count << 32;
+	return (end + step - 1) / step;
+}
+
+void File_Source::seek(uint64_t sample) {
+	position = sample * step;
+	at_end = (position >> 32) >= frame_count;
+}
+
+/* Convert samples from the mapping, resampled if needed
+*   16 bit samples become 12 bit ADC counts.
+*/
+uint32_t File_Source::read(q15_t* samples, uint32_t count) {
+	if (at_end) {
+		return 0;
+	}
+
+	uint32_t done = 0;
+	if (!resample) {
+		uint64_t index = position >> 32;
+		while (done < count && index < frame_count) {
+			const int16_t* frameSamples = data + index * channels;
+			int32_t sum = 0;
+			for (uint16_t c = 0; c < channels; c++) {
+				sum += frameSamples[c];
+			}
+			samples[done++] = (q15_t)((sum / channels) >> 4);
+			index++;
+		}
+		position = index << 32;
+		at_end = index >= frame_count;
+	}
+	else {
+		while (done < count) {
+			const int64_t index = (int64_t)(position >> 32);
+			if ((uint64_t)index >= frame_count) {
+				at_end = true;
+				break;
+			}
+			const float* taps = &filter[((position >> 24) & (FILE_SOURCE_PHASES - 1)) * FILE_SOURCE_TAPS];
+			const int64_t first = index - (FILE_SOURCE_TAPS / 2 - 1);
+			float value = 0;
+			for (uint32_t k = 0; k < FILE_SOURCE_TAPS; k++) {
+				value += taps[k] * frame(first + k);
+			}
+			long adc = lrintf(value / 16); // 16 bit to 12 bit ADC counts
+			samples[done++] = (q15_t)(adc > 32767 ? 32767 : (adc < -32768 ? -32768 : adc));
+			position += step;
+		}
+	}
+	samples_read += done;
+	return done;
+}
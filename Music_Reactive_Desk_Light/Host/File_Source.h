@@ -0,0 +1,105 @@
+/*
+ Name:		File_Source.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Sample source for the host build, memory maps a WAV file or raw 16 bit PCM and
+ resamples it to the capture rate of the desk light if needed.
+*/
+#ifndef File_Source_H
+#define File_Source_H
+
+#include <stddef.h>
+#include <vector>
+#include "Sample_Source.h"
+
+#define FILE_SOURCE_TAPS 16 // taps of the resampling filter
+#define FILE_SOURCE_PHASES 256 // fractional positions of the resampling filter
+
+/** Class File_Source: audio file as a stream of ADC samples
+*
+*   Supported are WAV files with 16 bit PCM (channels are mixed to mono) and headerless
+*   16 bit little endian mono PCM, for which the sample rate has to be given. The format is told by the
+*   RIFF WAVE magic at the start of the file, not by the name.
+*   The file is memory mapped, read() converts straight from the mapping into the caller's buffer,
+*   there is no read buffer and no system call per block.
+*   The 16 bit samples are scaled to the 12 bit ADC range of the desk light (>> 4),
+*   so the gain and the led levels of the sketch apply unchanged.
+*   When the file has another rate than the capture rate, a polyphase windowed sinc filter
+*   (FILE_SOURCE_TAPS taps, FILE_SOURCE_PHASES phases) resamples it, the cutoff is below the lower Nyquist frequency.
+*/
+class File_Source : public Sample_Source {
+
+public:
+
+	//! Constructor
+	File_Source();
+
+	~File_Source();
+
+	//! Map a file
+	/** \param path WAV or raw PCM file, a file that starts with a RIFF WAVE header is parsed as WAV whatever its name.
+	*   \param rawSampleRate sample rate of a raw file.
+	*   \param captureRate rate of the samples returned by read(), 0 for the rate of the file.
+	*   \return false if the file can't be mapped or the format isn't supported.
+	*/
+	bool open(const char* path, uint32_t rawSampleRate, uint32_t captureRate);
+
+	//! Unmap the file
+	void close();
+
+	uint32_t read(q15_t* samples, uint32_t count) override;
+
+	uint32_t sampleRate() const override { return output_rate; }
+
+	bool finished() const override { return at_end; }
+
+	//! Sample rate of the file
+	uint32_t fileRate() const { return file_rate; }
+
+	//! Number of frames in the file
+	uint64_t fileFrames() const { return frame_count; }
+
+	//! Number of samples returned so far
+	uint64_t samplesRead() const { return samples_read; }
+
+	//! Number of file frames consumed so far
+	uint64_t framesConsumed() const;
+
+	//! Number of samples read() returns for the whole file, at the capture rate
+	uint64_t length() const;
+
+	//! Continue reading at a sample
+	/** Samples are independent of what was read before, so parts of a file can be read in any order.
+	*   \param sample position at the capture rate.
+	*/
+	void seek(uint64_t sample);
+
+private:
+	//! Parse the RIFF chunks up to the data chunk
+	bool parseWav(const uint8_t* file, size_t size);
+
+	//! Mono sample of a frame as a 16 bit value, 0 outside the file
+	float frame(int64_t index) const;
+
+	//! Compute the resampling filter
+	void buildFilter();
+
+	const uint8_t* mapping; // whole file
+	size_t mapping_size;
+	const int16_t* data; // first frame
+	uint64_t frame_count;
+	uint16_t channels;
+	uint32_t file_rate;
+	uint32_t output_rate;
+
+	bool resample;
+	uint64_t position; // in file frames, 32.32 fixed point
+	uint64_t step; // file frames per output sample, 32.32 fixed point
+	std::vector<float> filter; // FILE_SOURCE_PHASES rows of FILE_SOURCE_TAPS coefficients
+
+	uint64_t samples_read;
+	bool at_end;
+};
+
+#endif // File_Source_H
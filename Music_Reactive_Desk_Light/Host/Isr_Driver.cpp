@@ -0,0 +1,62 @@
+/*
+ Name:		Isr_Driver.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The ADC interrupt on the host.
+*/
+
+#include "Isr_Driver.h"
+#include <chrono>
+
+#define ISR_DRIVER_MAX_BLOCK 4096
+
+Isr_Driver::Isr_Driver() : running(false), samples_sent(0), sample_rate(0), block_size(1) {
+}
+
+Isr_Driver::~Isr_Driver() {
+	stop();
+}
+
+bool Isr_Driver::start(uint32_t sampleRate, uint32_t blockSize, Handler interrupt) {
+	if (running.load() || sampleRate == 0 || blockSize == 0 || blockSize > ISR_DRIVER_MAX_BLOCK) {
+		return false;
+	}
+	handler = interrupt;
+	sample_rate = sampleRate;
+	block_size = blockSize;
+	samples_sent.store(0);
+	running.store(true);
+	thread = std::thread(&Isr_Driver::run, this);
+	return true;
+}
+
+void Isr_Driver::stop() {
+	running.store(false);
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+/* The samples due are counted from the start time, not from the last wake up, so a late wake up
+*   raises the interrupts it missed in a burst and the average rate stays exact, like a DMA that kept running.
+*/
+void Isr_Driver::run() {
+	typedef std::chrono::steady_clock Clock;
+	const Clock::time_point begin = Clock::now();
+	int16_t block[ISR_DRIVER_MAX_BLOCK];
+	uint64_t sent = 0;
+	while (running.load(std::memory_order_relaxed)) {
+		const uint64_t micros = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - begin).count();
+		const uint64_t due = micros * sample_rate / 1000000;
+		while (sent + block_size <= due) {
+			for (uint32_t i = 0; i < block_size; i++) {
+				block[i] = (int16_t)(sent + i);
+			}
+			handler(block, block_size);
+			sent += block_size;
+			samples_sent.store(sent, std::memory_order_release);
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
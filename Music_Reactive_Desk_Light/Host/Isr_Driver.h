@@ -0,0 +1,68 @@
+/*
+ Name:		Isr_Driver.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The ADC interrupt on the host. A thread of its own calls the capture's interrupt handler at the
+ sample rate, with samples from a synthetic source, so capture can be tested against a slow main loop on Linux.
+*/
+#ifndef Isr_Driver_H
+#define Isr_Driver_H
+
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+/** Class Isr_Driver: interrupts at a sample rate from a thread
+*
+*   Usage:
+*   \code
+*   driver.start(40000, 256, [&](const int16_t* samples, uint32_t count) { ring.write(samples, count); });
+*   ... // the main loop reads the ring
+*   driver.stop();
+*   \endcode
+*   The samples are a ramp, sample n has the value (int16_t)n, so a consumer can tell a gap or a repeat from
+*   the values alone. The thread sleeps in steps of about a millisecond and then raises every interrupt that
+*   is due, one per blockSize samples. The handler runs on the driver thread, like an interrupt it may be
+*   called while the main loop is in the middle of anything.
+*/
+class Isr_Driver {
+
+public:
+
+	//! Interrupt handler, gets the samples of one conversion or one DMA block
+	typedef std::function<void(const int16_t* samples, uint32_t count)> Handler;
+
+	//! Constructor
+	Isr_Driver();
+
+	~Isr_Driver();
+
+	//! Start raising interrupts
+	/** \param sampleRate samples per second.
+	*   \param blockSize samples per interrupt, 1 for an interrupt per conversion, at most 4096.
+	*   \param handler called once per interrupt on the driver thread.
+	*   \return false if already running or the block size is out of range.
+	*/
+	bool start(uint32_t sampleRate, uint32_t blockSize, Handler handler);
+
+	//! Stop and wait for the last interrupt to return
+	void stop();
+
+	//! Samples passed to the handler so far
+	uint64_t samplesSent() const { return samples_sent.load(std::memory_order_acquire); }
+
+private:
+	//! Body of the driver thread
+	void run();
+
+	std::thread thread;
+	std::atomic<bool> running;
+	std::atomic<uint64_t> samples_sent;
+	Handler handler;
+	uint32_t sample_rate;
+	uint32_t block_size;
+};
+
+#endif // Isr_Driver_H
@@ -0,0 +1,90 @@
+/*
+ Name:		Latency_Harness.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Synthetic kick drums and the matching of onsets to led frames.
+*/
+
+#include "Latency_Harness.h"
+#include <math.h>
+
+Latency_Signal::Latency_Signal() : rate(0), available(0), position(0) {
+}
+
+/* Onset k lies at (k + 0.5) intervals, moved by up to a quarter interval so it falls anywhere in a hop
+*   The burst decays with a time constant of 60 ms and uses 75 % of the ADC range.
+*/
+void Latency_Signal::generate(uint32_t sampleRate, const Latency_Options& options) {
+	rate = sampleRate;
+	const uint64_t interval = (uint64_t)(options.intervalSeconds * sampleRate);
+	samples.assign((options.onsets + 1) * interval, 0);
+	onset_list.clear();
+	available = 0;
+	position = 0;
+
+	uint32_t random = options.seed * 2654435761u + 1;
+	for (q15_t& sample : samples) {
+		random = random * 1664525 + 1013904223;
+		sample = (q15_t)((int32_t)(random >> 28) - 8); // noise of +-8 counts
+	}
+
+	for (uint32_t k = 0; k < options.onsets; k++) {
+		random = random * 1664525 + 1013904223;
+		const double shift = ((double)(random >> 8) / (1 << 24) - 0.5) * 0.5; // -0.25 to 0.25 interval
+		const uint64_t onset = (uint64_t)((k + 0.5 + shift) * interval);
+		onset_list.push_back(onset);
+		const uint64_t end = onset + interval / 2 < samples.size() ? onset + interval / 2 : samples.size();
+		for (uint64_t i = onset; i < end; i++) {
+			const double t = (double)(i - onset) / sampleRate;
+			samples[i] += (q15_t)lrint(1500 * exp(-t / 0.06) * sin(2 * M_PI * 60 * t));
+		}
+	}
+}
+
+uint32_t Latency_Signal::read(q15_t* output, uint32_t count) {
+	const uint64_t left = available > position ? available - position : 0;
+	const uint32_t taken = left < count ? (uint32_t)left : count;
+	for (uint32_t i = 0; i < taken; i++) {
+		output[i] = samples[position + i];
+	}
+	position += taken;
+	return taken;
+}
+
+/* Frames between an onset and the next one belong to it
+*   The level before the onset is that of the last earlier frame. An onset is missed if its peak doesn't
+*   reach twice that level, otherwise the first frame at half way up is the one that shows it.
+*/
+void matchOnsets(const std::vector<uint64_t>& onsetNanos, const std::vector<Latency_Frame>& frames, std::vector<Latency_Result>& results) {
+	results.clear();
+	size_t first = 0;
+	for (size_t k = 0; k < onsetNanos.size(); k++) {
+		const uint64_t onset = onsetNanos[k];
+		const uint64_t next = k + 1 < onsetNanos.size() ? onsetNanos[k + 1] : UINT64_MAX;
+		while (first < frames.size() && frames[first].emitNanos < onset) {
+			first++;
+		}
+		const q31_t before = first > 0 ? frames[first - 1].level : 0;
+		size_t end = first;
+		q31_t peak = 0;
+		while (end < frames.size() && frames[end].emitNanos < next) {
+			peak = frames[end].level > peak ? frames[end].level : peak;
+			end++;
+		}
+
+		Latency_Result result = { onset / 1e9, 0, 0, false };
+		if (peak > 2 * before) {
+			const q31_t threshold = before + (peak - before) / 2;
+			for (size_t f = first; f < end; f++) {
+				if (frames[f].level >= threshold) {
+					result.emitMillis = (frames[f].emitNanos - onset) / 1e6;
+					result.lightMillis = (frames[f].lightNanos - onset) / 1e6;
+					result.detected = true;
+					break;
+				}
+			}
+		}
+		results.push_back(result);
+	}
+}
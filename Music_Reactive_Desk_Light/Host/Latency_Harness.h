@@ -0,0 +1,185 @@
+/*
+ Name:		Latency_Harness.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Audio to light latency of the desk light, simulated on the host with a virtual clock.
+ Synthetic kick drums are fed to the pipeline and every onset is matched to the led frame that shows it.
+*/
+#ifndef Latency_Harness_H
+#define Latency_Harness_H
+
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Fft_Engine.h"
+#include "Pruned_Rfft.h"
+#include "File_Led_Sink.h"
+
+//! Settings of a latency run
+struct Latency_Options {
+	uint32_t onsets; // number of kick drums
+	double intervalSeconds; // average time between onsets, each onset is moved by up to a quarter of it
+	uint32_t blockSize; // samples per capture block, the source only sees whole blocks (DMA interrupt per block)
+	double computeMicros; // time charged per analysed hop, < 0 for the measured host time
+	double cpuScale; // factor on the measured host time, e.g. the Teensy's slowdown against the host
+	uint32_t seed; // onset positions and noise
+	ANALYSIS_ENGINE engine; // band levels from the pruned FFT or the Goertzel filters
+};
+
+//! Latency of one onset
+struct Latency_Result {
+	double onsetSeconds; // time of the onset in the audio
+	double emitMillis; // onset up to the show() of the frame that shows it
+	double lightMillis; // onset up to the leds latching that frame
+	bool detected; // false if no frame showed the onset
+};
+
+/** Class Latency_Signal: synthetic kick drums as a sample source on a virtual clock
+*
+*   Every onset is a decaying 60 Hz burst over low noise, in 12 bit ADC counts. read() only returns
+*   samples that have been captured by the virtual time, see makeAvailable().
+*/
+class Latency_Signal : public Sample_Source {
+
+public:
+
+	//! Constructor
+	Latency_Signal();
+
+	//! Synthesise the onsets
+	/** \param rate sample rate.
+	*   \param options number, spacing and seed of the onsets.
+	*/
+	void generate(uint32_t rate, const Latency_Options& options);
+
+	//! Let read() return samples up to count
+	void makeAvailable(uint64_t count) { available = count < samples.size() ? count : samples.size(); }
+
+	uint32_t read(q15_t* output, uint32_t count) override;
+
+	uint32_t sampleRate() const override { return rate; }
+
+	bool finished() const override { return position >= samples.size(); }
+
+	//! Samples read so far
+	uint64_t consumed() const { return position; }
+
+	//! Samples in the signal
+	uint64_t length() const { return samples.size(); }
+
+	//! Sample index of every onset
+	const std::vector<uint64_t>& onsets() const { return onset_list; }
+
+private:
+	std::vector<q15_t> samples;
+	std::vector<uint64_t> onset_list;
+	uint32_t rate;
+	uint64_t available;
+	uint64_t position;
+};
+
+//! A frame as seen by the leds
+struct Latency_Frame {
+	uint64_t emitNanos; // virtual time of show()
+	uint64_t lightNanos; // virtual time the leds latch the frame
+	q31_t level; // bass level
+};
+
+//! Match every onset to the first frame after it whose bass level is half way between the level before and the peak
+/** \param onsetNanos virtual time of every onset.
+*   \param frames all frames in order.
+*   \param results one per onset.
+*/
+void matchOnsets(const std::vector<uint64_t>& onsetNanos, const std::vector<Latency_Frame>& frames, std::vector<Latency_Result>& results);
+
+//! Time the leds need for a frame: 24 bits of 1.25 us per led and the 300 us reset that latches it
+inline uint64_t ledFrameNanos(uint16_t numLeds) {
+	return (uint64_t)numLeds * 24 * 1250 + 300000;
+}
+
+/** Function measureLatency: run the pipeline of Config over the signal on a virtual clock
+*
+*   The clock starts at the first sample. Samples are captured at the sample rate and handed over in
+*   blocks of options.blockSize. Every call of process() that analyses a hop advances the clock by the
+*   compute time. show() waits for the previous frame to leave the strip, like WS2812Serial, and
+*   the frame lights when its transfer and the reset are done.
+*   When a hop takes longer than it lasts, e.g. because the led transfer is slower than the hop,
+*   the samples pile up. The desk light would drop them once its ring is full, here they wait,
+*   so the latency grows and maxBacklog shows the overload.
+*   \tparam Config a Pipeline_Config.
+*   \param options signal, timing and analysis engine.
+*   \param results one per onset.
+*   \param maxBacklog most samples captured but not yet read by the pipeline.
+*   \return false if the pipeline can't be set up.
+*/
+template <class Config>
+bool measureLatency(const Latency_Options& options, std::vector<Latency_Result>& results, uint64_t& maxBacklog) {
+	Latency_Signal signal;
+	signal.generate(Config::sampleRate, options);
+	File_Led_Sink sink;
+	sink.open(nullptr);
+	Fft_Engine engine;
+	Pruned_Rfft spectrum(engine);
+	Audio_Pipeline<Config> pipeline(signal, spectrum, sink);
+	if (!pipeline.begin(options.engine, fftWindow, inputGain, goertzelFiltersPerBand)) {
+		return false;
+	}
+
+	const double nanosPerSample = 1e9 / Config::sampleRate;
+	const uint64_t block = options.blockSize > 0 ? options.blockSize : 1;
+	const uint64_t lastBlockEnd = signal.length() - signal.length() % block;
+	const uint64_t frameNanos = ledFrameNanos(Config::numLeds);
+	std::vector<Latency_Frame> frames;
+	uint64_t now = 0;
+	uint64_t ledsBusyUntil = 0;
+	maxBacklog = 0;
+
+	while (true) {
+		uint64_t captured = (uint64_t)(now / nanosPerSample);
+		captured -= captured % block;
+		if (captured > lastBlockEnd) {
+			captured = lastBlockEnd;
+		}
+		signal.makeAvailable(captured);
+		if (captured - signal.consumed() > maxBacklog) {
+			maxBacklog = captured - signal.consumed();
+		}
+
+		const uint64_t before = signal.consumed();
+		const uint32_t hops = pipeline.profiler().recorded(PIPELINE_STAGE::COPY);
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		const bool shown = pipeline.process();
+		const double hostNanos = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+		if (signal.consumed() == before) {
+			if (captured >= lastBlockEnd) {
+				break;
+			}
+			now = (uint64_t)((captured + block) * nanosPerSample + 0.5); // sleep until the next block
+			continue;
+		}
+		if (pipeline.profiler().recorded(PIPELINE_STAGE::COPY) != hops) {
+			now += (uint64_t)(options.computeMicros >= 0 ? options.computeMicros * 1000 : hostNanos * options.cpuScale);
+		}
+		if (shown) {
+			if (now < ledsBusyUntil) {
+				now = ledsBusyUntil; // show() waits for the transfer of the previous frame
+			}
+			ledsBusyUntil = now + frameNanos;
+			Latency_Frame frame = { now, ledsBusyUntil, pipeline.level(0) };
+			frames.push_back(frame);
+		}
+	}
+
+	std::vector<uint64_t> onsetNanos;
+	for (uint64_t onset : signal.onsets()) {
+		onsetNanos.push_back((uint64_t)(onset * nanosPerSample + 0.5));
+	}
+	matchOnsets(onsetNanos, frames, results);
+	return true;
+}
+
+#endif // Latency_Harness_H
@@ -0,0 +1,145 @@
+/*
+ Name:		Render_Simulation.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Virtual clock of the render simulation and the slot stress run.
+*/
+
+#include "Render_Simulation.h"
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "Fft_Engine.h"
+#include "Pruned_Rfft.h"
+#include "File_Led_Sink.h"
+
+uint32_t Paced_Source::read(q15_t* samples, uint32_t count) {
+	const uint64_t left = available > position ? available - position : 0;
+	const uint32_t taken = input.read(samples, left < count ? (uint32_t)left : count);
+	position += taken;
+	return taken;
+}
+
+//! Add the change of a bar since the previous tick
+static void addStep(Render_Motion& motion, uint16_t previous, uint16_t current, double& stepSum) {
+	const uint32_t step = current > previous ? current - previous : previous - current;
+	motion.ticks++;
+	if (step > 0) {
+		motion.moves++;
+		stepSum += step;
+	}
+	motion.maxStep = step > motion.maxStep ? step : motion.maxStep;
+}
+
+/* Times in ns from the first sample, converted to the us clock of the renderer when it renders
+*   The renderer keeps the pipeline's brightness and differential output, its sink only counts the frames.
+*/
+bool simulateRender(Sample_Source& source, const Render_Options& options, Render_Report& report) {
+	Paced_Source paced(source);
+	File_Led_Sink directSink;
+	directSink.open(nullptr);
+	File_Led_Sink renderSink;
+	renderSink.open(nullptr);
+	Fft_Engine engine;
+	Pruned_Rfft spectrum(engine);
+	Audio_Pipeline<Config> pipeline(paced, spectrum, directSink);
+	if (!pipeline.begin(analysisEngine, fftWindow, inputGain, goertzelFiltersPerBand)) {
+		return false;
+	}
+	pipeline.setMaxLevel(0, maxBass);
+	pipeline.setMaxLevel(1, maxMid);
+	pipeline.setMaxLevel(2, maxTreble);
+	Pipeline_Params params = pipeline.params();
+	params.effect = options.effect;
+	if (!pipeline.setParams(params)) {
+		return false;
+	}
+	Led_Renderer<Config> renderer(pipeline.bandFrames(), renderSink);
+	const uint32_t rate = source.sampleRate();
+	renderer.begin((uint32_t)((uint64_t)Config::hopSize * 1000000 / rate), options.envelope);
+
+	report = Render_Report();
+	double directSum = 0;
+	double renderedSum = 0;
+	double offsetSum = 0;
+	uint16_t direct[Config::numBands] = {};
+	uint16_t rendered[Config::numBands] = {};
+	uint64_t hops = 0;
+	uint64_t ticks = 0;
+
+	while (!source.finished()) {
+		const uint64_t hopNanos = (hops + 1) * Config::hopSize * 1000000000ull / rate;
+		const uint64_t tickNanos = ticks * 1000000000ull / options.renderRate;
+		if (hopNanos <= tickNanos) {
+			paced.makeAvailable((hops + 1) * Config::hopSize);
+			pipeline.process();
+			hops++;
+			continue;
+		}
+		renderer.render((uint32_t)(tickNanos / 1000));
+		ticks++;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			addStep(report.direct, direct[b], pipeline.ledsOn(b), directSum);
+			addStep(report.rendered, rendered[b], renderer.ledsOn(b), renderedSum);
+			direct[b] = pipeline.ledsOn(b);
+			rendered[b] = renderer.ledsOn(b);
+			offsetSum += direct[b] > rendered[b] ? direct[b] - rendered[b] : rendered[b] - direct[b];
+		}
+	}
+
+	report.analysisFrames = pipeline.bandFrames().published();
+	report.renderFrames = renderer.framesRendered();
+	report.framesSent = renderer.framesRendered() - renderer.framesUnchanged();
+	report.direct.meanStep = report.direct.moves > 0 ? directSum / report.direct.moves : 0;
+	report.rendered.meanStep = report.rendered.moves > 0 ? renderedSum / report.rendered.moves : 0;
+	report.meanOffset = report.rendered.ticks > 0 ? offsetSum / report.rendered.ticks : 0;
+	report.renderTicks = renderer.profiler().stats(PIPELINE_STAGE::FRAME);
+	report.analysisTicks = pipeline.profiler().stats(PIPELINE_STAGE::FRAME);
+	return true;
+}
+
+/* The writer publishes numbered frames without pause, the reader takes the latest one without pause
+*   On a multi core host the two really run at the same time, so a missing barrier or a wrong index swap
+*   shows up as a frame whose fields disagree.
+*/
+void stressSlot(uint32_t milliseconds, uint64_t& reads, uint64_t& bad) {
+	Latest_Slot<Band_Frame> slot;
+	std::atomic<bool> running(true);
+	std::thread writer([&]() {
+		Band_Frame frame = {};
+		uint32_t number = 0;
+		while (running.load(std::memory_order_relaxed)) {
+			number++;
+			frame.frame = number;
+			for (uint32_t& leds : frame.leds) {
+				leds = number;
+			}
+			frame.brightness = (uint8_t)number;
+			slot.publish(frame);
+		}
+	});
+
+	reads = 0;
+	bad = 0;
+	uint32_t last = 0;
+	const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+	while (std::chrono::steady_clock::now() < end) {
+		for (uint32_t i = 0; i < 1024; i++) {
+			if (!slot.update()) {
+				continue;
+			}
+			const Band_Frame& frame = slot.value();
+			bool consistent = frame.frame > last && frame.brightness == (uint8_t)frame.frame;
+			for (uint32_t leds : frame.leds) {
+				consistent &= leds == frame.frame;
+			}
+			bad += consistent ? 0 : 1;
+			last = frame.frame;
+			reads++;
+		}
+		std::this_thread::yield(); // lets the writer in on a single core too
+	}
+	running.store(false, std::memory_order_relaxed);
+	writer.join();
+}
@@ -0,0 +1,94 @@
+/*
+ Name:		Render_Simulation.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The led renderer and the analysis at their own rates on a virtual clock, with the smoothness
+ of the bars and the render time against the time a render may take. Also a stress run of the latest value
+ slot between two threads.
+*/
+#ifndef Render_Simulation_H
+#define Render_Simulation_H
+
+#include <stdint.h>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Led_Renderer.h"
+#include "Stage_Profiler.h"
+
+//! Settings of a render simulation
+struct Render_Options {
+	uint32_t renderRate; // led frames per second of the renderer
+	Led_Envelope envelope;
+	double cpuScale; // factor on the measured host times, e.g. the Teensy's slowdown against the host
+	uint8_t effect; // LED_EFFECT the renderer draws
+};
+
+//! Motion of the bars of one led output, sampled at every render tick
+struct Render_Motion {
+	uint32_t ticks; // render ticks, times bands
+	uint32_t moves; // ticks where a bar changed
+	uint32_t maxStep; // largest change of a bar from one tick to the next, in leds
+	double meanStep; // mean change of the ticks with a move, in leds
+};
+
+//! Result of a render simulation
+struct Render_Report {
+	uint32_t analysisFrames; // frames published by the pipeline
+	uint32_t renderFrames;
+	uint32_t framesSent; // render frames that weren't equal to the previous one
+	Render_Motion direct; // the pipeline showing the leds itself
+	Render_Motion rendered; // the renderer
+	double meanOffset; // mean difference between the two outputs, in leds
+	Stage_Stats renderTicks; // FRAME of the renderer, see Stage_Profiler
+	Stage_Stats analysisTicks; // FRAME of the pipeline
+};
+
+/** Class Paced_Source: a sample source that only hands out the samples captured by a virtual time
+*/
+class Paced_Source : public Sample_Source {
+
+public:
+
+	//! Constructor
+	/** \param source samples, e.g. a File_Source.
+	*/
+	explicit Paced_Source(Sample_Source& source) : input(source), available(0), position(0) {}
+
+	//! Let read() return samples up to count
+	void makeAvailable(uint64_t count) { available = count; }
+
+	uint32_t read(q15_t* samples, uint32_t count) override;
+
+	uint32_t sampleRate() const override { return input.sampleRate(); }
+
+	bool finished() const override { return input.finished(); }
+
+private:
+	Sample_Source& input;
+	uint64_t available;
+	uint64_t position;
+};
+
+/** Function simulateRender: the desk light pipeline and a Led_Renderer on one virtual clock
+*
+*   Hops are analysed when their last sample is captured, frames are rendered every 1 / renderRate seconds,
+*   whichever comes first on the clock runs first. The pipeline shows its own frames too, so both outputs are
+*   sampled at the same render ticks: the direct output moves once per hop, the renderer in between.
+*   The times are measured on the host, the clock doesn't advance by them.
+*   \param source audio, e.g. a File_Source.
+*   \param options render rate and motion.
+*   \param report smoothness and timing.
+*   \return false if the pipeline can't be set up.
+*/
+bool simulateRender(Sample_Source& source, const Render_Options& options, Render_Report& report);
+
+//! Publish frames in one thread and read them in another as fast as possible
+/** Every frame holds its number in all fields, a value that mixes two frames or goes back in time is counted.
+*   \param milliseconds duration.
+*   \param reads update() calls that returned a new value.
+*   \param bad torn or out of order values.
+*/
+void stressSlot(uint32_t milliseconds, uint64_t& reads, uint64_t& bad);
+
+#endif // Render_Simulation_H
@@ -0,0 +1,296 @@
+/*
+ Name:		Telemetry_Decoder.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: COBS decoding, frame checks and the CSV and JSON output of the telemetry.
+*/
+
+#include "Telemetry_Decoder.h"
+#include <stdio.h>
+#include <string.h>
+
+Telemetry_Decoder::Telemetry_Decoder() : synced(false), sequence_seen(false), next_sequence(0), frame_count(0), error_count(0), lost_count(0) {
+	latest.type = TELEMETRY_TYPE::BANDS;
+	latest.sequence = 0;
+}
+
+/* A 0 ends a frame, the bytes before the first 0 belong to a frame that started before the stream
+*   An encoded frame can't be longer than TELEMETRY_MAX_ENCODED, longer ones are errors and aren't stored.
+*/
+bool Telemetry_Decoder::push(uint8_t byte) {
+	if (byte != 0) {
+		if (synced && pending.size() <= TELEMETRY_MAX_ENCODED) {
+			pending.push_back(byte);
+		}
+		return false;
+	}
+	if (!synced) {
+		synced = true;
+		pending.clear();
+		return false;
+	}
+	if (pending.empty()) {
+		return false; // empty frames are allowed as padding
+	}
+	const bool valid = decode();
+	pending.clear();
+	return valid;
+}
+
+/* Undo the COBS encoding, then check the length and the crc
+*   Every code byte is followed by code - 1 data bytes, a code below 0xFF also stands for a 0 unless it ends the frame.
+*/
+bool Telemetry_Decoder::decode() {
+	decoded.clear();
+	bool valid = pending.size() < TELEMETRY_MAX_ENCODED;
+	size_t i = 0;
+	while (valid && i < pending.size()) {
+		const uint8_t code = pending[i++];
+		if (i + code - 1 > pending.size()) {
+			valid = false;
+			break;
+		}
+		decoded.insert(decoded.end(), pending.begin() + i, pending.begin() + i + code - 1);
+		i += code - 1;
+		if (code != 0xFF && i < pending.size()) {
+			decoded.push_back(0);
+		}
+	}
+	if (valid) {
+		valid = decoded.size() >= 4 && decoded.size() <= TELEMETRY_MAX_FRAME;
+	}
+	if (valid) {
+		const uint16_t crc = (uint16_t)(decoded[decoded.size() - 2] | decoded[decoded.size() - 1] << 8);
+		valid = telemetryCrc(0xFFFF, decoded.data(), (uint32_t)decoded.size() - 2) == crc;
+	}
+	if (!valid) {
+		error_count++;
+		return false;
+	}
+
+	latest.type = (TELEMETRY_TYPE)decoded[0];
+	latest.sequence = decoded[1];
+	latest.payload.assign(decoded.begin() + 2, decoded.end() - 2);
+	if (sequence_seen) {
+		lost_count += (uint8_t)(latest.sequence - next_sequence);
+	}
+	sequence_seen = true;
+	next_sequence = latest.sequence + 1;
+	frame_count++;
+	return true;
+}
+
+const char* telemetryTypeName(TELEMETRY_TYPE type) {
+	switch (type) {
+	case TELEMETRY_TYPE::BANDS: return "bands";
+	case TELEMETRY_TYPE::LEDS: return "leds";
+	case TELEMETRY_TYPE::SPECTRUM: return "spectrum";
+	case TELEMETRY_TYPE::PROFILE: return "profile";
+	case TELEMETRY_TYPE::COUNTERS: return "counters";
+	case TELEMETRY_TYPE::PARAMS: return "params";
+	default: return "unknown";
+	}
+}
+
+namespace {
+
+//! A named value or list of values of a message
+struct Telemetry_Field {
+	std::string name;
+	std::vector<double> values;
+	int decimals; // digits after the point
+	bool list; // an array in JSON
+	bool named; // the name is a CSV column too, e.g. the stage of a profile
+};
+
+void addValue(std::vector<Telemetry_Field>& fields, const char* name, double value, int decimals = 0) {
+	Telemetry_Field field = { name, { value }, decimals, false, false };
+	fields.push_back(field);
+}
+
+//! Read a packed value from the payload, false if the payload is too short
+template <class T>
+bool readPayload(const std::vector<uint8_t>& payload, size_t& offset, T& value) {
+	if (offset + sizeof(T) > payload.size()) {
+		return false;
+	}
+	memcpy(&value, payload.data() + offset, sizeof(T));
+	offset += sizeof(T);
+	return true;
+}
+
+//! Read count values of type T into a list field
+template <class T>
+bool readList(const std::vector<uint8_t>& payload, size_t& offset, uint32_t count, const char* name, std::vector<Telemetry_Field>& fields) {
+	Telemetry_Field field = { name, {}, 0, true, false };
+	for (uint32_t i = 0; i < count; i++) {
+		T value;
+		if (!readPayload(payload, offset, value)) {
+			return false;
+		}
+		field.values.push_back(value);
+	}
+	fields.push_back(field);
+	return true;
+}
+
+/* Fields of a message in output order
+*   Returns false for an unknown type or a payload shorter than its header says.
+*/
+bool parseFields(const Telemetry_Message& message, std::vector<Telemetry_Field>& fields) {
+	const std::vector<uint8_t>& payload = message.payload;
+	size_t offset = 0;
+	fields.clear();
+	addValue(fields, "sequence", message.sequence);
+
+	switch (message.type) {
+	case TELEMETRY_TYPE::BANDS:
+	case TELEMETRY_TYPE::LEDS: {
+		Telemetry_Frame_Header header;
+		if (!readPayload(payload, offset, header)) {
+			return false;
+		}
+		addValue(fields, "frame", header.frame);
+		if (message.type == TELEMETRY_TYPE::BANDS) {
+			return readList<q31_t>(payload, offset, header.count, "levels", fields);
+		}
+		return readList<uint16_t>(payload, offset, header.count, "leds_on", fields);
+	}
+	case TELEMETRY_TYPE::SPECTRUM: {
+		Telemetry_Spectrum_Header header;
+		if (!readPayload(payload, offset, header)) {
+			return false;
+		}
+		addValue(fields, "frame", header.frame);
+		addValue(fields, "bin_hz", header.binMilliHz / 1000.0, 3);
+		addValue(fields, "total_bins", header.totalBins);
+		addValue(fields, "first_bin", header.firstBin);
+		addValue(fields, "decimation", header.decimation);
+		return readList<uint16_t>(payload, offset, header.bins, "magnitudes", fields);
+	}
+	case TELEMETRY_TYPE::PROFILE: {
+		Telemetry_Profile_Header header;
+		if (!readPayload(payload, offset, header) || header.ticksPerSecond == 0) {
+			return false;
+		}
+		addValue(fields, "ticks_per_second", header.ticksPerSecond);
+		const double micros = 1e6 / header.ticksPerSecond;
+		for (uint8_t s = 0; s < header.stages; s++) {
+			Telemetry_Stage stage;
+			if (!readPayload(payload, offset, stage)) {
+				return false;
+			}
+			const Stage_Stats stats = stage.stats;
+			Telemetry_Field field = { Stage_Profiler::stageName((PIPELINE_STAGE)stage.stage),
+				{ (double)stats.count, stats.min * micros, stats.p50 * micros, stats.p99 * micros, stats.max * micros }, 1, true, true };
+			fields.push_back(field);
+		}
+		return true;
+	}
+	case TELEMETRY_TYPE::COUNTERS: {
+		Telemetry_Record record;
+		if (!readPayload(payload, offset, record)) {
+			return false;
+		}
+		const Frame_Counters counters = record.counters;
+		addValue(fields, "record", record.sequence);
+		addValue(fields, "millis", record.millis);
+		addValue(fields, "produced", counters.framesProduced);
+		addValue(fields, "processed", counters.framesProcessed);
+		addValue(fields, "skipped", counters.windowsSkipped);
+		addValue(fields, "overruns", counters.isrOverruns);
+		addValue(fields, "deadline_misses", counters.deadlineMisses);
+		addValue(fields, "led_frames", counters.ledFrames);
+		addValue(fields, "led_frames_unchanged", counters.ledFramesUnchanged);
+		addValue(fields, "max_fill_percent", record.maxFillPercent);
+		return true;
+	}
+	case TELEMETRY_TYPE::PARAMS: {
+		Telemetry_Params_Header header;
+		if (!readPayload(payload, offset, header)) {
+			return false;
+		}
+		addValue(fields, "status", header.status);
+		addValue(fields, "brightness", header.brightness);
+		addValue(fields, "quiet_leds", header.quietLeds);
+		addValue(fields, "effect", header.effect);
+		addValue(fields, "spectrum_bars", header.spectrumBars);
+		addValue(fields, "bar_spacing", header.barSpacing);
+		Telemetry_Field maxLevels = { "max_levels", {}, 0, true, false };
+		Telemetry_Field upperEdges = { "upper_edges", {}, 0, true, false };
+		for (uint8_t b = 0; b < header.bands; b++) {
+			Telemetry_Band_Params band;
+			if (!readPayload(payload, offset, band)) {
+				return false;
+			}
+			maxLevels.values.push_back(band.maxLevel);
+			upperEdges.values.push_back(band.upperEdge);
+		}
+		fields.push_back(maxLevels);
+		fields.push_back(upperEdges);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+void appendNumber(std::string& line, double value, int decimals) {
+	char text[32];
+	snprintf(text, sizeof(text), "%.*f", decimals, value);
+	line += text;
+}
+
+} // namespace
+
+/* Every stage of a profile is its name followed by the count and the durations in microseconds
+*
+*/
+bool telemetryCsv(const Telemetry_Message& message, std::string& line) {
+	std::vector<Telemetry_Field> fields;
+	if (!parseFields(message, fields)) {
+		return false;
+	}
+	line = telemetryTypeName(message.type);
+	for (const Telemetry_Field& field : fields) {
+		if (field.named) {
+			line += ',';
+			line += field.name;
+		}
+		for (size_t i = 0; i < field.values.size(); i++) {
+			line += ',';
+			appendNumber(line, field.values[i], field.named && i == 0 ? 0 : field.decimals);
+		}
+	}
+	return true;
+}
+
+bool telemetryJson(const Telemetry_Message& message, std::string& line) {
+	std::vector<Telemetry_Field> fields;
+	if (!parseFields(message, fields)) {
+		return false;
+	}
+	line = "{\"type\":\"";
+	line += telemetryTypeName(message.type);
+	line += '"';
+	for (const Telemetry_Field& field : fields) {
+		line += ",\"";
+		line += field.name;
+		line += "\":";
+		if (field.list) {
+			line += '[';
+		}
+		for (size_t i = 0; i < field.values.size(); i++) {
+			if (i > 0) {
+				line += ',';
+			}
+			appendNumber(line, field.values[i], field.named && i == 0 ? 0 : field.decimals);
+		}
+		if (field.list) {
+			line += ']';
+		}
+	}
+	line += '}';
+	return true;
+}
@@ -0,0 +1,103 @@
+/*
+ Name:		Telemetry_Decoder.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Host side of the binary telemetry (see Telemetry_Protocol.h). Splits the byte stream into frames,
+ checks them and turns every message into a line of CSV or JSON.
+*/
+#ifndef Telemetry_Decoder_H
+#define Telemetry_Decoder_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "Telemetry_Protocol.h"
+
+//! A checked frame
+struct Telemetry_Message {
+	TELEMETRY_TYPE type;
+	uint8_t sequence;
+	std::vector<uint8_t> payload;
+};
+
+/** Class Telemetry_Decoder: frames from a telemetry byte stream
+*
+*   Usage:
+*   \code
+*   for (uint8_t byte : bytes) {
+*       if (decoder.push(byte)) {
+*           telemetryCsv(decoder.message(), line);
+*       }
+*   }
+*   \endcode
+*   Bytes up to the first 0 are skipped, the decoder may start in the middle of a frame.
+*   Frames that fail the COBS decoding or the crc are counted and skipped.
+*/
+class Telemetry_Decoder {
+
+public:
+
+	//! Constructor
+	Telemetry_Decoder();
+
+	//! Add a byte of the stream
+	/** \return true if the byte completed a valid frame, see message().
+	*/
+	bool push(uint8_t byte);
+
+	//! The frame completed by the last push() that returned true
+	const Telemetry_Message& message() const { return latest; }
+
+	//! Valid frames
+	uint32_t frames() const { return frame_count; }
+
+	//! Frames with a crc or encoding error
+	uint32_t errors() const { return error_count; }
+
+	//! Frames missing between valid frames, from the sequence numbers
+	uint32_t lost() const { return lost_count; }
+
+private:
+	//! Decode and check the frame in pending
+	bool decode();
+
+	std::vector<uint8_t> pending; // encoded bytes since the last delimiter
+	std::vector<uint8_t> decoded;
+	Telemetry_Message latest;
+	bool synced; // a delimiter has been seen
+	bool sequence_seen;
+	uint8_t next_sequence;
+	uint32_t frame_count;
+	uint32_t error_count;
+	uint32_t lost_count;
+};
+
+//! Name of a message type, "unknown" for types this decoder doesn't know
+const char* telemetryTypeName(TELEMETRY_TYPE type);
+
+//! One CSV line for a message, without newline
+/** Columns: type, sequence, then per type
+*   bands:    frame, level of every band
+*   leds:     frame, leds lit of every band
+*   spectrum: frame, bin width in Hz, total bins, first bin, decimation, magnitudes
+*   profile:  ticks per second, then stage, count, min, p50, p99, max in us for every stage
+*   counters: record sequence, millis, produced, processed, skipped, overruns, deadline misses, led frames,
+*             unchanged led frames, max fill %
+*   params:   status, brightness, quiet leds, effect, spectrum bars, bar spacing, max level of every band,
+*             upper edge of every band in deciHz
+*   \param message checked frame.
+*   \param line output.
+*   \return false if the type is unknown or the payload is too short for it.
+*/
+bool telemetryCsv(const Telemetry_Message& message, std::string& line);
+
+//! One JSON object for a message, without newline
+/** The fields are named after the CSV columns, lists are arrays.
+*   \param message checked frame.
+*   \param line output.
+*   \return false if the type is unknown or the payload is too short for it.
+*/
+bool telemetryJson(const Telemetry_Message& message, std::string& line);
+
+#endif // Telemetry_Decoder_H
@@ -0,0 +1,76 @@
+/*
+ Name:		Work_Stealing_Pool.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Runs a fixed list of tasks on several threads, idle threads steal tasks from busy ones.
+*/
+
+#include "Work_Stealing_Pool.h"
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Tasks of one worker, the owner takes from the front and thieves from the back
+struct Task_Queue {
+	std::mutex lock;
+	std::deque<size_t> tasks;
+};
+
+Work_Stealing_Pool::Work_Stealing_Pool(unsigned threads) : thread_count(threads > 0 ? threads : 1), steal_count(0) {
+}
+
+/* Split the tasks in contiguous blocks, then let every worker drain its own queue and steal when it's empty
+*   No tasks are added while running, so a worker can stop once a scan of all queues finds nothing.
+*/
+void Work_Stealing_Pool::run(size_t tasks, const std::function<void(unsigned worker, size_t task)>& body) {
+	steal_count = 0;
+	std::unique_ptr<Task_Queue[]> queues(new Task_Queue[thread_count]);
+	for (unsigned w = 0; w < thread_count; w++) {
+		const size_t first = tasks * w / thread_count;
+		const size_t last = tasks * (w + 1) / thread_count;
+		for (size_t t = first; t < last; t++) {
+			queues[w].tasks.push_back(t);
+		}
+	}
+
+	auto work = [&](unsigned worker) {
+		while (true) {
+			size_t task = 0;
+			bool found = false;
+			{
+				std::lock_guard<std::mutex> guard(queues[worker].lock);
+				if (!queues[worker].tasks.empty()) {
+					task = queues[worker].tasks.front();
+					queues[worker].tasks.pop_front();
+					found = true;
+				}
+			}
+			for (unsigned i = 1; !found && i < thread_count; i++) {
+				Task_Queue& victim = queues[(worker + i) % thread_count];
+				std::lock_guard<std::mutex> guard(victim.lock);
+				if (!victim.tasks.empty()) {
+					task = victim.tasks.back();
+					victim.tasks.pop_back();
+					found = true;
+					steal_count++;
+				}
+			}
+			if (!found) {
+				return;
+			}
+			body(worker, task);
+		}
+	};
+
+	std::vector<std::thread> helpers;
+	for (unsigned w = 1; w < thread_count; w++) {
+		helpers.emplace_back(work, w);
+	}
+	work(0);
+	for (std::thread& helper : helpers) {
+		helper.join();
+	}
+}
@@ -0,0 +1,54 @@
+/*
+ Name:		Work_Stealing_Pool.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Runs a fixed list of tasks on several threads, idle threads steal tasks from busy ones.
+*/
+#ifndef Work_Stealing_Pool_H
+#define Work_Stealing_Pool_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+
+/** Class Work_Stealing_Pool: parallel loop over task indices
+*
+*   Usage:
+*   \code
+*   Work_Stealing_Pool pool(4);
+*   pool.run(jobs.size(), [&](unsigned worker, size_t task) { analyse(workers[worker], jobs[task]); });
+*   \endcode
+*   Every worker starts with a contiguous block of the tasks and takes them from the front, in order.
+*   A worker without tasks steals from the back of another worker's block, so neighbouring tasks
+*   (e.g. windows of the same file) mostly stay on one thread and uneven tasks still balance out.
+*   Worker 0 is the calling thread, the others are started by run() and joined before it returns.
+*/
+class Work_Stealing_Pool {
+
+public:
+
+	//! Constructor
+	/** \param threads number of workers, at least 1.
+	*/
+	explicit Work_Stealing_Pool(unsigned threads);
+
+	//! Run body(worker, task) for task 0 up to tasks, returns when all are done
+	/** \param tasks number of tasks.
+	*   \param body called once per task, worker is 0 up to threads(). Calls with the same worker never overlap.
+	*/
+	void run(size_t tasks, const std::function<void(unsigned worker, size_t task)>& body);
+
+	//! Number of workers
+	unsigned threads() const { return thread_count; }
+
+	//! Number of tasks taken from another worker in the last run()
+	uint64_t steals() const { return steal_count.load(); }
+
+private:
+	unsigned thread_count;
+	std::atomic<uint64_t> steal_count;
+};
+
+#endif // Work_Stealing_Pool_H
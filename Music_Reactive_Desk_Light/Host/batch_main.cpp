@@ -0,0 +1,129 @@
+/*
+ Name:		batch_main.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Batch analyzer of the desk light. Runs the pipeline of the sketch over many audio files
+ on all cores and writes the band levels and led frames of every file, for tuning the max levels.
+
+ Usage: desk_light_batch [options] <input.wav | input.raw>...
+   --output <dir>    write name.dlb (levels and led frames, see Batch_Header) and name.csv (levels) per input
+   --threads <n>     worker threads, default the number of cores
+   --window <s>      seconds of audio per task, default 30
+   --rate <Hz>       sample rate of raw 16 bit PCM inputs
+   --goertzel        use the Goertzel filter bank instead of the FFT
+   --full-fft        use a full size FFT instead of the pruned FFT
+   --scaling         run the batch with 1, 2, 4 and 8 threads and print the speedup
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include "Batch_Analyzer.h"
+
+static void usage() {
+	fprintf(stderr, "usage: desk_light_batch [--output <dir>] [--threads <n>] [--window <s>] [--rate <Hz>] [--goertzel] [--full-fft] [--scaling] <input>...\n");
+}
+
+int main(int argc, char** argv) {
+	const char* outputDirectory = nullptr;
+	unsigned threads = std::thread::hardware_concurrency();
+	double windowSeconds = 30;
+	uint32_t rawRate = Config::sampleRate;
+	ANALYSIS_ENGINE engine = analysisEngine;
+	bool fullFft = false;
+	bool scaling = false;
+	std::vector<const char*> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			outputDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = (unsigned)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+			windowSeconds = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+			rawRate = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--goertzel") == 0) {
+			engine = ANALYSIS_ENGINE::GOERTZEL;
+		}
+		else if (strcmp(argv[i], "--full-fft") == 0) {
+			fullFft = true;
+		}
+		else if (strcmp(argv[i], "--scaling") == 0) {
+			scaling = true;
+		}
+		else if (argv[i][0] == '-') {
+			usage();
+			return 2;
+		}
+		else {
+			inputs.push_back(argv[i]);
+		}
+	}
+	if (inputs.empty()) {
+		usage();
+		return 2;
+	}
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	static Batch_Analyzer batch;
+	if (!batch.begin(engine, fullFft, rawRate, windowSeconds)) {
+		fprintf(stderr, "the window is shorter than a frame\n");
+		return 2;
+	}
+	for (const char* input : inputs) {
+		if (!batch.add(input)) {
+			fprintf(stderr, "can't read %s\n", input);
+			return 1;
+		}
+	}
+	const double audioSeconds = (double)batch.samples() / Config::sampleRate;
+	printf("%u files, %.1f s of audio, %llu frames in %u windows\n", (unsigned)batch.files(), audioSeconds,
+		(unsigned long long)batch.frames(), (unsigned)batch.windows());
+
+	if (scaling) {
+		// the same batch at every thread count, the results are identical so only the last run is written
+		const unsigned counts[] = { 1, 2, 4, 8 };
+		double single = 0;
+		printf("threads,seconds,msamples_per_s,real_time,speedup,efficiency,steals\n");
+		for (unsigned count : counts) {
+			Work_Stealing_Pool pool(count);
+			double seconds = 0;
+			if (!batch.run(pool, seconds)) {
+				fprintf(stderr, "analysis failed\n");
+				return 1;
+			}
+			if (count == 1) {
+				single = seconds;
+			}
+			const double speedup = seconds > 0 ? single / seconds : 0;
+			printf("%u,%.3f,%.2f,%.0f,%.2f,%.2f,%llu\n", count, seconds, seconds > 0 ? batch.samples() / seconds / 1e6 : 0,
+				seconds > 0 ? audioSeconds / seconds : 0, speedup, speedup / count, (unsigned long long)pool.steals());
+		}
+		printf("%u cores\n", std::thread::hardware_concurrency());
+	}
+	else {
+		Work_Stealing_Pool pool(threads);
+		double seconds = 0;
+		if (!batch.run(pool, seconds)) {
+			fprintf(stderr, "analysis failed\n");
+			return 1;
+		}
+		printf("%u threads, %.3f s, %.0fx real time, %.2f Msamples/s, %llu steals\n", threads, seconds,
+			seconds > 0 ? audioSeconds / seconds : 0, seconds > 0 ? batch.samples() / seconds / 1e6 : 0, (unsigned long long)pool.steals());
+	}
+
+	if (outputDirectory != nullptr && !batch.write(outputDirectory)) {
+		fprintf(stderr, "can't write to %s\n", outputDirectory);
+		return 1;
+	}
+	return 0;
+}
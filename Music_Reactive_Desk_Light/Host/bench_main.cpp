@@ -0,0 +1,464 @@
+/*
+ Name:		bench_main.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Benchmarks of the hot paths of the desk light pipeline on the host: the FFT backends,
+ the sample ring, the sample conditioning, the band accumulation, the led fill, every led effect and a full frame.
+
+ Usage: desk_light_bench [--json] [--output <file>] [--filter <text>] [--repetitions <n>] [--min-time <s>]
+                         [--compare <baseline.csv>] [--tolerance <fraction>]
+   --json         JSON instead of CSV
+   --output       write the results to a file instead of stdout
+   --filter       only run cases with the text in name/variant
+   --compare      compare the medians with a CSV of an earlier run, the exit code is 1 if a case is slower than tolerance
+   --tolerance    allowed slowdown, default 0.1
+ Progress goes to stderr, the results to stdout, so `desk_light_bench > before.csv` records a baseline.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include "Bench_Runner.h"
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Fft_Engine.h"
+#include "Pruned_Rfft.h"
+#include "Full_Rfft.h"
+#include "File_Led_Sink.h"
+#include "Led_Effects.h"
+#include "Spsc_Ring.h"
+
+static const uint32_t fftSizes[] = { 1024, 2048, 4096, 8192 };
+
+/** Class Loop_Source: a second of synthetic audio, repeated
+*
+*   Bass, mid and treble tones plus noise in 12 bit ADC counts, so every band of the pipeline has work.
+*/
+class Loop_Source : public Sample_Source {
+
+public:
+	Loop_Source() : samples(Config::sampleRate), position(0) {
+		uint32_t noise = 12345;
+		for (uint32_t i = 0; i < Config::sampleRate; i++) {
+			const double t = (double)i / Config::sampleRate;
+			noise = noise * 1664525 + 1013904223;
+			const double value = 600 * sin(2 * M_PI * 80 * t) + 300 * sin(2 * M_PI * 700 * t) + 100 * sin(2 * M_PI * 3000 * t)
+				+ (double)(noise >> 24) - 128;
+			samples[i] = (q15_t)lrint(value);
+		}
+	}
+
+	uint32_t read(q15_t* output, uint32_t count) override {
+		for (uint32_t i = 0; i < count; i++) {
+			output[i] = samples[position];
+			position = position + 1 < samples.size() ? position + 1 : 0;
+		}
+		return count;
+	}
+
+	uint32_t sampleRate() const override { return Config::sampleRate; }
+
+	bool finished() const override { return false; }
+
+	//! Samples of the loop
+	const q15_t* data() const { return samples.data(); }
+
+private:
+	std::vector<q15_t> samples;
+	uint32_t position;
+};
+
+//! Highest bin of the pipeline at another fft size, the pruned FFT computes up to there
+static uint32_t maxBinFor(uint32_t fftSize) {
+	return (uint32_t)((uint64_t)Config::maxBin() * fftSize / Config::fftSize);
+}
+
+/* FFT backends at every size
+*   Fft_Engine::rfft overwrites its input, so every iteration copies it first, like Full_Rfft does.
+*/
+static void benchFft(Bench_Runner& bench, const Loop_Source& audio) {
+	Fft_Engine engine;
+	for (uint32_t n : fftSizes) {
+		std::vector<q15_t> input(audio.data(), audio.data() + n);
+		std::vector<q15_t> scratch(n);
+		std::vector<q15_t> output(2 * n);
+
+		bench.run("fft", "engine_rfft_q15", n, n, [&]() {
+			memcpy(scratch.data(), input.data(), n * sizeof(q15_t));
+			engine.rfft(scratch.data(), output.data(), n);
+			benchKeep(output[2]);
+		});
+
+		// the sketch before the plan cache: arm_rfft_init_q15 and arm_rfft_q15 every frame. The host plan computes
+		// its tables where CMSIS points at precomputed ones, so on the host this is an upper bound of the init cost.
+		Fft_Engine uncached;
+		bench.run("fft", "init_per_frame_q15", n, n, [&]() {
+			uncached.clear();
+			memcpy(scratch.data(), input.data(), n * sizeof(q15_t));
+			uncached.rfft(scratch.data(), output.data(), n);
+			benchKeep(output[2]);
+		});
+
+		Full_Rfft full(engine);
+		full.begin(n, n / 2);
+		bench.run("fft", "full_q15", n, n, [&]() {
+			full.transform(input.data(), output.data());
+			benchKeep(output[2]);
+		});
+
+		Pruned_Rfft pruned(engine);
+		pruned.begin(n, maxBinFor(n));
+		bench.run("fft", "pruned_q15", n, n, [&]() {
+			pruned.transform(input.data(), output.data());
+			benchKeep(output[2]);
+		});
+	}
+}
+
+/* The sample ring between the ADC interrupt and the analysis, a hop through the sketch's ring per iteration
+*   dma_blocks writes it as the DMA interrupt does, in blocks of 256, push_per_sample a sample at a time like an
+*   interrupt per conversion. The loop takes the hop with readBlock().
+*/
+static void benchCapture(Bench_Runner& bench, const Loop_Source& audio) {
+	static Spsc_Ring<q15_t, 4 * Config::hopSize> ring;
+	std::vector<q15_t> hop(Config::hopSize);
+	const uint32_t block = 256;
+
+	bench.run("ring", "dma_blocks", Config::hopSize, Config::hopSize, [&]() {
+		for (uint32_t i = 0; i < Config::hopSize; i += block) {
+			ring.write(audio.data() + i, block);
+		}
+		ring.readBlock(hop.data(), Config::hopSize);
+		benchKeep(hop[0]);
+	});
+	bench.run("ring", "push_per_sample", Config::hopSize, Config::hopSize, [&]() {
+		for (uint32_t i = 0; i < Config::hopSize; i++) {
+			ring.push(audio.data()[i]);
+		}
+		ring.readBlock(hop.data(), Config::hopSize);
+		benchKeep(hop[0]);
+	});
+}
+
+/* Conditioning of the samples before the FFT
+*   copy_scale_window is the loop the sketch had before Fft_Window: copy with bias and gain,
+*   then window in a second pass. window_apply is the fused kernel the pipeline uses now.
+*/
+static void benchConditioning(Bench_Runner& bench, const Loop_Source& audio) {
+	const uint32_t n = Config::fftSize;
+	std::vector<q15_t> input(audio.data(), audio.data() + n);
+	std::vector<q15_t> output(n);
+	const int16_t gain = inputGain;
+	const q15_t bias = 3;
+
+	std::vector<q15_t> hann(n);
+	for (uint32_t i = 0; i < n; i++) {
+		hann[i] = (q15_t)lrint(32767 * (0.5 - 0.5 * cos(2 * M_PI * i / n)));
+	}
+	bench.run("condition", "copy_scale_window", n, n, [&]() {
+		for (uint32_t i = 0; i < n; i++) {
+			int32_t value = (input[i] - bias) * gain;
+			output[i] = (q15_t)(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+		}
+		for (uint32_t i = 0; i < n; i++) {
+			output[i] = (q15_t)(((int32_t)output[i] * hann[i]) >> 15);
+		}
+		benchKeep(output[1]);
+	});
+
+	const WINDOW_TYPE types[] = { WINDOW_TYPE::RECTANGULAR, WINDOW_TYPE::HANN, WINDOW_TYPE::BLACKMAN };
+	const char* names[] = { "window_apply_rect", "window_apply_hann", "window_apply_blackman" };
+	for (uint8_t t = 0; t < 3; t++) {
+		Fft_Window window;
+		window.begin(n, types[t]);
+		window.setGain(gain);
+		bench.run("condition", names[t], n, n, [&]() {
+			window.apply(input.data(), output.data(), 0, n, bias);
+			benchKeep(output[1]);
+		});
+	}
+
+	// one hop into the STFT ring and one spectrum out of it
+	Fft_Engine engine;
+	Pruned_Rfft pruned(engine);
+	Stft stft(pruned);
+	stft.begin(n, Config::hopSize, Config::maxBin(), fftWindow);
+	stft.setGain(gain);
+	for (uint32_t i = 0; i < n; i += Config::hopSize) {
+		stft.write(audio.data() + i, Config::hopSize);
+	}
+	bench.run("stft", "write_hop", Config::hopSize, Config::hopSize, [&]() {
+		stft.write(audio.data(), Config::hopSize);
+		benchKeep(stft);
+	});
+	bench.run("stft", "spectrum", n, n, [&]() {
+		const q15_t* spectrum = stft.spectrum();
+		benchKeep(spectrum[2]);
+	});
+}
+
+/* Band levels from a spectrum: the abs() sums of the sketch before Band_Energy, with the bin table of begin()
+*   and with the compile time ranges, and the spectrum bars of the band frames at 16, 39 and a bar per led on both scales
+*/
+static void benchBands(Bench_Runner& bench, const Loop_Source& audio) {
+	const uint32_t n = Config::fftSize;
+	std::vector<q15_t> spectrum(2 * Config::maxBin());
+	for (size_t i = 0; i < spectrum.size(); i++) {
+		spectrum[i] = audio.data()[i] >> 2;
+	}
+
+	Band_Map map;
+	uint32_t upper[Config::numBands];
+	for (uint8_t b = 0; b < Config::numBands; b++) {
+		upper[b] = Config::bandUpper(b);
+	}
+	map.configure(Config::sampleRate, n, upper, Config::numBands);
+	Band_Energy energy;
+	energy.begin(map);
+
+	// the old loops: |re| and |im| summed per band with a multiply in the condition, shifted and one magnitude
+	// per band as arm_cmplx_mag_q31 computes it. The bin width is rounded up to whole deciHz like the sketch's
+	// fundamentalFreq, which keeps the last band inside the spectrum.
+	const uint32_t fundamental = (Config::sampleRate * 10 + n - 1) / n;
+	bench.run("bands", "abs_sum_baseline", n, Config::maxBin(), [&]() {
+		q31_t sums[Config::numBands][2];
+		q31_t magnitudes[Config::numBands];
+		uint32_t iFFT = 2;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			sums[b][0] = 0;
+			sums[b][1] = 0;
+			for (; (iFFT >> 1) * fundamental < Config::bandUpper(b); iFFT += 2) {
+				sums[b][0] += abs(spectrum[iFFT]);
+				sums[b][1] += abs(spectrum[iFFT + 1]);
+			}
+			sums[b][0] <<= 8;
+			sums[b][1] <<= 8;
+			const int64_t power = (((int64_t)sums[b][0] * sums[b][0]) >> 33) + (((int64_t)sums[b][1] * sums[b][1]) >> 33);
+			magnitudes[b] = (q31_t)sqrt((double)power * 2147483648.0); // Q2.30
+		}
+		benchKeep(magnitudes);
+	});
+	bench.run("bands", "accumulate_table", n, Config::maxBin(), [&]() {
+		energy.accumulate(spectrum.data());
+		benchKeep(energy);
+	});
+	bench.run("bands", "accumulate_fixed", n, Config::maxBin(), [&]() {
+		energy.accumulate<Config>(spectrum.data());
+		benchKeep(energy);
+	});
+
+	const uint16_t barCounts[] = { 16, 39, Config::numLeds };
+	const BAR_SPACING spacings[] = { BAR_SPACING::LOG, BAR_SPACING::MEL };
+	const char* spacingNames[] = { "log", "mel" };
+	uint8_t levels[SPECTRUM_BARS_MAX];
+	for (uint16_t count : barCounts) {
+		for (uint8_t s = 0; s < 2; s++) {
+			Spectrum_Bars bars;
+			bars.begin(Config::sampleRate, n, Config::maxBin(), count, PIPELINE_SPECTRUM_LOW, spacings[s]);
+			char name[32];
+			snprintf(name, sizeof(name), "bars_%s_%u", spacingNames[s], count);
+			bench.run("bands", name, count, Config::maxBin(), [&]() {
+				bars.compute(spectrum.data(), levels);
+				benchKeep(levels[0]);
+			});
+		}
+	}
+
+	Goertzel_Bands goertzel;
+	goertzel.begin(map, goertzelFiltersPerBand);
+	bench.run("bands", "goertzel_hop", Config::hopSize, Config::hopSize, [&]() {
+		goertzel.process(audio.data(), Config::hopSize);
+		benchKeep(goertzel);
+	});
+}
+
+/* Hue along the strip, as Audio_Pipeline::render() does: converted per led, and the bars from the palette table
+*
+*/
+static void benchLeds(Bench_Runner& bench) {
+	Rgb leds[Config::numLeds];
+	uint8_t start = 0;
+	bench.run("leds", "hsv_fill", Config::numLeds, Config::numLeds, [&]() {
+		uint8_t hue = start++;
+		for (uint16_t i = 0; i < Config::numLeds; i++) {
+			leds[i] = hsvColor(hue++, 255, i & 1 ? 255 : 0);
+		}
+		benchKeep(leds[0]);
+	});
+
+	// the bars of render(), with levels running through every height: per led conversion against the palette
+	uint16_t height = 0;
+	bench.run("leds", "hsv_bar", Config::numLeds, Config::numLeds, [&]() {
+		uint8_t hue = 100;
+		height = height < Config::ledsPerBand ? height + 1 : 0;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const Led_Segment segment = Config::ledSegment(b);
+			const uint16_t ledsOn = (uint16_t)((height + 13 * b) % (segment.numLeds + 1));
+			for (uint16_t i = 0; i < segment.numLeds; i++) {
+				leds[segment.firstLed + i] = hsvColor(hue++, 255, i < ledsOn ? 255 : 0);
+			}
+		}
+		benchKeep(leds[0]);
+	});
+	Led_Palette palette;
+	palette.begin(255, 255);
+	height = 0;
+	bench.run("leds", "palette_bar", Config::numLeds, Config::numLeds, [&]() {
+		uint8_t hue = 100;
+		height = height < Config::ledsPerBand ? height + 1 : 0;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const Led_Segment segment = Config::ledSegment(b);
+			palette.fillBar(leds, segment, (uint16_t)((height + 13 * b) % (segment.numLeds + 1)), hue);
+			hue += segment.numLeds;
+		}
+		benchKeep(leds[0]);
+	});
+}
+
+/* Every effect of the renderer drawing a frame, with levels that move every call and a new analysis frame
+*   every fifth call, about the ratio of the 200 Hz render rate to the 39 Hz hop rate
+*/
+static void benchEffects(Bench_Runner& bench) {
+	Rgb leds[Config::numLeds];
+	Led_Palette palette;
+	palette.begin(255, 255);
+	Band_Frame frame = {};
+	frame.spectrumBars = Config::numLeds;
+	uint32_t levels[Config::numBands] = {};
+	uint32_t peaks[Config::numBands] = {};
+
+	typedef Desk_Light_Effects<Config> Effects;
+	for (uint8_t e = 0; e < Effects::count; e++) {
+		Effects effects;
+		effects.select(e);
+		uint32_t call = 0;
+		bench.run("effects", Effects::name(e), Config::numLeds, Config::numLeds, [&]() {
+			call++;
+			for (uint8_t b = 0; b < Config::numBands; b++) {
+				const uint32_t full = (uint32_t)Config::ledSegment(b).numLeds << BAND_FRAME_FRACTION_BITS;
+				levels[b] = (call * 97 + b * 3001) % full;
+				peaks[b] = levels[b] + (full - levels[b]) / 2;
+				frame.leds[b] = (call / 5 * 211 + b * 1709) % full;
+			}
+			for (uint16_t i = 0; i < frame.spectrumBars; i++) {
+				frame.spectrum[i] = (uint8_t)(i * 2 + call / 5 * 7);
+			}
+			const Effect_Input input = { levels, peaks, &frame, call % 5 == 0, call * 5000, 5000 };
+			effects.render(input, leds, palette);
+			benchKeep(leds[0]);
+		});
+	}
+}
+
+/* One hop through the whole pipeline: source, analysis, render, sink
+*
+*/
+static void benchFrame(Bench_Runner& bench) {
+	struct Variant {
+		const char* name;
+		ANALYSIS_ENGINE engine;
+		bool full;
+	};
+	const Variant variants[] = { { "fft_pruned", ANALYSIS_ENGINE::FFT, false }, { "fft_full", ANALYSIS_ENGINE::FFT, true },
+		{ "goertzel", ANALYSIS_ENGINE::GOERTZEL, false } };
+
+	for (const Variant& variant : variants) {
+		Loop_Source source;
+		File_Led_Sink sink;
+		sink.open(nullptr);
+		Fft_Engine engine;
+		Pruned_Rfft pruned(engine);
+		Full_Rfft full(engine);
+		Audio_Pipeline<Config> pipeline(source, variant.full ? static_cast<Fft_Backend&>(full) : static_cast<Fft_Backend&>(pruned), sink);
+		pipeline.begin(variant.engine, fftWindow, inputGain, goertzelFiltersPerBand);
+		pipeline.setMaxLevel(0, maxBass);
+		pipeline.setMaxLevel(1, maxMid);
+		pipeline.setMaxLevel(2, maxTreble);
+
+		bench.run("frame", variant.name, Config::fftSize, Config::hopSize, [&]() {
+			pipeline.process();
+			benchKeep(pipeline);
+		});
+	}
+}
+
+static void usage() {
+	fprintf(stderr, "usage: desk_light_bench [--json] [--output <file>] [--filter <text>] [--repetitions <n>] [--min-time <s>] [--compare <baseline.csv>] [--tolerance <fraction>]\n");
+}
+
+int main(int argc, char** argv) {
+	BENCH_FORMAT format = BENCH_FORMAT::CSV;
+	const char* outputPath = nullptr;
+	const char* filter = "";
+	const char* baselinePath = nullptr;
+	uint32_t repetitions = 9;
+	double minSeconds = 0.02;
+	double tolerance = 0.1;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0) {
+			format = BENCH_FORMAT::JSON;
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			outputPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+			filter = argv[++i];
+		}
+		else if (strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+			repetitions = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+			minSeconds = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+			baselinePath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+			tolerance = strtod(argv[++i], nullptr);
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+
+	static Loop_Source audio;
+	Bench_Runner bench(repetitions, minSeconds, filter);
+	benchFft(bench, audio);
+	benchCapture(bench, audio);
+	benchConditioning(bench, audio);
+	benchBands(bench, audio);
+	benchLeds(bench);
+	benchEffects(bench);
+	benchFrame(bench);
+
+	if (outputPath != nullptr) {
+		FILE* file = fopen(outputPath, "w");
+		if (file == nullptr) {
+			fprintf(stderr, "can't create %s\n", outputPath);
+			return 1;
+		}
+		bench.print(file, format);
+		fclose(file);
+	}
+	else if (baselinePath == nullptr) {
+		bench.print(stdout, format);
+	}
+
+	if (baselinePath != nullptr) {
+		uint32_t regressions = 0;
+		if (!bench.compare(baselinePath, tolerance, regressions)) {
+			fprintf(stderr, "can't read %s\n", baselinePath);
+			return 2;
+		}
+		if (regressions > 0) {
+			fprintf(stderr, "%u cases slower than the baseline by more than %.0f %%\n", regressions, tolerance * 100);
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,228 @@
+/*
+ Name:		latency_main.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Audio to light latency of the desk light for several fft sizes and capture block sizes,
+ simulated with a virtual clock (see Latency_Harness.h), with the FFT and the Goertzel analysis.
+
+ Usage: desk_light_latency [--config <list>] [--block <list>] [--engine <list>] [--onsets <n>] [--interval <s>]
+                           [--compute-us <us>] [--cpu-scale <f>] [--seed <n>] [--csv <file>]
+   --config      fft/hop pairs, comma separated or all: 8192/1024 (the desk light), 8192/8192 (no overlap),
+                 4096/512, 2048/256, 1024/128
+   --block       capture block sizes in samples, comma separated, default 256 (the ADC DMA block)
+   --engine      fft, goertzel or both comma separated, default both; the Goertzel levels change once per
+                 fftSize block instead of once per hop, their latency is up to a block longer
+   --onsets      kick drums per run, default 200
+   --interval    seconds between kick drums, default 1
+   --compute-us  fixed compute time per hop instead of the measured host time
+   --cpu-scale   factor on the measured host time, default 1
+   --csv         write the latency of every onset
+ The summary has the latency up to show() (emit) and up to the leds latching the frame (light), in ms.
+ max_backlog_ms is the most audio waiting for the pipeline, more than a hop plus a block means it can't keep up
+ (e.g. hops shorter than the 3.8 ms transfer of 117 leds) and the desk light would drop samples.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include "Desk_Light_Config.h"
+#include "Latency_Harness.h"
+
+// same rate, leds and bands as the desk light, other fft and hop sizes
+typedef Pipeline_Config<8192, 8192, 40000, 117, 2500, 15000, 50000> Config_8192_8192;
+typedef Pipeline_Config<4096, 512, 40000, 117, 2500, 15000, 50000> Config_4096_512;
+typedef Pipeline_Config<2048, 256, 40000, 117, 2500, 15000, 50000> Config_2048_256;
+typedef Pipeline_Config<1024, 128, 40000, 117, 2500, 15000, 50000> Config_1024_128;
+
+//! A configuration that can be selected on the command line
+struct Latency_Config {
+	const char* name;
+	bool (*measure)(const Latency_Options& options, std::vector<Latency_Result>& results, uint64_t& maxBacklog);
+};
+
+static const Latency_Config configs[] = {
+	{ "8192/1024", measureLatency<Config> },
+	{ "8192/8192", measureLatency<Config_8192_8192> },
+	{ "4096/512", measureLatency<Config_4096_512> },
+	{ "2048/256", measureLatency<Config_2048_256> },
+	{ "1024/128", measureLatency<Config_1024_128> },
+};
+
+//! An analysis engine that can be selected on the command line
+struct Latency_Engine {
+	const char* name;
+	ANALYSIS_ENGINE engine;
+};
+
+static const Latency_Engine engines[] = {
+	{ "fft", ANALYSIS_ENGINE::FFT },
+	{ "goertzel", ANALYSIS_ENGINE::GOERTZEL },
+};
+
+//! Value at percentile p of sorted values
+static double percentile(const std::vector<double>& sorted, double p) {
+	size_t index = (size_t)(p / 100 * sorted.size() + 0.999999);
+	index = index > 0 ? index - 1 : 0;
+	return sorted[index < sorted.size() ? index : sorted.size() - 1];
+}
+
+//! Split a comma separated list
+static std::vector<std::string> splitList(const char* text) {
+	std::vector<std::string> items;
+	std::string item;
+	for (const char* c = text; ; c++) {
+		if (*c == ',' || *c == '\0') {
+			if (!item.empty()) {
+				items.push_back(item);
+			}
+			item.clear();
+			if (*c == '\0') {
+				break;
+			}
+		}
+		else {
+			item += *c;
+		}
+	}
+	return items;
+}
+
+static void usage() {
+	fprintf(stderr, "usage: desk_light_latency [--config <list>|all] [--block <list>] [--engine <list>] [--onsets <n>] [--interval <s>] [--compute-us <us>] [--cpu-scale <f>] [--seed <n>] [--csv <file>]\n");
+}
+
+int main(int argc, char** argv) {
+	Latency_Options options = { 200, 1.0, 256, -1, 1.0, 1, ANALYSIS_ENGINE::FFT };
+	std::vector<std::string> configNames = { "8192/1024" };
+	std::vector<std::string> blocks = { "256" };
+	std::vector<std::string> engineNames = { "fft", "goertzel" };
+	const char* csvPath = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+			configNames = strcmp(argv[++i], "all") == 0 ? std::vector<std::string>() : splitList(argv[i]);
+			if (configNames.empty()) {
+				for (const Latency_Config& config : configs) {
+					configNames.push_back(config.name);
+				}
+			}
+		}
+		else if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+			blocks = splitList(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+			engineNames = splitList(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--onsets") == 0 && i + 1 < argc) {
+			options.onsets = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+			options.intervalSeconds = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--compute-us") == 0 && i + 1 < argc) {
+			options.computeMicros = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--cpu-scale") == 0 && i + 1 < argc) {
+			options.cpuScale = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			options.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+			csvPath = argv[++i];
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (options.onsets == 0 || options.intervalSeconds < 0.5) {
+		fprintf(stderr, "need at least one onset and 0.5 s between onsets, the window is 0.2 s\n");
+		return 2;
+	}
+
+	std::vector<const Latency_Engine*> selectedEngines;
+	for (const std::string& name : engineNames) {
+		const Latency_Engine* engine = nullptr;
+		for (const Latency_Engine& candidate : engines) {
+			if (name == candidate.name) {
+				engine = &candidate;
+			}
+		}
+		if (engine == nullptr) {
+			fprintf(stderr, "unknown engine %s\n", name.c_str());
+			return 2;
+		}
+		selectedEngines.push_back(engine);
+	}
+
+	FILE* csv = nullptr;
+	if (csvPath != nullptr) {
+		csv = fopen(csvPath, "w");
+		if (csv == nullptr) {
+			fprintf(stderr, "can't create %s\n", csvPath);
+			return 1;
+		}
+		fprintf(csv, "config,engine,block,onset_s,detected,emit_ms,light_ms\n");
+	}
+
+	printf("config,engine,block,onsets,detected,emit_p50_ms,light_min_ms,light_p50_ms,light_p90_ms,light_p99_ms,light_max_ms,light_mean_ms,max_backlog_ms\n");
+	for (const std::string& name : configNames) {
+		const Latency_Config* config = nullptr;
+		for (const Latency_Config& candidate : configs) {
+			if (name == candidate.name) {
+				config = &candidate;
+			}
+		}
+		if (config == nullptr) {
+			fprintf(stderr, "unknown config %s\n", name.c_str());
+			return 2;
+		}
+
+		for (const Latency_Engine* engine : selectedEngines) {
+			options.engine = engine->engine;
+			for (const std::string& block : blocks) {
+				options.blockSize = (uint32_t)strtoul(block.c_str(), nullptr, 10);
+				std::vector<Latency_Result> results;
+				uint64_t maxBacklog = 0;
+				if (!config->measure(options, results, maxBacklog)) {
+					fprintf(stderr, "can't set up %s with %s\n", config->name, engine->name);
+					return 1;
+				}
+
+				std::vector<double> emit;
+				std::vector<double> light;
+				double sum = 0;
+				for (const Latency_Result& result : results) {
+					if (csv != nullptr) {
+						fprintf(csv, "%s,%s,%u,%.5f,%d,%.3f,%.3f\n", config->name, engine->name, options.blockSize, result.onsetSeconds, result.detected ? 1 : 0,
+							result.emitMillis, result.lightMillis);
+					}
+					if (result.detected) {
+						emit.push_back(result.emitMillis);
+						light.push_back(result.lightMillis);
+						sum += result.lightMillis;
+					}
+				}
+				const double backlogMillis = maxBacklog * 1000.0 / Config::sampleRate;
+				if (light.empty()) {
+					printf("%s,%s,%u,%u,0,,,,,,,,%.1f\n", config->name, engine->name, options.blockSize, (unsigned)results.size(), backlogMillis);
+					continue;
+				}
+				std::sort(emit.begin(), emit.end());
+				std::sort(light.begin(), light.end());
+				printf("%s,%s,%u,%u,%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.1f\n", config->name, engine->name, options.blockSize, (unsigned)results.size(),
+					(unsigned)light.size(), percentile(emit, 50), light.front(), percentile(light, 50), percentile(light, 90),
+					percentile(light, 99), light.back(), sum / light.size(), backlogMillis);
+			}
+		}
+	}
+
+	if (csv != nullptr) {
+		fclose(csv);
+	}
+	return 0;
+}
@@ -0,0 +1,268 @@
+/*
+ Name:		main.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Host build of the desk light. Runs the pipeline of the sketch on an audio file
+ and writes the led frames to a file. Files with another sample rate are resampled to the capture rate.
+
+ Usage: desk_light_host <input.wav | input.raw> [output.rgb] [--command <text>] [--commands <path>] [--realtime]
+                        [--rate <Hz>] [--goertzel] [--full-fft] [--profile] [--telemetry <file>]
+   --command   tuning commands as on the serial port of the desk light (see Command_Channel.h), lines separated
+               by newlines, one line is taken per hop
+   --commands  read tuning commands from a file, fifo or pseudo-terminal while the file is analysed
+   --realtime  analyse at the pace of the audio, for typing commands into --commands
+   --rate      sample rate of a raw 16 bit PCM input
+   --goertzel  use the Goertzel filter bank instead of the FFT
+   --full-fft  use a full size FFT instead of the pruned FFT
+   --profile   print the timing of every stage over the last hops and the frame counters
+   --telemetry write the binary telemetry the sketch sends, for desk_light_telemetry
+ Without an output file the frames are only counted.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Fft_Engine.h"
+#include "Pruned_Rfft.h"
+#include "Full_Rfft.h"
+#include "File_Source.h"
+#include "File_Led_Sink.h"
+#include "Telemetry_Writer.h"
+#include "Command_Channel.h"
+#include "File_Command_Input.h"
+
+#define TELEMETRY_SPECTRUM_DECIMATION 16 // bins per magnitude in the spectrum frames, as on the desk light
+
+//! Telemetry to a file, takes everything at once
+class File_Port : public Telemetry_Port {
+public:
+	explicit File_Port(FILE* output) : file(output) {}
+	uint32_t writable() override { return UINT32_MAX; }
+	uint32_t write(const uint8_t* data, uint32_t count) override { return (uint32_t)fwrite(data, 1, count, file); }
+private:
+	FILE* file;
+};
+
+//! Band levels, leds lit and spectrum of the latest frame, the frame telemetry of the sketch
+static void sendFrameTelemetry(Audio_Pipeline<Config>& pipeline, Telemetry_Writer& telemetry, uint32_t sampleRate) {
+	q31_t levels[Config::numBands];
+	uint16_t ledsOn[Config::numBands];
+	for (uint8_t b = 0; b < Config::numBands; b++) {
+		levels[b] = pipeline.level(b);
+		ledsOn[b] = pipeline.ledsOn(b);
+	}
+	const uint32_t frame = pipeline.framesShown();
+	telemetry.sendBands(frame, levels, Config::numBands);
+	telemetry.sendLeds(frame, ledsOn, Config::numBands);
+	if (pipeline.spectrum() != nullptr) {
+		telemetry.sendSpectrum(frame, pipeline.spectrum(), pipeline.spectrumBins(), (uint32_t)((uint64_t)sampleRate * 1000 / Config::fftSize),
+			TELEMETRY_SPECTRUM_DECIMATION);
+	}
+}
+
+//! Stage timing in microseconds
+static void printProfile(const Stage_Profiler& profiler) {
+	printf("stage,count,min_us,p50_us,p99_us,max_us\n");
+	for (uint8_t s = 0; s < (uint8_t)PIPELINE_STAGE::COUNT; s++) {
+		const Stage_Stats stats = profiler.stats((PIPELINE_STAGE)s);
+		printf("%s,%u,%.1f,%.1f,%.1f,%.1f\n", Stage_Profiler::stageName((PIPELINE_STAGE)s), stats.count, Stage_Profiler::toMicros(stats.min),
+			Stage_Profiler::toMicros(stats.p50), Stage_Profiler::toMicros(stats.p99), Stage_Profiler::toMicros(stats.max));
+	}
+}
+
+//! Tunable parameters on one line
+static void printParams(const Pipeline_Params& params) {
+	printf("brightness %u, quiet %u, effect %u, bars %u, spacing %u", params.brightness, params.quietLeds, params.effect, params.spectrumBars,
+		params.barSpacing);
+	for (uint8_t b = 0; b < params.numBands; b++) {
+		printf(", band %u max %d edge %u", b, params.maxLevels[b], params.bandUpper[b]);
+	}
+	printf("\n");
+}
+
+//! Take a command line if one is complete and answer it like the sketch, on stdout and in the telemetry
+static void pollCommands(Command_Channel& commands, Command_Input& input, Audio_Pipeline<Config>& pipeline, Telemetry_Writer& telemetry,
+	bool sendTelemetry) {
+	Pipeline_Params params = pipeline.params();
+	const COMMAND_RESULT result = commands.poll(input, params);
+	if (result == COMMAND_RESULT::NONE) {
+		return;
+	}
+	printf("frame %u: ", pipeline.framesShown());
+	bool valid = result != COMMAND_RESULT::INVALID;
+	if (result == COMMAND_RESULT::SET) {
+		valid = pipeline.setParams(params);
+	}
+	if (result == COMMAND_RESULT::PROFILE) {
+		printf("profile\n");
+		printProfile(pipeline.profiler());
+		if (sendTelemetry) {
+			telemetry.sendProfile(pipeline.profiler());
+		}
+		return;
+	}
+	if (!valid) {
+		printf("rejected, ");
+	}
+	printParams(pipeline.params());
+	if (sendTelemetry) {
+		telemetry.sendParams(pipeline.params(), valid ? TELEMETRY_PARAMS_CURRENT : TELEMETRY_PARAMS_INVALID);
+	}
+}
+
+static void usage() {
+	fprintf(stderr, "usage: desk_light_host <input.wav | input.raw> [output.rgb] [--command <text>] [--commands <path>] [--realtime]"
+		" [--rate <Hz>] [--goertzel] [--full-fft] [--profile] [--telemetry <file>]\n");
+}
+
+int main(int argc, char** argv) {
+	const char* inputPath = nullptr;
+	const char* outputPath = nullptr;
+	uint32_t rawRate = Config::sampleRate;
+	ANALYSIS_ENGINE engine = analysisEngine;
+	bool fullFft = false;
+	bool profile = false;
+	const char* telemetryPath = nullptr;
+	const char* commandText = nullptr;
+	const char* commandPath = nullptr;
+	bool realtime = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+			rawRate = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--goertzel") == 0) {
+			engine = ANALYSIS_ENGINE::GOERTZEL;
+		}
+		else if (strcmp(argv[i], "--full-fft") == 0) {
+			fullFft = true;
+		}
+		else if (strcmp(argv[i], "--profile") == 0) {
+			profile = true;
+		}
+		else if (strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+			telemetryPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--command") == 0 && i + 1 < argc) {
+			commandText = argv[++i];
+		}
+		else if (strcmp(argv[i], "--commands") == 0 && i + 1 < argc) {
+			commandPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--realtime") == 0) {
+			realtime = true;
+		}
+		else if (argv[i][0] == '-') {
+			usage();
+			return 2;
+		}
+		else if (inputPath == nullptr) {
+			inputPath = argv[i];
+		}
+		else if (outputPath == nullptr) {
+			outputPath = argv[i];
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (inputPath == nullptr) {
+		usage();
+		return 2;
+	}
+
+	static File_Source source;
+	if (!source.open(inputPath, rawRate, Config::sampleRate)) {
+		fprintf(stderr, "can't read %s\n", inputPath);
+		return 1;
+	}
+	static File_Led_Sink sink;
+	if (!sink.open(outputPath)) {
+		fprintf(stderr, "can't create %s\n", outputPath);
+		return 1;
+	}
+
+	static Fft_Engine fft;
+	static Pruned_Rfft pruned(fft);
+	static Full_Rfft full(fft);
+	Fft_Backend& backend = fullFft ? static_cast<Fft_Backend&>(full) : static_cast<Fft_Backend&>(pruned);
+
+	static Audio_Pipeline<Config> pipeline(source, backend, sink);
+	if (!pipeline.begin(engine, fftWindow, inputGain, goertzelFiltersPerBand)) {
+		fprintf(stderr, "can't set up the pipeline\n");
+		return 1;
+	}
+	pipeline.setMaxLevel(0, maxBass);
+	pipeline.setMaxLevel(1, maxMid);
+	pipeline.setMaxLevel(2, maxTreble);
+
+	FILE* telemetryFile = nullptr;
+	if (telemetryPath != nullptr) {
+		telemetryFile = fopen(telemetryPath, "wb");
+		if (telemetryFile == nullptr) {
+			fprintf(stderr, "can't create %s\n", telemetryPath);
+			return 1;
+		}
+	}
+	static Telemetry_Writer telemetry;
+	File_Port telemetryPort(telemetryFile);
+
+	std::string commandLines = commandText != nullptr ? std::string(commandText) + "\n" : std::string();
+	Text_Command_Input textInput(commandLines.c_str());
+	File_Command_Input fileInput;
+	if (commandPath != nullptr && !fileInput.open(commandPath)) {
+		fprintf(stderr, "can't read %s\n", commandPath);
+		return 1;
+	}
+	Command_Input& commandInput = commandPath != nullptr ? static_cast<Command_Input&>(fileInput) : static_cast<Command_Input&>(textInput);
+	Command_Channel commands;
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	while (!source.finished()) {
+		if (pipeline.process() && telemetryFile != nullptr) {
+			sendFrameTelemetry(pipeline, telemetry, source.sampleRate());
+		}
+		pollCommands(commands, commandInput, pipeline, telemetry, telemetryFile != nullptr);
+		if (telemetryFile != nullptr) {
+			telemetry.pump(telemetryPort);
+		}
+		if (realtime) {
+			std::this_thread::sleep_until(start + std::chrono::microseconds(source.samplesRead() * 1000000 / source.sampleRate()));
+		}
+	}
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double audioSeconds = (double)source.samplesRead() / source.sampleRate();
+	printf("file %llu frames at %u Hz, samples %llu (%.1f s at %u Hz), led frames %u\n", (unsigned long long)source.framesConsumed(), source.fileRate(),
+		(unsigned long long)source.samplesRead(), audioSeconds, source.sampleRate(), sink.frames());
+	printf("%.3f s, %.0fx real time, %.2f Msamples/s\n", seconds, seconds > 0 ? audioSeconds / seconds : 0,
+		seconds > 0 ? source.samplesRead() / seconds / 1e6 : 0);
+
+	if (telemetryFile != nullptr) {
+		Telemetry_Record record = { 0, (uint32_t)(audioSeconds * 1000), pipeline.counters(), 0 };
+		telemetry.sendCounters(record);
+		telemetry.sendProfile(pipeline.profiler());
+		telemetry.pump(telemetryPort);
+		fclose(telemetryFile);
+		printf("telemetry frames %u, dropped %u\n", telemetry.framesSent(), telemetry.framesDropped());
+	}
+
+	if (profile) {
+		// the file source never waits, so the capture wait is only the loop around process()
+		printProfile(pipeline.profiler());
+		// nothing is dropped from a file, deadline misses are hops that took longer than real time
+		const Frame_Counters counters = pipeline.counters();
+		printf("frames produced %u, processed %u, windows skipped %u, overruns %u, deadline misses %u (%.1f us)\n", counters.framesProduced,
+			counters.framesProcessed, counters.windowsSkipped, counters.isrOverruns, counters.deadlineMisses, Stage_Profiler::toMicros(pipeline.deadline()));
+		printf("led frames %u, unchanged %u (%.1f%% not sent to the strip)\n", counters.ledFrames, counters.ledFramesUnchanged,
+			counters.ledFrames > 0 ? 100.0 * counters.ledFramesUnchanged / counters.ledFrames : 0);
+	}
+	return 0;
+}
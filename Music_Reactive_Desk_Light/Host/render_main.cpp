@@ -0,0 +1,138 @@
+/*
+ Name:		render_main.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Simulation of the led renderer running at its own rate next to the analysis
+ (see Render_Simulation.h), checks that the bars move smoothly and that rendering fits the cpu budget.
+
+ Usage: desk_light_render <input.wav | input.raw> [--rate <Hz>] [--render-rate <Hz>] [--attack <leds/s>] [--decay <leds/s>]
+                          [--hold <ms>] [--peak-decay <leds/s>] [--cpu-scale <f>] [--budget <percent>] [--stress <ms>] [--effect <n>]
+   --rate         sample rate of a raw 16 bit PCM input
+   --render-rate  led frames per second, default ledRenderRate of Desk_Light_Config.h
+   --attack, --decay, --hold, --peak-decay  motion of the bars, defaults from Desk_Light_Config.h, 0 follows at once
+   --cpu-scale    factor on the measured host times, e.g. the Teensy's slowdown against the host, default 1
+   --budget       share of the render period a render may take at p99, default 25 %
+   --stress       also publish and read the latest value slot from two threads for this long
+   --effect       LED_EFFECT the renderer draws, default 0 (vu bars)
+ Exits with 1 if a bar jumps further between two render frames than attack and decay allow, if the renderer
+ isn't smoother than the direct output, if rendering exceeds the budget or if the slot returned a torn frame.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "Desk_Light_Config.h"
+#include "File_Source.h"
+#include "Render_Simulation.h"
+
+static void usage() {
+	fprintf(stderr, "usage: desk_light_render <input.wav | input.raw> [--rate <Hz>] [--render-rate <Hz>] [--attack <leds/s>] [--decay <leds/s>] [--hold <ms>] [--peak-decay <leds/s>] [--cpu-scale <f>] [--budget <percent>] [--stress <ms>] [--effect <n>]\n");
+}
+
+//! Print the motion of one output
+static void printMotion(const char* name, const Render_Motion& motion, double seconds) {
+	printf("%-9s moves %5.1f per band and second, max step %2u leds, mean step %.2f leds\n", name,
+		seconds > 0 ? motion.moves / seconds / Config::numBands : 0, motion.maxStep, motion.meanStep);
+}
+
+int main(int argc, char** argv) {
+	const char* inputPath = nullptr;
+	uint32_t rawRate = 44100;
+	Render_Options options = { ledRenderRate, { barAttack, barDecay, peakHoldMs, peakFall }, 1.0, (uint8_t)LED_EFFECT::VU_BARS };
+	double budget = 25;
+	uint32_t stressMillis = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+			rawRate = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--render-rate") == 0 && i + 1 < argc) {
+			options.renderRate = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--attack") == 0 && i + 1 < argc) {
+			options.envelope.attack = (uint16_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--decay") == 0 && i + 1 < argc) {
+			options.envelope.decay = (uint16_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--hold") == 0 && i + 1 < argc) {
+			options.envelope.peakHold = (uint16_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--peak-decay") == 0 && i + 1 < argc) {
+			options.envelope.peakDecay = (uint16_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--cpu-scale") == 0 && i + 1 < argc) {
+			options.cpuScale = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+			budget = strtod(argv[++i], nullptr);
+		}
+		else if (strcmp(argv[i], "--stress") == 0 && i + 1 < argc) {
+			stressMillis = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (strcmp(argv[i], "--effect") == 0 && i + 1 < argc) {
+			options.effect = (uint8_t)strtoul(argv[++i], nullptr, 10);
+		}
+		else if (argv[i][0] != '-' && inputPath == nullptr) {
+			inputPath = argv[i];
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (inputPath == nullptr || options.renderRate == 0) {
+		usage();
+		return 2;
+	}
+
+	File_Source source;
+	if (!source.open(inputPath, rawRate, Config::sampleRate)) {
+		fprintf(stderr, "can't read %s\n", inputPath);
+		return 1;
+	}
+	Render_Report report;
+	if (!simulateRender(source, options, report)) {
+		fprintf(stderr, "can't set up the pipeline\n");
+		return 1;
+	}
+
+	const double seconds = (double)report.renderFrames / options.renderRate;
+	const double hopRate = (double)source.sampleRate() / Config::hopSize;
+	printf("%.1f s, %u analysis frames (%.1f per s), %u render frames (%u per s), %u sent to the strip (%.1f%%)\n", seconds,
+		report.analysisFrames, hopRate, report.renderFrames, options.renderRate, report.framesSent,
+		report.renderFrames > 0 ? 100.0 * report.framesSent / report.renderFrames : 0);
+	printMotion("direct", report.direct, seconds);
+	printMotion("rendered", report.rendered, seconds);
+	printf("mean difference rendered - direct %.2f leds\n", report.meanOffset);
+
+	// a step may be the attack or decay of one period, plus one led of rounding
+	const uint16_t fastest = options.envelope.attack > options.envelope.decay ? options.envelope.attack : options.envelope.decay;
+	const bool limited = options.envelope.attack > 0 && options.envelope.decay > 0;
+	const uint32_t maxStep = limited ? (uint32_t)ceil((double)fastest / options.renderRate) + 1 : report.direct.maxStep;
+	const bool smooth = report.rendered.maxStep <= maxStep && report.rendered.maxStep <= report.direct.maxStep;
+
+	const double periodMicros = 1e6 / options.renderRate;
+	const double renderP50 = Stage_Profiler::toMicros(report.renderTicks.p50) * options.cpuScale;
+	const double renderP99 = Stage_Profiler::toMicros(report.renderTicks.p99) * options.cpuScale;
+	const double analysisP50 = Stage_Profiler::toMicros(report.analysisTicks.p50) * options.cpuScale;
+	const double load = (renderP50 * options.renderRate + analysisP50 * hopRate) / 1e4;
+	const bool inBudget = renderP99 <= periodMicros * budget / 100;
+	printf("render p50 %.2f us, p99 %.2f us of a %.0f us period (budget %.0f%%), analysis p50 %.1f us, cpu load %.2f%%\n", renderP50, renderP99,
+		periodMicros, budget, analysisP50, load);
+	printf("smoothness %s (max step %u, allowed %u), cpu budget %s\n", smooth ? "ok" : "FAILED", report.rendered.maxStep, maxStep,
+		inBudget ? "ok" : "FAILED");
+
+	bool slotOk = true;
+	if (stressMillis > 0) {
+		uint64_t reads = 0;
+		uint64_t bad = 0;
+		stressSlot(stressMillis, reads, bad);
+		slotOk = reads > 0 && bad == 0;
+		printf("slot stress %u ms: %llu frames read, %llu torn or out of order, %s\n", stressMillis, (unsigned long long)reads,
+			(unsigned long long)bad, slotOk ? "ok" : "FAILED");
+	}
+	return smooth && inBudget && slotOk ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/*
+ Name:		Arduino.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Host stand-in for the parts of the Teensy 4.0 core used by My_ADC. The peripheral registers are
+ plain structs in memory and the core functions only record what they were asked to do, so the ADC code
+ can run on Linux against registers a test can set and inspect. Bit positions follow imxrt.h.
+*/
+#ifndef Arduino_H
+#define Arduino_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//////////// ADC ////////////////
+#define ADC_HC_AIEN					((uint32_t)(1 << 7))
+#define ADC_HS_COCO0				((uint32_t)(1 << 0))
+#define ADC_CFG_AVGS(n)				((uint32_t)(((n) & 0x03) << 14))
+#define ADC_CFG_ADTRG				((uint32_t)(1 << 13))
+#define ADC_CFG_REFSEL(n)			((uint32_t)(((n) & 0x03) << 11))
+#define ADC_CFG_ADHSC				((uint32_t)(1 << 10))
+#define ADC_CFG_ADSTS(n)			((uint32_t)(((n) & 0x03) << 8))
+#define ADC_CFG_ADLPC				((uint32_t)(1 << 7))
+#define ADC_CFG_ADIV(n)				((uint32_t)(((n) & 0x03) << 5))
+#define ADC_CFG_ADLSMP				((uint32_t)(1 << 4))
+#define ADC_CFG_MODE(n)				((uint32_t)(((n) & 0x03) << 2))
+#define ADC_CFG_ADICLK(n)			((uint32_t)(((n) & 0x03) << 0))
+#define ADC_GC_CAL					((uint32_t)(1 << 7))
+#define ADC_GC_ADCO					((uint32_t)(1 << 6))
+#define ADC_GC_AVGE					((uint32_t)(1 << 5))
+#define ADC_GC_ACFE					((uint32_t)(1 << 4))
+#define ADC_GC_ACFGT				((uint32_t)(1 << 3))
+#define ADC_GC_ACREN				((uint32_t)(1 << 2))
+#define ADC_GC_DMAEN				((uint32_t)(1 << 1))
+#define ADC_GC_ADACKEN				((uint32_t)(1 << 0))
+#define ADC_GS_CALF					((uint32_t)(1 << 1))
+#define ADC_GS_ADACT				((uint32_t)(1 << 0))
+#define ADC_CV_CV2(n)				((uint32_t)(((n) & 0xFFF) << 16))
+#define ADC_CV_CV1(n)				((uint32_t)(((n) & 0xFFF) << 0))
+#define ADC_OFS_OFS(n)				((uint32_t)(((n) & 0xFFF) << 0))
+
+//////////// ADC_ETC ////////////////
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t DONE0_1_IRQ;
+	volatile uint32_t DONE2_ERR_IRQ;
+	volatile uint32_t DMA_CTRL;
+	struct {
+		volatile uint32_t CTRL;
+		volatile uint32_t COUNTER;
+		volatile uint32_t CHAIN_1_0;
+		volatile uint32_t CHAIN_3_2;
+		volatile uint32_t CHAIN_5_4;
+		volatile uint32_t CHAIN_7_6;
+		volatile uint32_t RESULT_1_0;
+		volatile uint32_t RESULT_3_2;
+		volatile uint32_t RESULT_5_4;
+		volatile uint32_t RESULT_7_6;
+	} TRIG[8];
+} IMXRT_ADC_ETC_t;
+extern IMXRT_ADC_ETC_t IMXRT_ADC_ETC;
+
+#define ADC_ETC_CTRL_SOFTRST			((uint32_t)(1u << 31))
+#define ADC_ETC_CTRL_TSC_BYPASS			((uint32_t)(1 << 30))
+#define ADC_ETC_CTRL_DMA_MODE_SEL		((uint32_t)(1 << 29))
+#define ADC_ETC_CTRL_TRIG_ENABLE(n)		((uint32_t)(((n) & 0xFF) << 0))
+#define ADC_ETC_DMA_CTRL_TRIQ_ENABLE(n)	((uint32_t)(1 << (n)))
+#define ADC_ETC_TRIG_CTRL_TRIG_CHAIN(n)	((uint32_t)(((n) & 0x07) << 12))
+#define ADC_ETC_TRIG_CHAIN_IE0(n)		((uint32_t)(((n) & 0x03) << 13))
+#define ADC_ETC_TRIG_CHAIN_B2B0			((uint32_t)(1 << 12))
+#define ADC_ETC_TRIG_CHAIN_HWTS0(n)		((uint32_t)(((n) & 0xFF) << 4))
+#define ADC_ETC_TRIG_CHAIN_CSEL0(n)		((uint32_t)(((n) & 0x0F) << 0))
+
+//////////// QuadTimer ////////////////
+typedef struct {
+	struct {
+		volatile uint16_t COMP1;
+		volatile uint16_t COMP2;
+		volatile uint16_t CAPT;
+		volatile uint16_t LOAD;
+		volatile uint16_t HOLD;
+		volatile uint16_t CNTR;
+		volatile uint16_t CTRL;
+		volatile uint16_t SCTRL;
+		volatile uint16_t CMPLD1;
+		volatile uint16_t CMPLD2;
+		volatile uint16_t CSCTRL;
+		volatile uint16_t FILT;
+		volatile uint16_t DMA;
+		volatile uint16_t unused[2];
+		volatile uint16_t ENBL;
+	} CH[4];
+} IMXRT_TMR_t;
+extern IMXRT_TMR_t IMXRT_TMR4;
+
+#define TMR_CTRL_CM(n)				((uint16_t)(((n) & 0x07) << 13))
+#define TMR_CTRL_PCS(n)				((uint16_t)(((n) & 0x0F) << 9))
+#define TMR_CTRL_LENGTH				((uint16_t)(1 << 5))
+#define TMR_CTRL_OUTMODE(n)			((uint16_t)(((n) & 0x07) << 0))
+#define TMR_SCTRL_VAL				((uint16_t)(1 << 3))
+#define TMR_SCTRL_FORCE				((uint16_t)(1 << 2))
+#define TMR_SCTRL_OPS				((uint16_t)(1 << 1))
+#define TMR_SCTRL_OEN				((uint16_t)(1 << 0))
+#define TMR_CSCTRL_ALT_LOAD			((uint16_t)(1 << 13))
+#define TMR_CSCTRL_CL1(n)			((uint16_t)(((n) & 0x03) << 2))
+
+//////////// XBAR, clocks ////////////////
+#define XBARA1_IN_QTIMER4_TIMER0	36
+#define XBARA1_IN_QTIMER4_TIMER3	39
+#define XBARA1_OUT_ADC_ETC_TRIG00	103
+#define XBARA1_OUT_ADC_ETC_TRIG10	107
+
+extern volatile uint32_t CCM_CCGR1;
+extern volatile uint32_t CCM_CCGR2;
+#define CCM_CCGR_ON					3
+#define CCM_CCGR1_ADC1(n)			((uint32_t)(((n) & 0x03) << 16))
+#define CCM_CCGR1_ADC2(n)			((uint32_t)(((n) & 0x03) << 8))
+#define CCM_CCGR2_XBAR1(n)			((uint32_t)(((n) & 0x03) << 22))
+
+#define F_BUS_ACTUAL				150000000
+
+//////////// interrupts ////////////////
+enum IRQ_NUMBER_t {
+	IRQ_DMA_CH0 = 0,
+	IRQ_ADC1 = 67,
+	IRQ_ADC2 = 68
+};
+
+#define DMAMUX_SOURCE_ADC1			24
+#define DMAMUX_SOURCE_ADC2			88
+
+//! What the core functions were asked to do, for the tests to check
+struct Teensy_Mock {
+	uint32_t xbarInput;
+	uint32_t xbarOutput;
+	float timerFrequency; // last quadtimerFrequency()
+	uint32_t timerValue;  // last quadtimerWrite(), 0 stops the timer
+	void (*adcIsr)(void); // attachInterruptVector() of an ADC
+	bool adcIrqEnabled;
+};
+extern Teensy_Mock teensyMock;
+
+//! Clear the recorded calls and all registers
+void resetTeensyMock();
+
+void attachInterruptVector(IRQ_NUMBER_t irq, void (*isr)(void));
+void nvicEnableIrq(int irq, bool enable);
+#define NVIC_ENABLE_IRQ(irq)		nvicEnableIrq((irq), true)
+#define NVIC_DISABLE_IRQ(irq)		nvicEnableIrq((irq), false)
+#define NVIC_SET_PRIORITY(irq, priority)	((void)(irq), (void)(priority))
+#define __disable_irq()
+#define __enable_irq()
+
+void delay(uint32_t msec);
+void yield();
+inline void arm_dcache_delete(void*, uint32_t) {
+}
+
+// barriers like asm("DSB") mean nothing without the cache and the DMA
+#define asm(instruction)
+
+#endif // Arduino_H
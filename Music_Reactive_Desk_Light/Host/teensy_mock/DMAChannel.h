@@ -0,0 +1,80 @@
+/*
+ Name:		DMAChannel.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Host stand-in for the DMA channel of the Teensy core. A test plays the hardware: request()
+ moves one value from the source to the destination like a trigger of the ADC would, interrupt() runs the
+ attached interrupt if the half or the end of the buffer was reached since it last ran.
+*/
+#ifndef DMAChannel_H
+#define DMAChannel_H
+
+#include "Arduino.h"
+
+class DMAChannel {
+
+public:
+
+	DMAChannel();
+
+	//! Channel number, only for the interrupt priority
+	uint8_t channel;
+
+	void begin(bool force_initialization = false);
+	void source(volatile const uint16_t& p);
+	void destinationBuffer(volatile uint16_t p[], unsigned int len);
+	void interruptAtHalf() { at_half = true; }
+	void interruptAtCompletion() { at_completion = true; }
+	void triggerAtHardwareEvent(uint8_t source) { trigger = source; }
+	void attachInterrupt(void (*isr)(void)) { interrupt_isr = isr; }
+	void detachInterrupt() { interrupt_isr = nullptr; }
+	void clearInterrupt() { interrupt_pending = false; }
+	void enable() { enabled = true; }
+	void disable() { enabled = false; }
+	void* destinationAddress() { return (void*)destination; }
+
+	////////////// MOCK ///////////////
+
+	//! One hardware request: copy the source to the destination and move on, wrapping at the end
+	/** \return false if the channel is disabled.
+	*/
+	bool request();
+
+	//! Run the interrupt if one is pending, as the NVIC would once the interrupt is allowed to run
+	/** Several completed halves before it runs are still one pending interrupt.
+	*   \return true if the interrupt ran.
+	*/
+	bool interrupt();
+
+	//! Is the channel moving data?
+	bool isEnabled() const { return enabled; }
+
+	//! Hardware event that triggers the requests
+	uint8_t triggerSource() const { return trigger; }
+
+	//! Has an interrupt been attached?
+	bool hasInterrupt() const { return interrupt_isr != nullptr; }
+
+	//! Source of the transfers
+	volatile const uint16_t* sourceAddress() const { return source_address; }
+
+	//! The channel begun last, the one of the object under test
+	static DMAChannel* last() { return last_begun; }
+
+private:
+	volatile const uint16_t* source_address;
+	volatile uint16_t* buffer;
+	volatile uint16_t* destination;
+	unsigned int length; // in samples
+	bool at_half;
+	bool at_completion;
+	bool enabled;
+	bool interrupt_pending;
+	uint8_t trigger;
+	void (*interrupt_isr)(void);
+
+	static DMAChannel* last_begun;
+};
+
+#endif // DMAChannel_H
@@ -0,0 +1,101 @@
+/*
+ Name:		Teensy_Mock.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Registers and core functions of the host stand-in for the Teensy 4.0 core.
+*/
+
+#include "Arduino.h"
+#include "DMAChannel.h"
+#include <string.h>
+
+IMXRT_ADC_ETC_t IMXRT_ADC_ETC;
+IMXRT_TMR_t IMXRT_TMR4;
+volatile uint32_t CCM_CCGR1 = 0;
+volatile uint32_t CCM_CCGR2 = 0;
+Teensy_Mock teensyMock;
+
+void resetTeensyMock() {
+	memset((void*)&IMXRT_ADC_ETC, 0, sizeof(IMXRT_ADC_ETC));
+	memset((void*)&IMXRT_TMR4, 0, sizeof(IMXRT_TMR4));
+	CCM_CCGR1 = 0;
+	CCM_CCGR2 = 0;
+	teensyMock = Teensy_Mock();
+}
+
+void attachInterruptVector(IRQ_NUMBER_t, void (*isr)(void)) {
+	teensyMock.adcIsr = isr;
+}
+
+void nvicEnableIrq(int, bool enable) {
+	teensyMock.adcIrqEnabled = enable;
+}
+
+void delay(uint32_t) {
+}
+
+void yield() {
+}
+
+// the pwm.c functions My_ADC declares itself
+extern "C" {
+	void xbar_connect(unsigned int input, unsigned int output) {
+		teensyMock.xbarInput = input;
+		teensyMock.xbarOutput = output;
+	}
+
+	void quadtimerWrite(IMXRT_TMR_t*, unsigned int, uint16_t val) {
+		teensyMock.timerValue = val;
+	}
+
+	void quadtimerFrequency(IMXRT_TMR_t*, unsigned int, float frequency) {
+		teensyMock.timerFrequency = frequency;
+	}
+}
+
+//////////// DMAChannel ////////////////
+
+DMAChannel* DMAChannel::last_begun = nullptr;
+
+DMAChannel::DMAChannel() : channel(0), source_address(nullptr), buffer(nullptr), destination(nullptr), length(0),
+	at_half(false), at_completion(false), enabled(false), interrupt_pending(false), trigger(0), interrupt_isr(nullptr) {
+}
+
+void DMAChannel::begin(bool) {
+	*this = DMAChannel();
+	last_begun = this;
+}
+
+void DMAChannel::source(volatile const uint16_t& p) {
+	source_address = &p;
+}
+
+void DMAChannel::destinationBuffer(volatile uint16_t p[], unsigned int len) {
+	buffer = p;
+	destination = p;
+	length = len / sizeof(uint16_t);
+}
+
+bool DMAChannel::request() {
+	if (!enabled || source_address == nullptr || buffer == nullptr) {
+		return false;
+	}
+	*destination++ = *source_address;
+	const unsigned int written = (unsigned int)(destination - buffer);
+	if (written == length) {
+		destination = buffer;
+	}
+	if ((at_half && written == length / 2) || (at_completion && written == length)) {
+		interrupt_pending = true;
+	}
+	return true;
+}
+
+bool DMAChannel::interrupt() {
+	if (!interrupt_pending || interrupt_isr == nullptr) {
+		return false;
+	}
+	interrupt_isr();
+	return true;
+}
@@ -0,0 +1,31 @@
+/*
+ Name:		atomic.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Host stand-in for the bit access of the ADC library, plain read-modify-write of the register.
+*/
+#ifndef atomic_H
+#define atomic_H
+
+#include <stdint.h>
+
+namespace atomic {
+	inline void setBitFlag(volatile uint32_t& reg, uint32_t flag) {
+		reg |= flag;
+	}
+
+	inline void clearBitFlag(volatile uint32_t& reg, uint32_t flag) {
+		reg &= ~flag;
+	}
+
+	inline void changeBitFlag(volatile uint32_t& reg, uint32_t flag, uint32_t state) {
+		reg = (reg & ~flag) | (state & flag);
+	}
+
+	inline bool getBitFlag(volatile uint32_t& reg, uint32_t flag) {
+		return (reg & flag) != 0;
+	}
+}
+
+#endif // atomic_H
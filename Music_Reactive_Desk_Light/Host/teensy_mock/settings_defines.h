@@ -0,0 +1,83 @@
+/*
+ Name:		settings_defines.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Host stand-in for the settings of the ADC library, the Teensy 4.0 part of it.
+*/
+#ifndef settings_defines_H
+#define settings_defines_H
+
+#include "Arduino.h"
+
+#define ADC_TEENSY_4
+#define ADC_USE_DMA
+#define ADC_USE_QUAD_TIMER
+#define ADC_DIFF_PAIRS 0
+#define ADC_MAX_PIN 27
+
+#define ADC_SC1A_PIN_INVALID 0x1F
+#define ADC_SC1A_PIN_DIFF 0x40
+#define ADC_SC1A_PIN_PGA 0x80
+#define ADC_SC1A_CHANNELS 0x1F
+
+#define ADC_ERROR_VALUE -1
+#define ADC_ERROR_DIFF_VALUE -70000
+
+#define ADC_F_BUS F_BUS_ACTUAL
+
+namespace ADC_settings {
+	//! Reference of the ADC, internal or default
+	enum class ADC_REF_SOURCE : uint8_t { REF_DEFAULT = 0, REF_ALT = 1, REF_NONE = 2 };
+
+	//! Voltage reference
+	enum class ADC_REFERENCE : uint8_t {
+		REF_3V3 = static_cast<uint8_t>(ADC_REF_SOURCE::REF_DEFAULT),
+		NONE = static_cast<uint8_t>(ADC_REF_SOURCE::REF_NONE)
+	};
+
+	//! ADC clock
+	enum class ADC_CONVERSION_SPEED : uint8_t {
+		VERY_LOW_SPEED, LOW_SPEED, MED_SPEED, HIGH_SPEED, VERY_HIGH_SPEED, ADACK_10, ADACK_20
+	};
+
+	//! Sampling time
+	enum class ADC_SAMPLING_SPEED : uint8_t {
+		VERY_LOW_SPEED, LOW_SPEED, LOW_MED_SPEED, MED_SPEED, MED_HIGH_SPEED, HIGH_SPEED, HIGH_VERY_HIGH_SPEED, VERY_HIGH_SPEED
+	};
+
+	//! Internal sources of the ADC
+	enum class ADC_INTERNAL_SOURCE : uint8_t { VREFSH = 25, TEMP_SENSOR = 26 };
+
+	// clock divisors of the bus clock for the conversion speeds, ADICLK and ADIV bits of CFG
+	constexpr uint32_t get_CFG_LOW_SPEED(uint32_t) { return ADC_CFG_ADICLK(1) | ADC_CFG_ADIV(3); }
+	constexpr uint32_t get_CFG_MEDIUM_SPEED(uint32_t) { return ADC_CFG_ADICLK(1) | ADC_CFG_ADIV(1); }
+	constexpr uint32_t get_CFG_HIGH_SPEED(uint32_t) { return ADC_CFG_ADICLK(1) | ADC_CFG_ADIV(0); }
+}
+
+namespace ADC_Error {
+	//! Errors of the ADC, flags
+	enum class ADC_ERROR : uint16_t {
+		OTHER = 1 << 0,
+		CALIB = 1 << 1,
+		WRONG_PIN = 1 << 2,
+		ANALOG_READ = 1 << 3,
+		COMPARISON = 1 << 4,
+		ANALOG_DIFF_READ = 1 << 5,
+		CONT = 1 << 6,
+		CONT_DIFF = 1 << 7,
+		WRONG_ADC = 1 << 8,
+		SYNCH = 1 << 9,
+		CLEAR = 0
+	};
+
+	inline void operator|=(volatile ADC_ERROR& lhs, ADC_ERROR rhs) {
+		lhs = static_cast<ADC_ERROR>(static_cast<uint16_t>(lhs) | static_cast<uint16_t>(rhs));
+	}
+
+	inline void resetError(volatile ADC_ERROR& fail_flag) {
+		fail_flag = ADC_ERROR::CLEAR;
+	}
+}
+
+#endif // settings_defines_H
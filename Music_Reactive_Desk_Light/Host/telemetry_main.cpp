@@ -0,0 +1,103 @@
+/*
+ Name:		telemetry_main.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Decoder of the binary telemetry of the desk light (see Telemetry_Protocol.h).
+
+ Usage: desk_light_telemetry <capture | serial device | -> [--json] [--type <list>] [--output <file>]
+   input       a capture of the serial stream, the serial device itself (set it to raw mode first,
+               e.g. stty -F /dev/ttyACM0 raw) or - for stdin
+   --json      one JSON object per line instead of CSV
+   --type      only these message types, comma separated: bands, leds, spectrum, profile, counters, params
+   --output    write the lines to a file instead of stdout
+ Frames, crc errors and lost frames are reported on stderr at the end of the input.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include "Telemetry_Decoder.h"
+
+static void usage() {
+	fprintf(stderr, "usage: desk_light_telemetry <capture | device | -> [--json] [--type <list>] [--output <file>]\n");
+}
+
+int main(int argc, char** argv) {
+	const char* inputPath = nullptr;
+	const char* outputPath = nullptr;
+	bool json = false;
+	std::string types; // ",bands,leds," for a filter, empty for all types
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--json") == 0) {
+			json = true;
+		}
+		else if (strcmp(argv[i], "--type") == 0 && i + 1 < argc) {
+			types = std::string(",") + argv[++i] + ",";
+		}
+		else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			outputPath = argv[++i];
+		}
+		else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+			usage();
+			return 2;
+		}
+		else if (inputPath == nullptr) {
+			inputPath = argv[i];
+		}
+		else {
+			usage();
+			return 2;
+		}
+	}
+	if (inputPath == nullptr) {
+		usage();
+		return 2;
+	}
+
+	FILE* input = strcmp(inputPath, "-") == 0 ? stdin : fopen(inputPath, "rb");
+	if (input == nullptr) {
+		fprintf(stderr, "can't read %s\n", inputPath);
+		return 1;
+	}
+	FILE* output = outputPath != nullptr ? fopen(outputPath, "w") : stdout;
+	if (output == nullptr) {
+		fprintf(stderr, "can't create %s\n", outputPath);
+		return 1;
+	}
+
+	Telemetry_Decoder decoder;
+	uint32_t unknown = 0;
+	std::string line;
+	uint8_t buffer[4096];
+	ssize_t count;
+	while ((count = read(fileno(input), buffer, sizeof(buffer))) > 0) { // returns what a serial device has, fread would wait for a full buffer
+		for (ssize_t i = 0; i < count; i++) {
+			if (!decoder.push(buffer[i])) {
+				continue;
+			}
+			const Telemetry_Message& message = decoder.message();
+			if (!types.empty() && types.find(std::string(",") + telemetryTypeName(message.type) + ",") == std::string::npos) {
+				continue;
+			}
+			if (!(json ? telemetryJson(message, line) : telemetryCsv(message, line))) {
+				unknown++;
+				continue;
+			}
+			fputs(line.c_str(), output);
+			fputc('\n', output);
+		}
+		fflush(output);
+	}
+
+	fprintf(stderr, "frames %u, crc errors %u, lost %u, unknown %u\n", decoder.frames(), decoder.errors(), decoder.lost(), unknown);
+	if (input != stdin) {
+		fclose(input);
+	}
+	if (output != stdout) {
+		fclose(output);
+	}
+	return 0;
+}
@@ -0,0 +1,55 @@
+/*
+ Name:		Test_Check.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Checks of the host tests. A failed check prints where it failed and what was compared, the test
+ carries on and exits with testResult(), so ctest sees every failure of a run at once.
+*/
+#ifndef Test_Check_H
+#define Test_Check_H
+
+#include <stdio.h>
+
+//! Number of failed checks of the test
+inline int& testFailures() {
+	static int failures = 0;
+	return failures;
+}
+
+//! Record a check
+/** \return passed, for tests that skip what depends on it.
+*/
+inline bool testCheck(bool passed, const char* expression, const char* file, int line) {
+	if (!passed) {
+		fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+		testFailures()++;
+	}
+	return passed;
+}
+
+//! Record a comparison, printing both values if they differ
+template <class A, class B>
+inline bool testEqual(const A& actual, const B& expected, const char* expression, const char* file, int line) {
+	const bool passed = actual == expected;
+	if (!passed) {
+		fprintf(stderr, "%s:%d: check failed: %s, %lld != %lld\n", file, line, expression, (long long)actual, (long long)expected);
+		testFailures()++;
+	}
+	return passed;
+}
+
+#define CHECK(condition) testCheck((condition), #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected) testEqual((actual), (expected), #actual " == " #expected, __FILE__, __LINE__)
+
+//! Summary line and exit code of a test
+inline int testResult(const char* name) {
+	if (testFailures() == 0) {
+		printf("%s: passed\n", name);
+		return 0;
+	}
+	printf("%s: %d checks failed\n", name, testFailures());
+	return 1;
+}
+
+#endif // Test_Check_H
@@ -0,0 +1,115 @@
+/*
+ Name:		Test_Signals.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Synthetic input of the host tests: tones in ADC units and a Sample_Source playing them,
+ so a test knows exactly which frequencies the pipeline gets, and WAV files of them for the file readers.
+*/
+#ifndef Test_Signals_H
+#define Test_Signals_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include "Sample_Source.h"
+
+//! Sine tone in ADC units, rounded
+/** \param frequency Hz.
+*   \param amplitude peak in ADC counts, at most 2047 for the 12 bit ADC.
+*   \param sampleRate samples per second.
+*   \param count number of samples.
+*/
+inline std::vector<q15_t> testTone(double frequency, double amplitude, uint32_t sampleRate, uint32_t count) {
+	std::vector<q15_t> samples(count);
+	for (uint32_t i = 0; i < count; i++) {
+		samples[i] = (q15_t)lrint(amplitude * sin(2 * M_PI * frequency * i / sampleRate));
+	}
+	return samples;
+}
+
+/** Class Tone_Source: plays a block of samples once, as fast as they are read
+*/
+class Tone_Source : public Sample_Source {
+
+public:
+
+	Tone_Source(const std::vector<q15_t>& samples, uint32_t rate) : data(samples), rate(rate), position(0) {
+	}
+
+	uint32_t read(q15_t* output, uint32_t count) override {
+		uint32_t taken = 0;
+		while (taken < count && position < data.size()) {
+			output[taken++] = data[position++];
+		}
+		return taken;
+	}
+
+	uint32_t sampleRate() const override { return rate; }
+
+	bool finished() const override { return position >= data.size(); }
+
+private:
+	std::vector<q15_t> data;
+	uint32_t rate;
+	size_t position;
+};
+
+//! Little endian bytes of a value
+inline void appendLittleEndian(std::vector<uint8_t>& bytes, uint32_t value, uint8_t size) {
+	for (uint8_t i = 0; i < size; i++) {
+		bytes.push_back((uint8_t)(value >> (8 * i)));
+	}
+}
+
+//! 16 bit PCM WAV file
+/** \param samples interleaved frames.
+*   \param channels samples per frame.
+*   \param rate frames per second.
+*   \param extraChunk a whole chunk (id, size, body and padding) placed between the fmt and the data chunk, or empty.
+*/
+inline std::vector<uint8_t> testWav(const std::vector<int16_t>& samples, uint16_t channels, uint32_t rate,
+	const std::vector<uint8_t>& extraChunk = std::vector<uint8_t>()) {
+	const uint32_t dataBytes = (uint32_t)(samples.size() * sizeof(int16_t));
+	std::vector<uint8_t> bytes = { 'R', 'I', 'F', 'F' };
+	appendLittleEndian(bytes, 4 + 24 + (uint32_t)extraChunk.size() + 8 + dataBytes, 4);
+	bytes.insert(bytes.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+	appendLittleEndian(bytes, 16, 4);
+	appendLittleEndian(bytes, 1, 2); // PCM
+	appendLittleEndian(bytes, channels, 2);
+	appendLittleEndian(bytes, rate, 4);
+	appendLittleEndian(bytes, rate * channels * 2, 4); // bytes per second
+	appendLittleEndian(bytes, channels * 2, 2); // bytes per frame
+	appendLittleEndian(bytes, 16, 2);
+	bytes.insert(bytes.end(), extraChunk.begin(), extraChunk.end());
+	bytes.insert(bytes.end(), { 'd', 'a', 't', 'a' });
+	appendLittleEndian(bytes, dataBytes, 4);
+	for (int16_t sample : samples) {
+		appendLittleEndian(bytes, (uint16_t)sample, 2);
+	}
+	return bytes;
+}
+
+//! Directory for the files of a test, in the working directory of the test (the build directory under ctest)
+inline std::string testDirectory(const char* name) {
+	const std::string path = std::string(name) + ".files";
+	mkdir(path.c_str(), 0755); // may exist from an earlier run
+	return path;
+}
+
+//! Write a file of the test
+/** \return false if it can't be written.
+*/
+inline bool writeTestFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+	FILE* file = fopen(path.c_str(), "wb");
+	if (file == nullptr) {
+		return false;
+	}
+	const bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	return fclose(file) == 0 && written;
+}
+
+#endif // Test_Signals_H
@@ -0,0 +1,254 @@
+/*
+ Name:		test_adc_stream.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The DMA stream of My_ADC on mocked registers. The test plays the ADC and the DMA: it sets R0,
+ makes the DMA request and lets the interrupt run when it likes, then checks the registers startStream() and
+ stopStream() leave behind, the blocks passed to the callback and the overruns counted when the interrupt
+ comes too late.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "My_ADC.h"
+#include "Test_Check.h"
+
+#define STREAM_PIN 0		// A0, channel 7 of ADC0
+#define STREAM_CHANNEL 7
+#define STREAM_RATE 40000
+#define STREAM_BLOCK 16
+
+//! What the callback saw
+struct Block_Log {
+	uint32_t calls;
+	volatile uint16_t* block;
+	uint16_t blockSize;
+	uint16_t first; // first and last sample of the block
+	uint16_t last;
+};
+
+static Block_Log blockLog;
+
+static void logBlock(volatile uint16_t* block, uint16_t blockSize) {
+	blockLog.calls++;
+	blockLog.block = block;
+	blockLog.blockSize = blockSize;
+	blockLog.first = block[0];
+	blockLog.last = block[blockSize - 1];
+}
+
+//! One conversion of the ADC moved by the DMA
+static void convert(My_ADC::ADC_REGS_t& regs, uint16_t value) {
+	regs.R0 = value;
+	DMAChannel::last()->request();
+}
+
+/* Registers and DMA set up by startStream()
+*
+*/
+static void testStart() {
+	resetTeensyMock();
+	My_ADC::ADC_REGS_t regs = {};
+	IMXRT_ADC_ETC_t etc = {};
+	uint16_t buffers[2 * STREAM_BLOCK];
+	My_ADC adc(0, regs, etc);
+
+	regs.HC0 = ADC_HC_AIEN; // interrupt per conversion, like the sketch before the stream
+	CHECK(adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, logBlock));
+	CHECK(adc.isStreaming());
+
+	// one DMA request per conversion instead of an interrupt, triggered by the timer through the ADC_ETC
+	CHECK(regs.GC & ADC_GC_DMAEN);
+	CHECK(!(regs.GC & ADC_GC_ADCO));
+	CHECK(!(regs.HC0 & ADC_HC_AIEN));
+	CHECK(!teensyMock.adcIrqEnabled);
+	CHECK(regs.CFG & ADC_CFG_ADTRG);
+	CHECK_EQUAL(regs.HC0 & 0x1f, 16u);
+	CHECK(etc.DMA_CTRL & ADC_ETC_DMA_CTRL_TRIQ_ENABLE(0));
+	CHECK(etc.CTRL & ADC_ETC_CTRL_TRIG_ENABLE(1));
+	CHECK_EQUAL(etc.TRIG[0].CHAIN_1_0 & 0xf, (uint32_t)STREAM_CHANNEL);
+	CHECK_EQUAL(teensyMock.xbarInput, (uint32_t)XBARA1_IN_QTIMER4_TIMER0);
+	CHECK_EQUAL(teensyMock.xbarOutput, (uint32_t)XBARA1_OUT_ADC_ETC_TRIG00);
+	CHECK_EQUAL(teensyMock.timerFrequency, STREAM_RATE);
+	CHECK(teensyMock.timerValue != 0);
+
+	// the registers of the object, not the global ones
+	CHECK_EQUAL(IMXRT_ADC_ETC.DMA_CTRL, 0u);
+	CHECK_EQUAL(IMXRT_ADC_ETC.CTRL, 0u);
+
+	DMAChannel& dma = *DMAChannel::last();
+	CHECK(dma.isEnabled());
+	CHECK(dma.hasInterrupt());
+	CHECK(dma.sourceAddress() == (volatile const uint16_t*)&regs.R0);
+	CHECK_EQUAL(dma.triggerSource(), DMAMUX_SOURCE_ADC1);
+
+	adc.stopStream();
+}
+
+/* stopStream() undoes startStream()
+*   Afterwards the ADC is back to software triggers and neither the ADC nor its ADC_ETC trigger request DMA,
+*   so a conversion started by the next user doesn't end up in the old buffers.
+*/
+static void testStop() {
+	resetTeensyMock();
+	My_ADC::ADC_REGS_t regs = {};
+	IMXRT_ADC_ETC_t etc = {};
+	uint16_t buffers[2 * STREAM_BLOCK];
+	My_ADC adc(0, regs, etc);
+
+	CHECK(adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, logBlock));
+	adc.stopStream();
+	CHECK(!adc.isStreaming());
+	CHECK(!(regs.GC & ADC_GC_DMAEN));
+	CHECK(!(regs.CFG & ADC_CFG_ADTRG));
+	CHECK(!(etc.DMA_CTRL & ADC_ETC_DMA_CTRL_TRIQ_ENABLE(0)));
+	CHECK_EQUAL(teensyMock.timerValue, 0u);
+
+	DMAChannel& dma = *DMAChannel::last();
+	CHECK(!dma.isEnabled());
+	CHECK(!dma.hasInterrupt());
+	CHECK(!dma.request());
+
+	// ADC1 uses trigger 4, stopping it leaves the trigger of ADC0 alone
+	My_ADC::ADC_REGS_t regs1 = {};
+	My_ADC adc1(1, regs1, etc);
+	CHECK(adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, logBlock));
+	uint16_t buffers1[2 * STREAM_BLOCK];
+	CHECK(adc1.startStream(STREAM_PIN + 12, STREAM_RATE, buffers1, STREAM_BLOCK, logBlock)); // A12, channel 3 of ADC1
+	CHECK(etc.DMA_CTRL & ADC_ETC_DMA_CTRL_TRIQ_ENABLE(4));
+	adc1.stopStream();
+	CHECK(!(etc.DMA_CTRL & ADC_ETC_DMA_CTRL_TRIQ_ENABLE(4)));
+	CHECK(etc.DMA_CTRL & ADC_ETC_DMA_CTRL_TRIQ_ENABLE(0));
+	adc.stopStream();
+	CHECK_EQUAL(etc.DMA_CTRL, 0u);
+
+	// stopping twice is harmless
+	adc.stopStream();
+	CHECK(!adc.isStreaming());
+}
+
+/* Invalid arguments don't start anything
+*
+*/
+static void testInvalid() {
+	resetTeensyMock();
+	My_ADC::ADC_REGS_t regs = {};
+	IMXRT_ADC_ETC_t etc = {};
+	uint16_t buffers[2 * STREAM_BLOCK];
+	My_ADC adc(0, regs, etc);
+
+	CHECK(!adc.startStream(12, STREAM_RATE, buffers, STREAM_BLOCK, logBlock)); // A12 isn't on ADC0
+	CHECK(!adc.startStream(STREAM_PIN, STREAM_RATE, nullptr, STREAM_BLOCK, logBlock));
+	CHECK(!adc.startStream(STREAM_PIN, STREAM_RATE, buffers, 0, logBlock));
+	CHECK(!adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, nullptr));
+	CHECK(!adc.isStreaming());
+	CHECK(!(regs.GC & ADC_GC_DMAEN));
+	CHECK_EQUAL(etc.DMA_CTRL, 0u);
+	CHECK_EQUAL(teensyMock.timerValue, 0u);
+}
+
+/* Blocks complete alternately, one callback per block with its samples
+*   The interrupt runs somewhere in the next block, as it would after some latency.
+*/
+static void testBlocks() {
+	resetTeensyMock();
+	My_ADC::ADC_REGS_t regs = {};
+	IMXRT_ADC_ETC_t etc = {};
+	uint16_t buffers[2 * STREAM_BLOCK];
+	My_ADC adc(0, regs, etc);
+	blockLog = Block_Log();
+
+	CHECK(adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, logBlock));
+	DMAChannel& dma = *DMAChannel::last();
+	uint16_t sample = 0;
+	for (uint32_t block = 0; block < 8; block++) {
+		while (sample < (block + 1) * STREAM_BLOCK + STREAM_BLOCK / 2) {
+			convert(regs, sample++);
+		}
+		CHECK_EQUAL(blockLog.calls, block); // nothing before the interrupt runs
+		CHECK(dma.interrupt());
+		CHECK(!dma.interrupt()); // cleared by the handler
+
+		CHECK_EQUAL(blockLog.calls, block + 1);
+		CHECK(blockLog.block == buffers + (block & 1) * STREAM_BLOCK);
+		CHECK_EQUAL(blockLog.blockSize, STREAM_BLOCK);
+		CHECK_EQUAL(blockLog.first, block * STREAM_BLOCK);
+		CHECK_EQUAL(blockLog.last, block * STREAM_BLOCK + STREAM_BLOCK - 1);
+		CHECK_EQUAL(adc.getStreamBlocks(), block + 1);
+		CHECK_EQUAL(adc.getStreamOverruns(), 0u);
+	}
+	adc.stopStream();
+}
+
+/* An interrupt later than a whole block finds the DMA past the next block
+*   The block in between was overwritten, that is an overrun; the stream then carries on with the newest
+*   block and no overrun once the interrupt is on time again. Only an odd number of lost blocks can be seen
+*   from the position of the DMA, so the test is late by one block at a time.
+*/
+static void testOverrun() {
+	resetTeensyMock();
+	My_ADC::ADC_REGS_t regs = {};
+	IMXRT_ADC_ETC_t etc = {};
+	uint16_t buffers[2 * STREAM_BLOCK];
+	My_ADC adc(0, regs, etc);
+	blockLog = Block_Log();
+
+	CHECK(adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, logBlock));
+	DMAChannel& dma = *DMAChannel::last();
+	uint16_t sample = 0;
+
+	// blocks 0 and 1 complete before the interrupt runs: one pending interrupt, block 1 reported, block 0 lost
+	for (uint32_t i = 0; i < 2 * STREAM_BLOCK; i++) {
+		convert(regs, sample++);
+	}
+	CHECK(dma.interrupt());
+	CHECK_EQUAL(blockLog.calls, 1u);
+	CHECK(blockLog.block == buffers + STREAM_BLOCK);
+	CHECK_EQUAL(blockLog.first, STREAM_BLOCK);
+	CHECK_EQUAL(adc.getStreamOverruns(), 1u);
+
+	// on time again: block 0, then block 1, no more overruns
+	for (uint32_t block = 2; block < 6; block++) {
+		for (uint32_t i = 0; i < STREAM_BLOCK; i++) {
+			convert(regs, sample++);
+		}
+		CHECK(dma.interrupt());
+		CHECK(blockLog.block == buffers + (block & 1) * STREAM_BLOCK);
+		CHECK_EQUAL(blockLog.first, block * STREAM_BLOCK);
+	}
+	CHECK_EQUAL(adc.getStreamBlocks(), 5u);
+	CHECK_EQUAL(adc.getStreamOverruns(), 1u);
+
+	// late again: blocks 6 and 7 both complete, block 7 reported and block 6 lost
+	for (uint32_t i = 0; i < 2 * STREAM_BLOCK; i++) {
+		convert(regs, sample++);
+	}
+	CHECK(dma.interrupt());
+	CHECK(blockLog.block == buffers + STREAM_BLOCK);
+	CHECK_EQUAL(blockLog.first, 7 * STREAM_BLOCK);
+	CHECK_EQUAL(adc.getStreamBlocks(), 6u);
+	CHECK_EQUAL(adc.getStreamOverruns(), 2u);
+
+	// restarting clears the counters and starts with block 0 again
+	CHECK(adc.startStream(STREAM_PIN, STREAM_RATE, buffers, STREAM_BLOCK, logBlock));
+	CHECK_EQUAL(adc.getStreamBlocks(), 0u);
+	CHECK_EQUAL(adc.getStreamOverruns(), 0u);
+	DMAChannel& restarted = *DMAChannel::last();
+	for (uint32_t i = 0; i < STREAM_BLOCK; i++) {
+		convert(regs, sample++);
+	}
+	CHECK(restarted.interrupt());
+	CHECK(blockLog.block == buffers);
+	CHECK_EQUAL(adc.getStreamOverruns(), 0u);
+	adc.stopStream();
+}
+
+int main() {
+	testStart();
+	testStop();
+	testInvalid();
+	testBlocks();
+	testOverrun();
+	return testResult("adc_stream");
+}
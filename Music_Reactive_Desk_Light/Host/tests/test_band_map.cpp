@@ -0,0 +1,137 @@
+/*
+ Name:		test_band_map.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Band_Map against tones. Tones at, just below and just above every band edge go through the
+ window and the FFT, the band of the strongest bin has to be the band the edges put that frequency in:
+ band i holds what is below upperEdges[i] and not in a lower band.
+*/
+
+#include <math.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Band_Map.h"
+#include "Fft_Engine.h"
+#include "Fft_Window.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+//! Band of the map holding the bin, numBands() for the DC bin and the bins above the last edge
+static uint8_t bandOfBin(const Band_Map& map, uint32_t bin) {
+	for (uint8_t i = 0; i < map.numBands(); i++) {
+		if (bin >= map.band(i).firstBin && bin < map.band(i).endBin) {
+			return i;
+		}
+	}
+	return map.numBands();
+}
+
+//! Band by the definition: the first edge above the frequency, compared exactly as bin * rate / size
+static uint8_t bandOfFrequency(uint32_t sampleRate, uint32_t fftSize, const uint32_t* edges, uint8_t numBands, uint32_t bin) {
+	if (bin == 0) {
+		return numBands;
+	}
+	for (uint8_t i = 0; i < numBands; i++) {
+		if ((uint64_t)bin * sampleRate * 10 < (uint64_t)edges[i] * fftSize) {
+			return i;
+		}
+	}
+	return numBands;
+}
+
+//! Strongest bin of a Hann windowed tone, bins 1 up to Nyquist
+static uint32_t peakBin(Fft_Engine& engine, const Fft_Window& window, double frequency, uint32_t sampleRate, uint32_t fftSize) {
+	std::vector<q15_t> samples = testTone(frequency, 1000, sampleRate, fftSize);
+	std::vector<q15_t> spectrum(2 * fftSize);
+	window.apply(samples.data(), samples.data(), 0, fftSize, 0);
+	engine.rfft(samples.data(), spectrum.data(), fftSize);
+	uint32_t peak = 1;
+	int64_t peakPower = -1;
+	for (uint32_t k = 1; k <= fftSize / 2; k++) {
+		const int64_t re = spectrum[2 * k];
+		const int64_t im = spectrum[2 * k + 1];
+		if (re * re + im * im > peakPower) {
+			peakPower = re * re + im * im;
+			peak = k;
+		}
+	}
+	return peak;
+}
+
+/* Tones around every edge of a map
+*   A bin below and above the edge the band is fixed; at the edge and a fraction of a bin around it the tone lands
+*   in the nearest bin, its band then follows from where the centre of that bin is. Edges are kept a few bins
+*   above DC, closer the window's main lobe merges with its mirror image.
+*/
+static void checkEdges(uint32_t sampleRate, uint32_t fftSize, const uint32_t* edges, uint8_t numBands) {
+	Band_Map map;
+	CHECK(map.configure(sampleRate, fftSize, edges, numBands));
+	Fft_Engine engine;
+	Fft_Window window;
+	CHECK(window.begin(fftSize, WINDOW_TYPE::HANN));
+	window.setGain(1);
+
+	// adjacent ranges from bin 1, DC in no band
+	CHECK_EQUAL(map.band(0).firstBin, 1);
+	for (uint8_t i = 1; i < numBands; i++) {
+		CHECK_EQUAL(map.band(i).firstBin, map.band(i - 1).endBin);
+	}
+	CHECK_EQUAL(bandOfBin(map, 0), numBands);
+
+	const double binHz = (double)sampleRate / fftSize;
+	const double offsets[] = { -1.0, -0.3, -0.1, 0.0, 0.1, 0.3, 1.0 }; // in bins
+	for (uint8_t i = 0; i < numBands; i++) {
+		const double edgeHz = edges[i] / 10.0;
+		for (double offset : offsets) {
+			const double frequency = edgeHz + offset * binHz;
+			const uint32_t peak = peakBin(engine, window, frequency, sampleRate, fftSize);
+			const double position = frequency / binHz;
+			if (fabs(position - floor(position) - 0.5) > 0.15) {
+				CHECK_EQUAL(peak, (uint32_t)lround(position)); // the tone is where the FFT puts it
+			}
+			const uint8_t band = bandOfBin(map, peak);
+			if (!CHECK_EQUAL(band, bandOfFrequency(sampleRate, fftSize, edges, numBands, peak))) {
+				fprintf(stderr, "  %.2f Hz, bin %u, edge %u of %.1f Hz\n", frequency, peak, i, edgeHz);
+			}
+			if (offset <= -1.0) {
+				CHECK(band <= i); // a bin below the edge is in the band, or a lower one if the band is empty
+			}
+			if (offset >= 1.0) {
+				CHECK(band > i); // a bin above is in a higher band, or above all of them
+			}
+		}
+	}
+}
+
+int main() {
+	// the sketch: 40 kHz, 8192 points, bass / mid / treble
+	uint32_t sketchEdges[Config::numBands];
+	for (uint8_t i = 0; i < Config::numBands; i++) {
+		sketchEdges[i] = Config::bandUpper(i);
+	}
+	checkEdges(Config::sampleRate, Config::fftSize, sketchEdges, Config::numBands);
+
+	// the compile time ranges of the sketch are the same as the map's
+	Band_Map map;
+	CHECK(map.configure(Config::sampleRate, Config::fftSize, sketchEdges, Config::numBands));
+	for (uint8_t i = 0; i < Config::numBands; i++) {
+		CHECK_EQUAL(Config::band(i).firstBin, map.band(i).firstBin);
+		CHECK_EQUAL(Config::band(i).endBin, map.band(i).endBin);
+	}
+
+	// a bin width that isn't a whole number of Hz, edges between bin centres
+	const uint32_t cdEdges[] = { 1000, 6000, 25000, 80000 };
+	checkEdges(44100, 1024, cdEdges, 4);
+
+	// bands of a bin or less: a tone is in the band whose range has its bin, empty bands get none
+	const uint32_t narrowEdges[] = { 1000, 1100, 1150, 4000 };
+	checkEdges(8000, 256, narrowEdges, 4);
+
+	// invalid edges leave the map alone
+	const uint32_t descending[] = { 5000, 2500 };
+	CHECK(!map.configure(40000, 8192, descending, 2));
+	CHECK_EQUAL(map.numBands(), Config::numBands);
+
+	return testResult("band_map");
+}
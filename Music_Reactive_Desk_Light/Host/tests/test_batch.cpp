@@ -0,0 +1,151 @@
+/*
+ Name:		test_batch.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Batch_Analyzer and Work_Stealing_Pool on generated files. The pool has to run every task exactly
+ once whatever the number of threads. The batch has to write one result per file, two files of the same name
+ included, and the .dlb and .csv files of one thread reading every file whole have to be byte-identical to
+ those of several threads working on short windows.
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Batch_Analyzer.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define BATCH_THREADS 4
+#define BATCH_TASKS 1000
+
+/* Every task once, with tasks of very different lengths so idle workers steal
+*
+*/
+static void testPool(unsigned threads) {
+	Work_Stealing_Pool pool(threads);
+	std::unique_ptr<std::atomic<uint32_t>[]> runs(new std::atomic<uint32_t>[BATCH_TASKS]);
+	for (uint32_t t = 0; t < BATCH_TASKS; t++) {
+		runs[t] = 0;
+	}
+	std::atomic<uint32_t> badWorker(0);
+	pool.run(BATCH_TASKS, [&](unsigned worker, size_t task) {
+		badWorker += worker >= threads;
+		runs[task]++;
+		if (task < BATCH_TASKS / 8) {
+			std::this_thread::sleep_for(std::chrono::microseconds(200)); // the first worker's block is slow
+		}
+	});
+	uint32_t wrong = 0;
+	for (uint32_t t = 0; t < BATCH_TASKS; t++) {
+		wrong += runs[t] != 1;
+	}
+	printf("%u threads: %u tasks run other than once, %llu steals\n", threads, wrong, (unsigned long long)pool.steals());
+	CHECK_EQUAL(wrong, 0u);
+	CHECK_EQUAL(badWorker.load(), 0u);
+}
+
+//! A tone gliding from low to high over noise, so every band and many led frames differ
+static std::vector<int16_t> glide(uint32_t rate, double seconds, uint32_t seed) {
+	std::mt19937 random(seed);
+	std::normal_distribution<double> noise(0, 300);
+	std::vector<int16_t> samples((size_t)(rate * seconds));
+	double phase = 0;
+	for (size_t i = 0; i < samples.size(); i++) {
+		const double frequency = 60 * pow(200.0, (double)i / samples.size()); // 60 Hz to 12 kHz
+		phase += 2 * M_PI * frequency / rate;
+		samples[i] = (int16_t)lrint(12000 * sin(phase) + noise(random));
+	}
+	return samples;
+}
+
+//! Whole content of a file, empty if it can't be read
+static std::vector<uint8_t> readFile(const std::string& path) {
+	std::vector<uint8_t> bytes;
+	FILE* file = fopen(path.c_str(), "rb");
+	if (file == nullptr) {
+		return bytes;
+	}
+	uint8_t block[4096];
+	size_t count;
+	while ((count = fread(block, 1, sizeof(block), file)) > 0) {
+		bytes.insert(bytes.end(), block, block + count);
+	}
+	fclose(file);
+	return bytes;
+}
+
+/* Analyse the files and write the results to a directory
+*   \return frames of all files, 0 if something failed.
+*/
+static uint64_t runBatch(const std::vector<std::string>& paths, unsigned threads, double windowSeconds, const std::string& output) {
+	Batch_Analyzer batch;
+	CHECK(batch.begin(ANALYSIS_ENGINE::FFT, false, 0, windowSeconds));
+	for (const std::string& path : paths) {
+		CHECK(batch.add(path.c_str()));
+	}
+	CHECK_EQUAL(batch.files(), paths.size());
+	Work_Stealing_Pool pool(threads);
+	double seconds = 0;
+	const bool ran = CHECK(batch.run(pool, seconds));
+	mkdir(output.c_str(), 0755);
+	const bool written = CHECK(batch.write(output.c_str()));
+	printf("%u threads, %.2f s windows: %u windows, %llu frames\n", threads, windowSeconds, (unsigned)batch.windows(),
+		(unsigned long long)batch.frames());
+	return ran && written ? batch.frames() : 0;
+}
+
+int main() {
+	testPool(1);
+	testPool(BATCH_THREADS);
+
+	// a file at the capture rate, one resampled from 44.1 kHz, and two files named alike in different directories
+	const std::string directory = testDirectory("test_batch");
+	mkdir((directory + "/other").c_str(), 0755);
+	const std::vector<std::string> paths = { directory + "/glide.wav", directory + "/short.wav", directory + "/other/glide.wav" };
+	CHECK(writeTestFile(paths[0], testWav(glide(Config::sampleRate, 2.0, 1), 1, Config::sampleRate)));
+	CHECK(writeTestFile(paths[1], testWav(glide(44100, 0.6, 2), 1, 44100)));
+	CHECK(writeTestFile(paths[2], testWav(glide(Config::sampleRate, 1.3, 3), 1, Config::sampleRate)));
+
+	// whole files on one thread against windows of 0.1 s (4 frames) on several
+	const uint64_t whole = runBatch(paths, 1, 30, directory + "/whole");
+	const uint64_t windowed = runBatch(paths, BATCH_THREADS, 0.1, directory + "/windowed");
+	CHECK(whole > 0);
+	CHECK_EQUAL(windowed, whole);
+
+	const char* outputs[] = { "glide", "short", "glide_2" }; // the second glide gets the index of its file
+	const uint32_t seconds[] = { 2000, 600, 1300 }; // ms
+	const uint32_t rates[] = { Config::sampleRate, 44100, Config::sampleRate };
+	uint64_t frames = 0;
+	for (uint32_t f = 0; f < 3; f++) {
+		for (const char* extension : { ".dlb", ".csv" }) {
+			const std::vector<uint8_t> first = readFile(directory + "/whole/" + outputs[f] + extension);
+			const std::vector<uint8_t> second = readFile(directory + "/windowed/" + outputs[f] + extension);
+			if (!CHECK(!first.empty() && first == second)) {
+				fprintf(stderr, "  %s%s: %u and %u bytes\n", outputs[f], extension, (unsigned)first.size(), (unsigned)second.size());
+			}
+		}
+
+		// the header and the size: every frame of the file once
+		const std::vector<uint8_t> dlb = readFile(directory + "/whole/" + outputs[f] + ".dlb");
+		Batch_Header header = {};
+		if (CHECK(dlb.size() >= sizeof(header))) {
+			memcpy(&header, dlb.data(), sizeof(header));
+		}
+		const uint64_t samples = (uint64_t)seconds[f] * rates[f] / 1000;
+		const uint64_t captured = (samples * Config::sampleRate + rates[f] - 1) / rates[f]; // File_Source::length()
+		CHECK_EQUAL(header.magic, (uint32_t)BATCH_MAGIC);
+		CHECK_EQUAL(header.frames, (uint32_t)((captured - Config::fftSize) / Config::hopSize + 1));
+		CHECK_EQUAL(dlb.size(), sizeof(header) + (size_t)header.frames * (Config::numBands * sizeof(q31_t) + Config::numLeds * 3));
+		frames += header.frames;
+	}
+	CHECK_EQUAL(frames, whole);
+	return testResult("batch");
+}
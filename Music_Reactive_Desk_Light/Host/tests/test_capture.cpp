@@ -0,0 +1,107 @@
+/*
+ Name:		test_capture.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Capture through the sample ring against a main loop on Linux, as the sketch does it. The Isr_Driver
+ plays the DMA interrupt at 40 kHz and writes blocks of 256 samples into the ring, the test thread is the main loop
+ and reads a hop at a time. A loop that is done within a hop time must see every sample once and in order, a loop
+ that is too slow loses samples and every lost one has to be counted by the ring.
+*/
+
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include "Dsp_Types.h"
+#include "Spsc_Ring.h"
+#include "Isr_Driver.h"
+#include "Test_Check.h"
+
+#define CAPTURE_RATE 40000
+#define CAPTURE_BLOCK 256 // the ADC DMA block
+#define CAPTURE_HOP 1024 // 25.6 ms per hop
+#define CAPTURE_RING (4 * CAPTURE_HOP) // as the sketch's sampleRing
+
+//! What the main loop saw
+struct Capture_Run {
+	uint32_t hops; // hops read
+	uint64_t missing; // samples that never arrived, from the gaps in the ramp
+	uint32_t repeated; // samples that arrived out of order or twice
+	uint64_t read; // samples read, including those drained at the end
+	uint64_t sent; // samples raised by the driver
+	uint32_t written; // samples stored by the ring
+	uint32_t dropped; // samples dropped by the ring
+};
+
+/* Read hops for a while, each one followed by processMillis like an FFT would
+*   After the driver stops, what is left in the ring is read too, so every sent sample is either read or dropped.
+*/
+static Capture_Run runCapture(uint32_t processMillis, uint32_t hops) {
+	static Spsc_Ring<q15_t, CAPTURE_RING> ring;
+	ring.clear();
+	ring.resetCounters();
+	Isr_Driver driver;
+	driver.start(CAPTURE_RATE, CAPTURE_BLOCK, [&](const int16_t* samples, uint32_t count) { ring.write(samples, count); });
+
+	Capture_Run run = {};
+	uint64_t expected = 0; // next sample if none is lost
+	q15_t hop[CAPTURE_HOP];
+	bool draining = false;
+	while (true) {
+		if (!draining && run.hops >= hops) {
+			driver.stop();
+			draining = true;
+		}
+		uint32_t count = CAPTURE_HOP;
+		if (draining) {
+			count = ring.read(hop, CAPTURE_HOP);
+			if (count == 0) {
+				break;
+			}
+		}
+		else if (!ring.readBlock(hop, CAPTURE_HOP)) {
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+			continue;
+		}
+
+		for (uint32_t i = 0; i < count; i++) {
+			const uint16_t gap = (uint16_t)((uint16_t)hop[i] - (uint16_t)expected); // the ramp wraps at 2^16
+			if (gap >= 0x8000) {
+				run.repeated++; // behind the expected sample
+				continue;
+			}
+			run.missing += gap;
+			expected += gap + 1;
+		}
+		run.read += count;
+		if (!draining) {
+			run.hops++;
+			std::this_thread::sleep_for(std::chrono::milliseconds(processMillis));
+		}
+	}
+	run.sent = driver.samplesSent();
+	run.missing += run.sent - expected; // dropped after the last sample read
+	run.written = ring.itemsWritten();
+	run.dropped = ring.itemsDropped();
+	printf("process %u ms: %llu samples sent, %llu read, %u dropped, %llu missing, %u out of order, max fill %u\n", processMillis,
+		(unsigned long long)run.sent, (unsigned long long)run.read, run.dropped, (unsigned long long)run.missing, run.repeated, ring.maxFill());
+	return run;
+}
+
+int main() {
+	// about 60 % of the 25.6 ms hop time, capture goes on while the loop is busy
+	const Capture_Run fast = runCapture(15, 40);
+	CHECK_EQUAL(fast.dropped, 0u);
+	CHECK_EQUAL(fast.missing, 0u);
+	CHECK_EQUAL(fast.repeated, 0u);
+	CHECK_EQUAL(fast.read, fast.sent);
+
+	// longer than a hop time, the ring fills up and samples are lost but never reordered, every lost one is counted
+	const Capture_Run slow = runCapture(40, 15);
+	CHECK(slow.dropped > 0);
+	CHECK_EQUAL(slow.missing, slow.dropped);
+	CHECK_EQUAL(slow.repeated, 0u);
+	CHECK_EQUAL(slow.read, slow.written);
+	CHECK_EQUAL(slow.written + slow.dropped, slow.sent);
+	return testResult("capture");
+}
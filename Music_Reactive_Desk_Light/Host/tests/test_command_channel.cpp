@@ -0,0 +1,170 @@
+/*
+ Name:		test_command_channel.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Command_Channel on Text_Command_Input: settings and lists of them, lists with an invalid setting
+ that must leave every parameter alone, lines that arrive in pieces over several polls and lines that are
+ too long, whole or in pieces.
+*/
+
+#include <string.h>
+#include <string>
+#include "Command_Channel.h"
+#include "Test_Check.h"
+
+//! Parameters of a three band pipeline
+static Pipeline_Params testParams() {
+	Pipeline_Params params = {};
+	params.numBands = 3;
+	for (uint8_t b = 0; b < 3; b++) {
+		params.maxLevels[b] = 1000 * (b + 1);
+		params.bandUpper[b] = 2500 * (b + 1);
+	}
+	params.brightness = 255;
+	params.spectrumBars = 16;
+	return params;
+}
+
+//! Poll a text once
+static COMMAND_RESULT pollText(Command_Channel& channel, const char* text, Pipeline_Params& params) {
+	Text_Command_Input input(text);
+	return channel.poll(input, params);
+}
+
+/* Single settings and lists of them
+*
+*/
+static void testSettings() {
+	Command_Channel channel;
+	Pipeline_Params params = testParams();
+
+	CHECK(pollText(channel, "max 0 40000\n", params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.maxLevels[0], 40000);
+
+	CHECK(pollText(channel, " max 1 20000; brightness 100 ;effect 2; edge 2 48000;\r\n", params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.maxLevels[1], 20000);
+	CHECK_EQUAL(params.brightness, 100);
+	CHECK_EQUAL(params.effect, 2);
+	CHECK_EQUAL(params.bandUpper[2], 48000u);
+
+	CHECK(pollText(channel, "get\n", params) == COMMAND_RESULT::GET);
+	CHECK(pollText(channel, "p\n", params) == COMMAND_RESULT::PROFILE);
+	CHECK(pollText(channel, "\n\r\n", params) == COMMAND_RESULT::NONE); // empty lines are no command
+	CHECK_EQUAL(channel.errors(), 0u);
+
+	// one line per poll, the next one stays in the input
+	Text_Command_Input input("get\nprofile\nbars 8\n");
+	CHECK(channel.poll(input, params) == COMMAND_RESULT::GET);
+	CHECK(channel.poll(input, params) == COMMAND_RESULT::PROFILE);
+	CHECK(channel.poll(input, params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.spectrumBars, 8);
+	CHECK(channel.poll(input, params) == COMMAND_RESULT::NONE);
+}
+
+/* A list is applied whole or not at all
+*   The invalid setting may be first, in the middle or last, and be invalid by name, value or range.
+*/
+static void testAllOrNothing() {
+	Command_Channel channel;
+	Pipeline_Params params = testParams();
+	const char* invalid[] = {
+		"brightness 50; effect 99\n", // effect out of range, last
+		"bogus 1; brightness 50; quiet 3\n", // unknown, first
+		"brightness 50; max 3 100; quiet 3\n", // no band 3, in the middle
+		"brightness 50; max 0 0\n", // a max level of 0
+		"brightness 50; max 0 3000000000\n", // more than a q31_t
+		"brightness 50; quiet -3\n", // not an unsigned number
+		"brightness 50; bars 4 5\n", // a value too many
+		"brightness 50; edge 1\n", // a value too few
+		"brightness 50;; quiet 2x\n", // junk after a number
+	};
+	uint32_t errors = 0;
+	for (const char* text : invalid) {
+		const Pipeline_Params before = params;
+		if (!CHECK(pollText(channel, text, params) == COMMAND_RESULT::INVALID)) {
+			fprintf(stderr, "  %s", text);
+		}
+		CHECK_EQUAL(memcmp(&params, &before, sizeof(params)), 0);
+		CHECK_EQUAL(channel.errors(), ++errors);
+	}
+	CHECK_EQUAL(params.brightness, 255);
+
+	// the same settings without the invalid one go through
+	CHECK(pollText(channel, "brightness 50; quiet 3\n", params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.brightness, 50);
+	CHECK_EQUAL(params.quietLeds, 3);
+}
+
+/* Lines that arrive over several polls, e.g. typed into a serial terminal
+*
+*/
+static void testPartialLines() {
+	Command_Channel channel;
+	Pipeline_Params params = testParams();
+
+	CHECK(pollText(channel, "bright", params) == COMMAND_RESULT::NONE);
+	CHECK(pollText(channel, "ness 3", params) == COMMAND_RESULT::NONE);
+	CHECK(pollText(channel, "0; quiet 2\r", params) == COMMAND_RESULT::NONE);
+	CHECK_EQUAL(params.brightness, 255); // nothing before the end of the line
+	CHECK(pollText(channel, "\n", params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.brightness, 30);
+	CHECK_EQUAL(params.quietLeds, 2);
+
+	// a byte at a time
+	const char* text = "max 2 123456\n";
+	COMMAND_RESULT result = COMMAND_RESULT::NONE;
+	for (const char* c = text; *c != '\0'; c++) {
+		const char piece[2] = { *c, '\0' };
+		result = pollText(channel, piece, params);
+		if (c[1] != '\0') {
+			CHECK(result == COMMAND_RESULT::NONE);
+		}
+	}
+	CHECK(result == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.maxLevels[2], 123456);
+	CHECK_EQUAL(channel.errors(), 0u);
+}
+
+/* Lines longer than COMMAND_MAX_LINE are rejected whole, the line after them is read as usual
+*
+*/
+static void testLongLines() {
+	Command_Channel channel;
+	Pipeline_Params params = testParams();
+
+	// exactly COMMAND_MAX_LINE characters is still a line
+	std::string longest = "brightness 7";
+	longest.resize(COMMAND_MAX_LINE, ' ');
+	CHECK(pollText(channel, (longest + "\n").c_str(), params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.brightness, 7);
+
+	// one more and the line is rejected, although the first COMMAND_MAX_LINE characters are a valid list
+	std::string tooLong = "brightness 9; quiet 4";
+	tooLong.resize(COMMAND_MAX_LINE + 1, ' ');
+	const Pipeline_Params before = params;
+	CHECK(pollText(channel, (tooLong + "\nget\n").c_str(), params) == COMMAND_RESULT::INVALID);
+	CHECK_EQUAL(memcmp(&params, &before, sizeof(params)), 0);
+	CHECK_EQUAL(channel.errors(), 1u);
+
+	// too long over several polls: the part after the limit isn't taken for a new line
+	const std::string first = tooLong.substr(0, COMMAND_MAX_LINE - 5);
+	const std::string rest = tooLong.substr(COMMAND_MAX_LINE - 5);
+	CHECK(pollText(channel, first.c_str(), params) == COMMAND_RESULT::NONE);
+	CHECK(pollText(channel, rest.c_str(), params) == COMMAND_RESULT::NONE);
+	CHECK(pollText(channel, "; brightness 1\n", params) == COMMAND_RESULT::INVALID);
+	CHECK_EQUAL(memcmp(&params, &before, sizeof(params)), 0);
+	CHECK_EQUAL(channel.errors(), 2u);
+
+	// and the next line is fine
+	CHECK(pollText(channel, "brightness 9\n", params) == COMMAND_RESULT::SET);
+	CHECK_EQUAL(params.brightness, 9);
+}
+
+int main() {
+	testSettings();
+	testAllOrNothing();
+	testPartialLines();
+	testLongLines();
+	return testResult("command_channel");
+}
@@ -0,0 +1,124 @@
+/*
+ Name:		test_counters.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The frame counters of Audio_Pipeline with the capture of the sketch on Linux: the Isr_Driver writes
+ DMA blocks into a sample ring at 40 kHz, the pipeline reads it from the test thread. A led sink that takes longer
+ than a hop slows the processing down on purpose, then every slow hop has to be a deadline miss and the samples
+ the ring can't hold have to show up as skipped windows and interrupt overruns.
+*/
+
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Pruned_Rfft.h"
+#include "Spsc_Ring.h"
+#include "Isr_Driver.h"
+#include "Test_Check.h"
+
+#define COUNTERS_BLOCK 256 // the ADC DMA block
+#define COUNTERS_RING (4 * Config::hopSize) // as the sketch's sampleRing
+
+static Spsc_Ring<q15_t, COUNTERS_RING> sampleRing;
+
+/** Class Ring_Source: the sketch's Adc_Source, the samples the interrupt stored in the ring
+*/
+class Ring_Source : public Sample_Source {
+
+public:
+
+	uint32_t read(q15_t* samples, uint32_t count) override { return sampleRing.read(samples, count); }
+
+	uint32_t sampleRate() const override { return Config::sampleRate; }
+
+	uint32_t samplesDropped() const override { return sampleRing.itemsDropped(); }
+
+	uint32_t overruns() const override { return sampleRing.overruns(); }
+};
+
+/** Class Slow_Sink: a led strip that takes a while for every frame, repeated ones included
+*/
+class Slow_Sink : public Led_Sink {
+
+public:
+
+	explicit Slow_Sink(uint32_t millis) : delay(millis) {
+	}
+
+	void show(const Rgb*, uint16_t) override {
+		std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+	}
+
+private:
+	uint32_t delay;
+};
+
+/* Run the pipeline until it has processed a number of hops, with a led frame taking showMillis
+*   The ring has samples dropped before the run, begin() has to leave them out of the counters.
+*/
+static Frame_Counters runPipeline(uint32_t showMillis, uint32_t hops, uint64_t& samplesSent) {
+	sampleRing.clear();
+	const q15_t stale[8] = {};
+	for (uint32_t i = 0; i < (COUNTERS_RING + 2 * Config::hopSize) / 8; i++) {
+		sampleRing.write(stale, 8); // two hops more than the ring holds
+	}
+	sampleRing.clear();
+	const uint32_t droppedBefore = sampleRing.itemsDropped();
+
+	Ring_Source source;
+	Slow_Sink sink(showMillis);
+	Fft_Engine engine;
+	Pruned_Rfft spectrum(engine);
+	Audio_Pipeline<Config> pipeline(source, spectrum, sink);
+	CHECK(pipeline.begin(ANALYSIS_ENGINE::FFT, fftWindow, inputGain, goertzelFiltersPerBand));
+	CHECK_EQUAL(pipeline.counters().windowsSkipped, 0u);
+	CHECK_EQUAL(pipeline.counters().isrOverruns, 0u);
+
+	Isr_Driver driver;
+	driver.start(Config::sampleRate, COUNTERS_BLOCK, [&](const int16_t* samples, uint32_t count) { sampleRing.write(samples, count); });
+	while (pipeline.counters().framesProcessed < hops) {
+		if (!pipeline.process()) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+	driver.stop();
+	samplesSent = driver.samplesSent();
+
+	const Frame_Counters counters = pipeline.counters();
+	CHECK_EQUAL(counters.windowsSkipped, (sampleRing.itemsDropped() - droppedBefore) / Config::hopSize);
+	printf("show %u ms: %u produced, %u processed, %u skipped, %u overruns, %u deadline misses, %u led frames\n", showMillis,
+		counters.framesProduced, counters.framesProcessed, counters.windowsSkipped, counters.isrOverruns, counters.deadlineMisses,
+		counters.ledFrames);
+	return counters;
+}
+
+int main() {
+	const uint32_t hops = 20;
+	const uint32_t ringHops = COUNTERS_RING / Config::hopSize;
+
+	// a hop takes a fraction of its 25.6 ms, nothing is lost and no deadline missed
+	uint64_t sent = 0;
+	const Frame_Counters fast = runPipeline(0, hops, sent);
+	CHECK_EQUAL(fast.framesProcessed, hops);
+	CHECK_EQUAL(fast.windowsSkipped, 0u);
+	CHECK_EQUAL(fast.isrOverruns, 0u);
+	CHECK_EQUAL(fast.deadlineMisses, 0u);
+	CHECK(fast.framesProduced >= fast.framesProcessed);
+	CHECK(fast.framesProduced <= sent / Config::hopSize);
+	CHECK(fast.ledFrames > 0 && fast.ledFrames < hops); // the first hops only fill the window
+
+	// 40 ms per led frame: every frame misses the deadline, the ring fills up and drops whole hops worth of samples
+	const Frame_Counters slow = runPipeline(40, hops, sent);
+	CHECK_EQUAL(slow.framesProcessed, hops);
+	CHECK(slow.ledFrames > 0);
+	CHECK(slow.deadlineMisses >= slow.ledFrames);
+	CHECK(slow.deadlineMisses <= slow.framesProcessed);
+	CHECK(slow.windowsSkipped > 0);
+	CHECK(slow.isrOverruns > 0);
+	CHECK(slow.framesProduced <= sent / Config::hopSize);
+	CHECK(slow.framesProduced - slow.framesProcessed - slow.windowsSkipped <= ringHops + 1); // the rest is still in the ring
+	return testResult("counters");
+}
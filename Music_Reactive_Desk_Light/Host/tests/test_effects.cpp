@@ -0,0 +1,177 @@
+/*
+ Name:		test_effects.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The led effects selected the way the desk light selects them: an "effect <n>" command sets
+ Pipeline_Params::effect, the band frames carry it to the Led_Renderer like Audio_Pipeline's do, and the
+ renderer switches. Every effect has to draw its own kind of frame from the same levels, and an effect
+ that doesn't exist, by command or in a band frame, has to keep the one that is shown.
+*/
+
+#include <string.h>
+#include "Desk_Light_Config.h"
+#include "Command_Channel.h"
+#include "Led_Renderer.h"
+#include "Test_Check.h"
+
+#define EFFECTS_SPECTRUM_BAR 20 // the only spectrum bar that isn't dark
+
+static bool isDark(const Rgb& led) {
+	return led.r == 0 && led.g == 0 && led.b == 0;
+}
+
+static bool sameColor(const Rgb& a, const Rgb& b) {
+	return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+//! Number of leds that aren't dark
+static uint16_t litLeds(const Rgb* leds) {
+	uint16_t lit = 0;
+	for (uint16_t i = 0; i < Config::numLeds; i++) {
+		lit += !isDark(leds[i]);
+	}
+	return lit;
+}
+
+/** Class Null_Sink: the frames are read from the renderer
+*/
+class Null_Sink : public Led_Sink {
+
+public:
+
+	void show(const Rgb*, uint16_t) override {}
+};
+
+/** Class Effects_Test: a command channel, the parameters and a renderer, as on the desk light
+*/
+class Effects_Test {
+
+public:
+
+	Effects_Test() : params{}, renderer(slot, sink), now(0) {
+		params.numBands = Config::numBands;
+		params.brightness = 255;
+		renderer.begin(0, { 0, 0, 0, 0 }); // no glide and no envelope, the bars are the levels of the band frame
+	}
+
+	//! Send a command line
+	COMMAND_RESULT command(const char* line) {
+		Text_Command_Input input(line);
+		return channel.poll(input, params);
+	}
+
+	//! Publish a band frame with the parameters' effect and render it
+	/** \param bass, mid, treble leds lit per band.
+	*/
+	const Rgb* render(uint16_t bass, uint16_t mid, uint16_t treble) {
+		Band_Frame frame = {};
+		const uint16_t leds[] = { bass, mid, treble };
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			frame.leds[b] = (uint32_t)leds[b] << BAND_FRAME_FRACTION_BITS;
+		}
+		frame.brightness = params.brightness;
+		frame.effect = params.effect;
+		frame.spectrumBars = Config::numLeds; // a bar per led
+		frame.spectrum[EFFECTS_SPECTRUM_BAR] = 200;
+		slot.publish(frame);
+		renderer.render(now += 10000);
+		return renderer.ledFrame();
+	}
+
+	Pipeline_Params params;
+	Command_Channel channel;
+	Latest_Slot<Band_Frame> slot;
+	Null_Sink sink;
+	Led_Renderer<Config> renderer;
+	uint32_t now;
+};
+
+/* Each effect by command, and the frame it draws from the levels 10, 30 and 5
+*
+*/
+static void testEffects() {
+	Effects_Test test;
+	const Led_Segment mid = Config::ledSegment(1);
+
+	// vu bars: every segment lit from its start up to its level
+	CHECK(test.command("effect 0\n") == COMMAND_RESULT::SET);
+	const Rgb* leds = test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::VU_BARS);
+	CHECK_EQUAL(test.renderer.ledsOn(1), 30u);
+	CHECK_EQUAL(litLeds(leds), 45u);
+	CHECK(!isDark(leds[mid.firstLed + 29]) && isDark(leds[mid.firstLed + 30]));
+
+	// spectrum: a led per bar, only the one bar of the frame
+	CHECK(test.command("effect 1\n") == COMMAND_RESULT::SET);
+	leds = test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::SPECTRUM);
+	CHECK_EQUAL(litLeds(leds), 1u);
+	CHECK(!isDark(leds[EFFECTS_SPECTRUM_BAR]));
+
+	// beat pulse: the first loud bass is a beat, the whole strip in one colour
+	CHECK(test.command("effect 2\n") == COMMAND_RESULT::SET);
+	leds = test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::BEAT_PULSE);
+	CHECK_EQUAL(litLeds(leds), Config::numLeds);
+	uint16_t different = 0;
+	for (uint16_t i = 1; i < Config::numLeds; i++) {
+		different += !sameColor(leds[i], leds[0]);
+	}
+	CHECK_EQUAL(different, 0u);
+
+	// centre mirror: the loudest band, 30 of 39, as a bar of 45 leds to both sides of led 58
+	CHECK(test.command("effect 3\n") == COMMAND_RESULT::SET);
+	leds = test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::CENTER_MIRROR);
+	const uint16_t center = Config::numLeds / 2;
+	CHECK_EQUAL(center, 58u);
+	uint16_t asymmetric = 0;
+	for (uint16_t d = 0; d <= center; d++) {
+		asymmetric += !sameColor(leds[center + d], leds[center - d]);
+	}
+	CHECK_EQUAL(asymmetric, 0u);
+	const uint16_t half = 30 * ((Config::numLeds + 1) / 2) / mid.numLeds;
+	CHECK(!isDark(leds[center]) && !isDark(leds[center + half - 1]) && isDark(leds[center + half]));
+	CHECK_EQUAL(litLeds(leds), 2 * half - 1);
+
+	// waterfall: a led per band frame at the start of the strip, in the colour of the loudest band
+	CHECK(test.command("effect 4\n") == COMMAND_RESULT::SET);
+	test.render(10, 30, 5);
+	test.render(39, 0, 0);
+	leds = test.render(0, 0, 39);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::WATERFALL);
+	CHECK_EQUAL(litLeds(leds), 3u);
+	CHECK(!isDark(leds[0]) && !isDark(leds[1]) && !isDark(leds[2]));
+	CHECK(!sameColor(leds[0], leds[1]) && !sameColor(leds[1], leds[2]) && !sameColor(leds[0], leds[2]));
+	const Rgb newest = leds[0];
+	test.render(0, 0, 39);
+	CHECK(sameColor(test.renderer.ledFrame()[1], newest)); // moved on by a led
+
+	// no effect 5: the command is rejected and the waterfall stays
+	CHECK(test.command("effect 5\n") == COMMAND_RESULT::INVALID);
+	CHECK_EQUAL(test.params.effect, (uint8_t)LED_EFFECT::WATERFALL);
+	test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::WATERFALL);
+	CHECK_EQUAL(litLeds(test.renderer.ledFrame()), 5u);
+
+	// a band frame with an unknown effect keeps it too, and its state
+	test.params.effect = (uint8_t)LED_EFFECT::COUNT;
+	leds = test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::WATERFALL);
+	CHECK_EQUAL(litLeds(leds), 6u);
+
+	// back to the vu bars by command
+	CHECK(test.command("effect 0\n") == COMMAND_RESULT::SET);
+	test.render(10, 30, 5);
+	CHECK_EQUAL(test.renderer.effects().selected(), (uint8_t)LED_EFFECT::VU_BARS);
+}
+
+int main() {
+	testEffects();
+	for (uint8_t e = 0; e < (uint8_t)LED_EFFECT::COUNT; e++) {
+		CHECK(Desk_Light_Effects<Config>::name(e) != nullptr);
+	}
+	CHECK(Desk_Light_Effects<Config>::name((uint8_t)LED_EFFECT::COUNT) == nullptr);
+	return testResult("effects");
+}
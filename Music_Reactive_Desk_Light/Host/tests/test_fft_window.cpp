@@ -0,0 +1,96 @@
+/*
+ Name:		test_fft_window.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Spectral leakage of Fft_Window. A tone between two bins, on the ADC's DC level, goes through
+ bias removal, gain and the Q15 window; a double precision DFT of the result shows how much of the tone leaks
+ into bins away from it. The limits are those of the windows less a few dB for the Q15 table and the 16 bit
+ output: Hann's sidelobes start at -31 dB and fall 18 dB per octave, Blackman's start at -58 dB.
+ Without a window the same tone leaks at -13 dB, which the test also checks, so it sees a missing window.
+*/
+
+#include <math.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Fft_Window.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define WINDOW_SIZE 2048
+#define TONE_BIN 200.5 // the worst case: half way between two bins
+#define ADC_BIAS 2048
+
+//! Power of bins 0 up to n/2 of the samples, in dB against the strongest bin
+static std::vector<double> spectrumDb(const std::vector<q15_t>& samples) {
+	const uint32_t n = (uint32_t)samples.size();
+	std::vector<double> cosine(n);
+	std::vector<double> sine(n);
+	for (uint32_t i = 0; i < n; i++) {
+		cosine[i] = cos(2 * M_PI * i / n);
+		sine[i] = sin(2 * M_PI * i / n);
+	}
+	std::vector<double> power(n / 2 + 1);
+	double peak = 0;
+	for (uint32_t k = 0; k <= n / 2; k++) {
+		double re = 0;
+		double im = 0;
+		for (uint32_t i = 0, angle = 0; i < n; i++, angle = (angle + k) & (n - 1)) {
+			re += samples[i] * cosine[angle];
+			im -= samples[i] * sine[angle];
+		}
+		power[k] = re * re + im * im;
+		peak = power[k] > peak ? power[k] : peak;
+	}
+	for (double& value : power) {
+		value = 10 * log10(value / peak + 1e-30);
+	}
+	return power;
+}
+
+/* Window an off-bin tone and return the worst leakage in dB at least `distance` bins from the tone
+*
+*/
+static double leakage(WINDOW_TYPE type, double distance) {
+	Fft_Window window;
+	CHECK(window.begin(WINDOW_SIZE, type));
+	window.setGain(inputGain);
+	std::vector<q15_t> samples = testTone(TONE_BIN, 1000, WINDOW_SIZE, WINDOW_SIZE);
+	for (q15_t& sample : samples) {
+		sample += ADC_BIAS;
+	}
+	window.apply(samples.data(), samples.data(), 0, WINDOW_SIZE, ADC_BIAS);
+
+	const std::vector<double> power = spectrumDb(samples);
+	double worst = -1000;
+	for (uint32_t k = 0; k < power.size(); k++) {
+		if (fabs(k - TONE_BIN) >= distance && power[k] > worst) {
+			worst = power[k];
+		}
+	}
+	return worst;
+}
+
+//! Check the leakage of a window from some distance on against a limit in dB
+static void checkLeakage(WINDOW_TYPE type, double distance, double limit, const char* name) {
+	const double worst = leakage(type, distance);
+	if (!CHECK(worst < limit)) {
+		fprintf(stderr, "  %s: %.1f dB from %g bins on, limit %.1f dB\n", name, worst, distance, limit);
+	}
+}
+
+int main() {
+	// Hann: main lobe of 2 bins, -31 dB less the scalloping of the off-bin tone next to it
+	checkLeakage(WINDOW_TYPE::HANN, 2, -29, "hann");
+	checkLeakage(WINDOW_TYPE::HANN, 8, -60, "hann");
+	checkLeakage(WINDOW_TYPE::HANN, 16, -70, "hann");
+
+	// Blackman: main lobe of 3 bins, then -58 dB; further out the rounding of the test tone to ADC counts limits it
+	checkLeakage(WINDOW_TYPE::BLACKMAN, 4, -55, "blackman");
+	checkLeakage(WINDOW_TYPE::BLACKMAN, 8, -70, "blackman");
+
+	// no window: the tone leaks everywhere
+	CHECK(leakage(WINDOW_TYPE::RECTANGULAR, 2) > -15);
+	CHECK(leakage(WINDOW_TYPE::RECTANGULAR, 8) > -30);
+	return testResult("fft_window");
+}
@@ -0,0 +1,179 @@
+/*
+ Name:		test_file_source.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: File_Source on generated files: mono and stereo WAV headers, a chunk between fmt and data,
+ upper case and missing extensions, raw PCM, truncated and unsupported headers that have to be rejected,
+ and a 44.1 kHz tone resampled to the 40 kHz capture rate that has to keep its frequency and amplitude.
+*/
+
+#include <math.h>
+#include <string>
+#include <vector>
+#include "File_Source.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define RESAMPLE_FREQUENCY 1000.0 // Hz of the resampled tone
+#define RESAMPLE_AMPLITUDE 16000.0 // 16 bit peak, 1000 ADC counts after the >> 4
+#define RESAMPLE_MAX_FREQUENCY_ERROR 0.05 // Hz
+#define RESAMPLE_MAX_AMPLITUDE_ERROR 0.005 // relative
+#define RESAMPLE_MAX_RESIDUAL 1.0 // rms ADC counts left after removing the fitted tone
+
+static std::string directory;
+
+//! Write a file and open it
+static bool openFile(File_Source& source, const char* name, const std::vector<uint8_t>& bytes, uint32_t rawRate, uint32_t captureRate) {
+	const std::string path = directory + "/" + name;
+	return writeTestFile(path, bytes) && source.open(path.c_str(), rawRate, captureRate);
+}
+
+//! Every sample of a source
+static std::vector<q15_t> readAll(File_Source& source) {
+	std::vector<q15_t> samples;
+	q15_t block[100];
+	while (!source.finished()) {
+		const uint32_t count = source.read(block, 100);
+		samples.insert(samples.end(), block, block + count);
+	}
+	return samples;
+}
+
+/* WAV headers: mono, stereo mixed to mono, a chunk of odd size before data, the name doesn't matter
+*
+*/
+static void testWavHeaders() {
+	const std::vector<int16_t> mono = { 0, 16, -16, 32767, -32768, 1600, -1600, 48 };
+	File_Source source;
+	CHECK(openFile(source, "TRACK.WAV", testWav(mono, 1, 40000), 0, 0)); // no raw rate: has to be read as WAV
+	CHECK_EQUAL(source.fileRate(), 40000u);
+	CHECK_EQUAL(source.sampleRate(), 40000u);
+	CHECK_EQUAL(source.fileFrames(), (uint64_t)mono.size());
+	std::vector<q15_t> samples = readAll(source);
+	CHECK_EQUAL(samples.size(), mono.size());
+	for (size_t i = 0; i < samples.size() && i < mono.size(); i++) {
+		CHECK_EQUAL(samples[i], mono[i] >> 4);
+	}
+
+	// left and right are averaged
+	const std::vector<int16_t> stereo = { 1600, 0, -3200, -1600, 32767, 32767, 800, -800 };
+	CHECK(openFile(source, "stereo", testWav(stereo, 2, 22050), 0, 0));
+	CHECK_EQUAL(source.fileRate(), 22050u);
+	CHECK_EQUAL(source.fileFrames(), 4u);
+	samples = readAll(source);
+	const q15_t mixed[] = { 800 >> 4, -2400 >> 4, 32767 >> 4, 0 };
+	CHECK_EQUAL(samples.size(), 4u);
+	for (size_t i = 0; i < samples.size() && i < 4; i++) {
+		CHECK_EQUAL(samples[i], mixed[i]);
+	}
+
+	// a LIST chunk of odd size, padded to even, between fmt and data
+	const std::vector<uint8_t> list = { 'L', 'I', 'S', 'T', 5, 0, 0, 0, 'I', 'N', 'F', 'O', 'x', 0 };
+	CHECK(openFile(source, "list.wav", testWav(mono, 1, 40000, list), 0, 0));
+	CHECK_EQUAL(source.fileFrames(), (uint64_t)mono.size());
+	samples = readAll(source);
+	CHECK(samples.size() == mono.size() && samples[3] == 32767 >> 4 && samples[7] == 48 >> 4);
+
+	// raw PCM is raw whatever its name, it needs a rate
+	std::vector<uint8_t> raw;
+	for (int16_t sample : mono) {
+		appendLittleEndian(raw, (uint16_t)sample, 2);
+	}
+	CHECK(!openFile(source, "raw.pcm", raw, 0, 0));
+	CHECK(openFile(source, "raw.wav", raw, 40000, 0));
+	CHECK_EQUAL(source.fileFrames(), (uint64_t)mono.size());
+	samples = readAll(source);
+	CHECK(samples.size() == mono.size() && samples[4] == -32768 >> 4);
+}
+
+/* Truncated or unsupported headers are rejected, not played as raw samples
+*
+*/
+static void testRejected() {
+	const std::vector<int16_t> mono(64, 1000);
+	const std::vector<uint8_t> wav = testWav(mono, 1, 40000);
+	File_Source source;
+	const size_t cuts[] = { 4, 10, 20, 36, 40 }; // in the RIFF header, in fmt, after fmt, in the data chunk header
+	for (size_t cut : cuts) {
+		const std::vector<uint8_t> truncated(wav.begin(), wav.begin() + cut);
+		if (!CHECK(!openFile(source, "truncated.wav", truncated, 40000, 0))) {
+			fprintf(stderr, "  cut after %u bytes\n", (unsigned)cut);
+		}
+	}
+
+	std::vector<uint8_t> eightBit = wav;
+	eightBit[34] = 8; // bits per sample
+	CHECK(!openFile(source, "8bit.wav", eightBit, 40000, 0));
+	std::vector<uint8_t> compressed = wav;
+	compressed[20] = 3; // IEEE float
+	CHECK(!openFile(source, "float.wav", compressed, 40000, 0));
+	std::vector<uint8_t> form = wav;
+	form[8] = 'A'; // RIFF but not WAVE
+	CHECK(!openFile(source, "avi.wav", form, 40000, 0));
+	CHECK(!openFile(source, "empty.wav", std::vector<uint8_t>(), 40000, 0));
+}
+
+/* 44.1 kHz to 40 kHz: the tone is fitted with a sine and cosine of the frequency found from its zero crossings
+*   The first and last FILE_SOURCE_TAPS samples are left out, the filter runs over the ends of the file there.
+*/
+static void testResampling() {
+	const uint32_t fileRate = 44100;
+	std::vector<int16_t> tone(fileRate);
+	for (uint32_t i = 0; i < fileRate; i++) {
+		tone[i] = (int16_t)lrint(RESAMPLE_AMPLITUDE * sin(2 * M_PI * RESAMPLE_FREQUENCY * i / fileRate));
+	}
+	File_Source source;
+	CHECK(openFile(source, "tone.wav", testWav(tone, 1, fileRate), 0, 40000));
+	CHECK_EQUAL(source.sampleRate(), 40000u);
+	const uint64_t expectedLength = source.length();
+	const std::vector<q15_t> samples = readAll(source);
+	CHECK_EQUAL((uint64_t)samples.size(), expectedLength);
+	CHECK(samples.size() >= 39999 && samples.size() <= 40001);
+
+	// rising zero crossings, interpolated between the samples
+	const size_t first = FILE_SOURCE_TAPS;
+	const size_t last = samples.size() - FILE_SOURCE_TAPS;
+	double firstCrossing = -1;
+	double lastCrossing = -1;
+	uint32_t crossings = 0;
+	for (size_t i = first; i + 1 < last; i++) {
+		if (samples[i] < 0 && samples[i + 1] >= 0) {
+			const double at = i + (double)-samples[i] / (samples[i + 1] - samples[i]);
+			firstCrossing = firstCrossing < 0 ? at : firstCrossing;
+			lastCrossing = at;
+			crossings++;
+		}
+	}
+	const double frequency = crossings > 1 ? (crossings - 1) * 40000.0 / (lastCrossing - firstCrossing) : 0;
+
+	// least squares fit of the tone at that frequency
+	double sumSin = 0, sumCos = 0;
+	for (size_t i = first; i < last; i++) {
+		sumSin += samples[i] * sin(2 * M_PI * frequency * i / 40000);
+		sumCos += samples[i] * cos(2 * M_PI * frequency * i / 40000);
+	}
+	const double n = (double)(last - first);
+	const double a = 2 * sumSin / n;
+	const double b = 2 * sumCos / n;
+	const double amplitude = sqrt(a * a + b * b);
+	double residual = 0;
+	for (size_t i = first; i < last; i++) {
+		const double fitted = a * sin(2 * M_PI * frequency * i / 40000) + b * cos(2 * M_PI * frequency * i / 40000);
+		residual += (samples[i] - fitted) * (samples[i] - fitted);
+	}
+	residual = sqrt(residual / n);
+	printf("resampled tone: %.4f Hz, amplitude %.2f ADC counts, residual %.3f rms\n", frequency, amplitude, residual);
+
+	CHECK(fabs(frequency - RESAMPLE_FREQUENCY) < RESAMPLE_MAX_FREQUENCY_ERROR);
+	CHECK(fabs(amplitude / (RESAMPLE_AMPLITUDE / 16) - 1) < RESAMPLE_MAX_AMPLITUDE_ERROR);
+	CHECK(residual < RESAMPLE_MAX_RESIDUAL);
+}
+
+int main() {
+	directory = testDirectory("test_file_source");
+	testWavHeaders();
+	testRejected();
+	testResampling();
+	return testResult("file_source");
+}
@@ -0,0 +1,45 @@
+/*
+ Name:		test_goertzel_bands.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Goertzel_Bands: the limit of GOERTZEL_MAX_FILTERS over all bands, also for filter counts whose
+ sum doesn't fit in 8 bits, and a tone ending up in the band of its frequency.
+*/
+
+#include <vector>
+#include "Band_Map.h"
+#include "Goertzel_Bands.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define TEST_RATE 40000
+#define TEST_SIZE 8192
+
+int main() {
+	// 500, 1000 and 1500 Hz: about 100 bins per band, enough for any filter count up to that
+	const uint32_t edges[] = { 5000, 10000, 15000 };
+	Band_Map map;
+	CHECK(map.configure(TEST_RATE, TEST_SIZE, edges, 3));
+	Goertzel_Bands bands;
+
+	CHECK(!bands.begin(map, 0));
+	CHECK(!bands.begin(map, 11)); // 33 filters
+	CHECK(!bands.begin(map, 86)); // 258, 2 in 8 bits
+	CHECK(!bands.begin(map, 255));
+	CHECK(bands.begin(map, 10)); // 30 filters
+
+	// a 750 Hz tone is in the middle band, the others only get the leakage of the block without a window,
+	// which falls off slowly: the next band gets a sixth of it
+	std::vector<q15_t> tone = testTone(750, 1000, TEST_RATE, TEST_SIZE);
+	CHECK(bands.process(tone.data(), TEST_SIZE));
+	CHECK(bands.magnitude(1) > 4 * bands.magnitude(0));
+	CHECK(bands.magnitude(1) > 4 * bands.magnitude(2));
+
+	// a failed begin() leaves the filters alone
+	CHECK(!bands.begin(map, 86));
+	CHECK(bands.process(tone.data(), TEST_SIZE));
+	CHECK(bands.magnitude(1) > 4 * bands.magnitude(0));
+
+	return testResult("goertzel_bands");
+}
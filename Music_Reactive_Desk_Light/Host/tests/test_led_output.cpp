@@ -0,0 +1,181 @@
+/*
+ Name:		test_led_output.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The differential led output of Audio_Pipeline and Led_Renderer with a sink that counts its calls.
+ A frame equal to the one the strip shows has to go to repeat(), not show(), a brightness change has to send the
+ next frame even if its leds are the same, and framesUnchanged() has to count the repeated frames.
+*/
+
+#include <string.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Led_Renderer.h"
+#include "Pruned_Rfft.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+/** Class Counting_Sink: counts the calls and checks them against the frame the strip would show
+*/
+class Counting_Sink : public Led_Sink {
+
+public:
+
+	Counting_Sink() : shows(0), repeats(0), brightnessChanges(0), needlessShows(0), wrongRepeats(0), brightness(255),
+		brightness_changed(false), strip(Config::numLeds) {
+	}
+
+	void show(const Rgb* leds, uint16_t count) override {
+		if (!brightness_changed && sameFrame(leds, count) && shows > 0) {
+			needlessShows++;
+		}
+		strip.assign(leds, leds + count);
+		brightness_changed = false;
+		shows++;
+	}
+
+	void repeat(const Rgb* leds, uint16_t count) override {
+		if (brightness_changed || !sameFrame(leds, count) || shows == 0) {
+			wrongRepeats++; // the strip would keep showing something else
+		}
+		repeats++;
+	}
+
+	void setBrightness(uint8_t value) override {
+		brightness = value;
+		brightness_changed = true;
+		brightnessChanges++;
+	}
+
+	uint32_t shows;
+	uint32_t repeats;
+	uint32_t brightnessChanges;
+	uint32_t needlessShows; // frames sent that the strip already showed
+	uint32_t wrongRepeats; // frames not sent that differ from what the strip shows
+	uint8_t brightness;
+
+private:
+	bool sameFrame(const Rgb* leds, uint16_t count) const {
+		return count == strip.size() && memcmp(leds, strip.data(), count * sizeof(Rgb)) == 0;
+	}
+
+	bool brightness_changed; // the strip takes it with the next frame sent
+	std::vector<Rgb> strip;
+};
+
+//! Process until the pipeline has made a frame
+static bool nextFrame(Audio_Pipeline<Config>& pipeline, Tone_Source& source) {
+	while (!source.finished()) {
+		if (pipeline.process()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/* The pipeline showing its own frames: silence, a brightness change during the silence, then a tone
+*
+*/
+static void testPipeline() {
+	const uint32_t quietHops = 8;
+	const uint32_t toneHops = 8;
+	std::vector<q15_t> signal(Config::fftSize + (quietHops - 1) * Config::hopSize, 0);
+	const std::vector<q15_t> tone = testTone(700, 800, Config::sampleRate, toneHops * Config::hopSize);
+	signal.insert(signal.end(), tone.begin(), tone.end());
+	Tone_Source source(signal, Config::sampleRate);
+	Counting_Sink sink;
+	Fft_Engine engine;
+	Pruned_Rfft spectrum(engine);
+	Audio_Pipeline<Config> pipeline(source, spectrum, sink);
+	CHECK(pipeline.begin(ANALYSIS_ENGINE::FFT, fftWindow, inputGain, goertzelFiltersPerBand));
+	pipeline.setMaxLevel(0, maxBass);
+	pipeline.setMaxLevel(1, maxMid);
+	pipeline.setMaxLevel(2, maxTreble);
+
+	// dark frames: the first is sent, the others are repeats
+	for (uint32_t f = 0; f < 4; f++) {
+		CHECK(nextFrame(pipeline, source));
+	}
+	CHECK_EQUAL(sink.shows, 1u);
+	CHECK_EQUAL(sink.repeats, 3u);
+	CHECK_EQUAL(pipeline.framesUnchanged(), 3u);
+
+	// the same dark frame is sent once more with the new brightness, then repeated again
+	Pipeline_Params params = pipeline.params();
+	params.brightness = 100;
+	CHECK(pipeline.setParams(params));
+	CHECK(nextFrame(pipeline, source));
+	CHECK_EQUAL(sink.brightnessChanges, 1u);
+	CHECK_EQUAL(sink.brightness, 100u);
+	CHECK_EQUAL(sink.shows, 2u);
+	CHECK(nextFrame(pipeline, source));
+	CHECK_EQUAL(sink.shows, 2u);
+	CHECK_EQUAL(pipeline.framesUnchanged(), 4u);
+
+	// the tone lights the mid segment, the frames that change are sent
+	while (nextFrame(pipeline, source)) {
+	}
+	printf("pipeline: %u frames, %u shown, %u repeated\n", pipeline.framesShown(), sink.shows, sink.repeats);
+	CHECK(pipeline.ledsOn(1) > 0);
+	CHECK(sink.shows > 2);
+	CHECK_EQUAL(pipeline.framesShown(), quietHops + toneHops);
+	CHECK_EQUAL(sink.shows + sink.repeats, pipeline.framesShown());
+	CHECK_EQUAL(pipeline.framesUnchanged(), sink.repeats);
+	CHECK_EQUAL(pipeline.counters().ledFramesUnchanged, sink.repeats);
+	CHECK_EQUAL(sink.needlessShows, 0u);
+	CHECK_EQUAL(sink.wrongRepeats, 0u);
+}
+
+//! A band frame with the same bar height in every band
+static Band_Frame bandFrame(uint16_t leds, uint8_t brightness) {
+	Band_Frame frame = {};
+	for (uint8_t b = 0; b < Config::numBands; b++) {
+		frame.leds[b] = (uint32_t)leds << BAND_FRAME_FRACTION_BITS;
+	}
+	frame.brightness = brightness;
+	frame.effect = (uint8_t)LED_EFFECT::VU_BARS;
+	return frame;
+}
+
+/* The renderer at its own rate: renders between two analysis frames repeat, a brightness change resends
+*   No glide, attack or decay, so every render shows the latest band frame.
+*/
+static void testRenderer() {
+	Latest_Slot<Band_Frame> slot;
+	Counting_Sink sink;
+	Led_Renderer<Config> renderer(slot, sink);
+	renderer.begin(0, { 0, 0, 0, 0 });
+	uint32_t now = 1000;
+
+	slot.publish(bandFrame(10, 255));
+	CHECK(renderer.render(now += 1000));
+	CHECK(!renderer.render(now += 1000));
+	CHECK(!renderer.render(now += 1000));
+	CHECK_EQUAL(renderer.framesUnchanged(), 2u);
+
+	slot.publish(bandFrame(10, 40)); // the same bars dimmed
+	CHECK(renderer.render(now += 1000));
+	CHECK_EQUAL(sink.brightnessChanges, 1u);
+	CHECK_EQUAL(sink.brightness, 40u);
+	CHECK(!renderer.render(now += 1000));
+
+	slot.publish(bandFrame(10, 40)); // a new analysis frame with the same content
+	CHECK(!renderer.render(now += 1000));
+	slot.publish(bandFrame(20, 40));
+	CHECK(renderer.render(now += 1000));
+
+	CHECK_EQUAL(renderer.framesRendered(), 7u);
+	CHECK_EQUAL(renderer.framesUnchanged(), 4u);
+	CHECK_EQUAL(sink.shows, 3u);
+	CHECK_EQUAL(sink.repeats, 4u);
+	CHECK_EQUAL(sink.needlessShows, 0u);
+	CHECK_EQUAL(sink.wrongRepeats, 0u);
+}
+
+int main() {
+	testPipeline();
+	testRenderer();
+	return testResult("led_output");
+}
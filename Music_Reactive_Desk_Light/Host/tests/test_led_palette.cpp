@@ -0,0 +1,112 @@
+/*
+ Name:		test_led_palette.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Led_Palette against the per led conversion it replaced, hsvColor(hue++, saturation, i < ledsOn ? value : 0)
+ for every led of the bar. Every first hue and every bar height, segments longer than the 256 hues so the run
+ wraps more than once, several saturation and brightness presets, and the bars of the desk light strip one after
+ the other. The leds have to be the same to the byte, and fillBar() must not touch the leds outside its segment.
+*/
+
+#include <string.h>
+#include "Desk_Light_Config.h"
+#include "Led_Palette.h"
+#include "Test_Check.h"
+
+#define PALETTE_GUARD 8 // leds before and after the segment that must stay as they were
+#define PALETTE_MAX_LEDS 300 // the hues wrap twice from a first hue above 212
+
+//! Same bytes in two colours
+static bool sameColor(Rgb a, Rgb b) {
+	return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+//! The old bar rendering: every led converted on its own, the dark ones too
+static void hsvBar(Rgb* leds, const Led_Segment& segment, uint16_t ledsOn, uint8_t firstHue, uint8_t saturation, uint8_t value) {
+	uint8_t hue = firstHue;
+	for (uint16_t i = 0; i < segment.numLeds; i++) {
+		leds[segment.firstLed + i] = hsvColor(hue++, saturation, i < ledsOn ? value : 0);
+	}
+}
+
+/* Every first hue and every bar height of one segment length and preset
+*   \return the number of bars that differ.
+*/
+static uint32_t compareSegment(const Led_Palette& palette, uint16_t numLeds, uint8_t saturation, uint8_t value) {
+	static Rgb expected[PALETTE_MAX_LEDS + 2 * PALETTE_GUARD];
+	static Rgb rendered[PALETTE_MAX_LEDS + 2 * PALETTE_GUARD];
+	const Led_Segment segment = { PALETTE_GUARD, numLeds };
+	const uint32_t frameBytes = (numLeds + 2 * PALETTE_GUARD) * sizeof(Rgb);
+	uint32_t mismatches = 0;
+	for (uint16_t hue = 0; hue < 256; hue++) {
+		for (uint16_t ledsOn = 0; ledsOn <= numLeds; ledsOn++) {
+			memset(expected, 0xa5, frameBytes); // the guard leds keep this pattern
+			memset(rendered, 0xa5, frameBytes);
+			hsvBar(expected, segment, ledsOn, (uint8_t)hue, saturation, value);
+			palette.fillBar(rendered, segment, ledsOn, (uint8_t)hue);
+			if (memcmp(expected, rendered, frameBytes) != 0) {
+				if (mismatches == 0) {
+					fprintf(stderr, "  first mismatch: %u leds, hue %u, %u on, saturation %u, value %u\n", numLeds, hue, ledsOn, saturation, value);
+				}
+				mismatches++;
+			}
+		}
+	}
+	return mismatches;
+}
+
+/* The bars of the desk light strip from one palette, the hue running on along the strip
+*
+*/
+static void testStrip() {
+	Led_Palette palette;
+	palette.begin(255, 255);
+	Rgb expected[Config::numLeds];
+	Rgb rendered[Config::numLeds];
+	uint32_t mismatches = 0;
+	for (uint16_t height = 0; height <= Config::numLeds; height++) {
+		uint8_t hue = LED_FIRST_HUE;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const Led_Segment segment = Config::ledSegment(b);
+			uint16_t ledsOn = (uint16_t)((height + 13 * b) % (segment.numLeds + 1)); // the bars at different heights
+			hsvBar(expected, segment, ledsOn, hue, 255, 255);
+			palette.fillBar(rendered, segment, ledsOn, hue);
+			hue += segment.numLeds;
+		}
+		mismatches += memcmp(expected, rendered, sizeof(expected)) != 0;
+	}
+	CHECK_EQUAL(mismatches, 0u);
+}
+
+int main() {
+	// the pipeline's full colours, a pastel, a dimmed and a white preset, and black
+	const uint8_t presets[][2] = { { 255, 255 }, { 170, 200 }, { 255, 64 }, { 0, 255 }, { 255, 0 } };
+	// a single led, the desk light's segment lengths, a whole hue cycle, and a segment that wraps the hues twice
+	const uint16_t lengths[] = { 1, 39, 117, 255, 256, 257, PALETTE_MAX_LEDS };
+	for (const uint8_t* preset : presets) {
+		Led_Palette palette;
+		palette.begin(preset[0], preset[1]);
+		for (uint16_t hue = 0; hue < 256; hue++) {
+			CHECK(sameColor(palette.color((uint8_t)hue), hsvColor((uint8_t)hue, preset[0], preset[1])));
+		}
+		for (uint16_t numLeds : lengths) {
+			CHECK_EQUAL(compareSegment(palette, numLeds, preset[0], preset[1]), 0u);
+		}
+	}
+
+	// more leds lit than the segment has: a full bar, the leds after the segment untouched
+	Led_Palette palette;
+	palette.begin(255, 255);
+	Rgb expected[40 + 2 * PALETTE_GUARD];
+	Rgb rendered[40 + 2 * PALETTE_GUARD];
+	memset(expected, 0xa5, sizeof(expected));
+	memset(rendered, 0xa5, sizeof(rendered));
+	const Led_Segment segment = { PALETTE_GUARD, 40 };
+	hsvBar(expected, segment, 40, 250, 255, 255);
+	palette.fillBar(rendered, segment, 500, 250);
+	CHECK(memcmp(expected, rendered, sizeof(expected)) == 0);
+
+	testStrip();
+	return testResult("led_palette");
+}
@@ -0,0 +1,81 @@
+/*
+ Name:		test_pipeline.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The pipeline behind its interfaces: a tone from a Sample_Source has to light the segment of its band,
+ and the Led_Sink has to get one frame per hop with the leds the pipeline reports.
+*/
+
+#include <string.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Audio_Pipeline.h"
+#include "Pruned_Rfft.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+/** Class Frame_Recorder: keeps the last frame and counts them
+*/
+class Frame_Recorder : public Led_Sink {
+
+public:
+
+	Frame_Recorder() : frames(0), leds(Config::numLeds) {
+	}
+
+	void show(const Rgb* frame, uint16_t count) override {
+		leds.assign(frame, frame + count);
+		frames++;
+	}
+
+	uint32_t frames;
+	std::vector<Rgb> leds;
+};
+
+static bool isDark(const Rgb& led) {
+	return led.r == 0 && led.g == 0 && led.b == 0;
+}
+
+/* Run a tone through the pipeline, check which segments light up and that the frame shows what ledsOn() says
+*   band: index of the band the tone is in, its segment has to be the one lit furthest.
+*/
+static void checkTone(double frequency, uint8_t band) {
+	const uint32_t hops = 12;
+	Tone_Source source(testTone(frequency, 800, Config::sampleRate, Config::fftSize + (hops - 1) * Config::hopSize), Config::sampleRate);
+	Frame_Recorder sink;
+	Fft_Engine engine;
+	Pruned_Rfft spectrum(engine);
+	Audio_Pipeline<Config> pipeline(source, spectrum, sink);
+	CHECK(pipeline.begin(ANALYSIS_ENGINE::FFT, fftWindow, inputGain, goertzelFiltersPerBand));
+	pipeline.setMaxLevel(0, maxBass);
+	pipeline.setMaxLevel(1, maxMid);
+	pipeline.setMaxLevel(2, maxTreble);
+	while (!source.finished()) {
+		pipeline.process();
+	}
+
+	CHECK_EQUAL(pipeline.framesShown(), hops); // the first frame needs a full window, then one per hop
+	CHECK_EQUAL(sink.frames, hops);
+	for (uint8_t b = 0; b < Config::numBands; b++) {
+		const Led_Segment segment = Config::ledSegment(b);
+		const uint32_t lit = (uint32_t)pipeline.ledsOn(b) * 100 / segment.numLeds;
+		printf("%.0f Hz band %u: %u%% lit\n", frequency, b, lit);
+		if (b == band) {
+			CHECK(lit >= 50);
+		}
+		else {
+			CHECK(lit <= 10);
+		}
+		for (uint16_t i = 0; i < segment.numLeds; i++) {
+			CHECK_EQUAL(isDark(sink.leds[segment.firstLed + i]), i >= pipeline.ledsOn(b));
+		}
+	}
+}
+
+int main() {
+	checkTone(100, 0);
+	checkTone(700, 1);
+	checkTone(3000, 2);
+	return testResult("pipeline");
+}
@@ -0,0 +1,130 @@
+/*
+ Name:		test_pruned_rfft.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Pruned_Rfft against Full_Rfft and the exact transform, on random input and on tones, for all
+ FFT sizes and bin counts from one bin to all of them. The bounds are those of Pruned_Rfft.h:
+ - every value within PRUNED_MAX_DIFFERENCE of Full_Rfft,
+ - rms error against a double precision DFT (scaled and saturated like arm_rfft_q15) below PRUNED_MAX_RMS,
+   checked where there are enough values for an rms to mean something.
+ The rounding to q15 alone gives 1/sqrt(12) = 0.29 LSB rms, that is what Full_Rfft gets.
+*/
+
+#include <math.h>
+#include <random>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Fft_Engine.h"
+#include "Full_Rfft.h"
+#include "Pruned_Rfft.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define PRUNED_MAX_DIFFERENCE 1 // LSB
+#define PRUNED_MAX_RMS 0.55 // LSB, truncating the products instead of rounding them gets to 0.58
+#define PRUNED_RMS_MIN_BINS 16
+
+//! Bins 0 up to maxBin of the DFT with the scaling of arm_rfft_q15, saturated, in double precision
+static std::vector<double> exactBins(const std::vector<q15_t>& input, uint32_t maxBin) {
+	const uint32_t n = (uint32_t)input.size();
+	std::vector<double> cosine(n);
+	std::vector<double> sine(n);
+	for (uint32_t i = 0; i < n; i++) {
+		cosine[i] = cos(2 * M_PI * i / n);
+		sine[i] = sin(2 * M_PI * i / n);
+	}
+	std::vector<double> bins(2 * maxBin);
+	for (uint32_t k = 0; k < maxBin; k++) {
+		double re = 0;
+		double im = 0;
+		for (uint32_t i = 0, angle = 0; i < n; i++, angle = (angle + k) & (n - 1)) {
+			re += input[i] * cosine[angle];
+			im -= input[i] * sine[angle];
+		}
+		bins[2 * k] = fmin(fmax(re * 2 / n, -32768), 32767);
+		bins[2 * k + 1] = fmin(fmax(im * 2 / n, -32768), 32767);
+	}
+	return bins;
+}
+
+/* Both transforms of one input, checked against each other and the exact one
+*
+*/
+static void checkInput(Fft_Engine& engine, const std::vector<q15_t>& input, uint32_t maxBin, const char* name) {
+	const uint32_t n = (uint32_t)input.size();
+	Full_Rfft full(engine);
+	Pruned_Rfft pruned(engine);
+	CHECK(full.begin(n, maxBin));
+	CHECK(pruned.begin(n, maxBin));
+	std::vector<q15_t> fullBins(2 * maxBin);
+	std::vector<q15_t> prunedBins(2 * maxBin);
+	const std::vector<q15_t> original = input;
+	CHECK(full.transform(input.data(), fullBins.data()));
+	CHECK(pruned.transform(input.data(), prunedBins.data()));
+	CHECK(input == original); // the input isn't scratch
+
+	const std::vector<double> exact = exactBins(input, maxBin);
+	int maxDifference = 0;
+	double prunedError = 0;
+	double fullError = 0;
+	for (uint32_t i = 0; i < 2 * maxBin; i++) {
+		const int difference = abs(prunedBins[i] - fullBins[i]);
+		maxDifference = difference > maxDifference ? difference : maxDifference;
+		prunedError += (prunedBins[i] - exact[i]) * (prunedBins[i] - exact[i]);
+		fullError += (fullBins[i] - exact[i]) * (fullBins[i] - exact[i]);
+	}
+	const double prunedRms = sqrt(prunedError / (2 * maxBin));
+	const double fullRms = sqrt(fullError / (2 * maxBin));
+
+	bool passed = CHECK(maxDifference <= PRUNED_MAX_DIFFERENCE);
+	if (maxBin >= PRUNED_RMS_MIN_BINS) {
+		passed &= CHECK(prunedRms < PRUNED_MAX_RMS);
+		passed &= CHECK(fullRms < PRUNED_MAX_RMS);
+	}
+	if (!passed) {
+		fprintf(stderr, "  %s, %u points, %u bins (M = %u): max difference %d, rms pruned %.3f full %.3f\n",
+			name, n, maxBin, pruned.subSize(), maxDifference, prunedRms, fullRms);
+	}
+}
+
+//! Uniform random samples between -limit and limit
+static std::vector<q15_t> randomInput(std::mt19937& random, uint32_t count, int32_t limit) {
+	std::uniform_int_distribution<int32_t> value(-limit, limit);
+	std::vector<q15_t> samples(count);
+	for (q15_t& sample : samples) {
+		sample = (q15_t)value(random);
+	}
+	return samples;
+}
+
+int main() {
+	Fft_Engine engine;
+	std::mt19937 random(5);
+	const uint32_t sizes[] = { 64, 128, 256, 1024, 4096, 8192 };
+	for (uint32_t n : sizes) {
+		// one bin, the smallest sub-FFT, the sketch's share of the bins and all of them
+		const uint32_t maxBins[] = { 1, n / 8, n / 4 + 1, n / 2 };
+		for (uint32_t maxBin : maxBins) {
+			checkInput(engine, randomInput(random, n, 32767), maxBin, "full scale noise");
+			checkInput(engine, randomInput(random, n, 2047), maxBin, "noise at ADC level");
+			checkInput(engine, testTone(n / 8 + 0.37, 20000, n, n), maxBin, "off bin tone");
+			checkInput(engine, testTone(5, 26 * 1000, n, n), maxBin, "on bin tone with gain");
+			std::vector<q15_t> loud = testTone(3.5, 32767, n, n);
+			for (q15_t& sample : loud) {
+				sample = sample / 2 + 16383; // sine with a large DC offset, bin 0 close to saturation
+			}
+			checkInput(engine, loud, maxBin, "tone with DC");
+		}
+	}
+
+	// the sketch's transform
+	checkInput(engine, randomInput(random, Config::fftSize, 32767), Config::maxBin(), "sketch");
+
+	// 8192 points and 1024 bins cost the same with M = 1024 and 2048, the tie goes to the fewer sub-FFTs
+	Pruned_Rfft pruned(engine);
+	CHECK(pruned.begin(8192, 1024));
+	CHECK_EQUAL(pruned.subSize(), 2048u);
+	CHECK_EQUAL(pruned.subCount(), 4u);
+	return testResult("pruned_rfft");
+}
@@ -0,0 +1,96 @@
+/*
+ Name:		test_render.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The render simulation of desk_light_render as a test. Tones that switch between the bands and
+ pauses make the bars of the direct output jump by whole segments; the renderer at its own rate must not move
+ a bar further between two frames than the attack and decay of one render period allow, plus a led of rounding.
+ Also the render time against the period and the latest value slot between two threads.
+*/
+
+#include <math.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Render_Simulation.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define RENDER_PART_MS 400 // length of every part of the test signal
+
+//! Bass, pauses, mid, treble and all three at once, each RENDER_PART_MS long, twice over
+static std::vector<q15_t> testSignal() {
+	const double parts[][3] = { { 100, 0, 0 }, { 0, 0, 0 }, { 0, 1000, 0 }, { 100, 0, 0 }, { 0, 0, 8000 }, { 0, 0, 0 },
+		{ 100, 1000, 8000 }, { 0, 0, 0 } };
+	const uint32_t partSamples = Config::sampleRate / 1000 * RENDER_PART_MS;
+	std::vector<q15_t> samples;
+	for (uint32_t repeat = 0; repeat < 2; repeat++) {
+		for (const double* part : parts) {
+			std::vector<double> mixed(partSamples, 0);
+			for (uint8_t t = 0; t < 3; t++) {
+				if (part[t] > 0) {
+					const std::vector<q15_t> tone = testTone(part[t], 600, Config::sampleRate, partSamples);
+					for (uint32_t i = 0; i < partSamples; i++) {
+						mixed[i] += tone[i];
+					}
+				}
+			}
+			for (double value : mixed) {
+				samples.push_back((q15_t)value);
+			}
+		}
+	}
+	return samples;
+}
+
+//! Largest step a bar may take in one render period
+static uint32_t allowedStep(const Render_Options& options) {
+	const uint16_t fastest = options.envelope.attack > options.envelope.decay ? options.envelope.attack : options.envelope.decay;
+	return (uint32_t)ceil((double)fastest / options.renderRate) + 1;
+}
+
+/* One simulation at a render rate, the bars limited by the envelope of Desk_Light_Config.h
+*
+*/
+static void testRenderRate(const std::vector<q15_t>& signal, uint32_t renderRate) {
+	Tone_Source source(signal, Config::sampleRate);
+	const Render_Options options = { renderRate, { barAttack, barDecay, peakHoldMs, peakFall }, 1.0, (uint8_t)LED_EFFECT::VU_BARS };
+	Render_Report report;
+	CHECK(simulateRender(source, options, report));
+
+	const double seconds = (double)signal.size() / Config::sampleRate;
+	printf("%u Hz: %u analysis frames, %u render frames, max step direct %u rendered %u (allowed %u), moves direct %u rendered %u\n",
+		renderRate, report.analysisFrames, report.renderFrames, report.direct.maxStep, report.rendered.maxStep, allowedStep(options),
+		report.direct.moves, report.rendered.moves);
+	CHECK(report.analysisFrames > 0);
+	CHECK(fabs(report.renderFrames - seconds * renderRate) <= 2); // the render cadence doesn't depend on the hops
+
+	// the signal makes the direct bars jump, the rendered ones take small steps and move more often
+	CHECK(report.direct.maxStep > 2 * allowedStep(options));
+	CHECK(report.rendered.maxStep <= allowedStep(options));
+	CHECK(report.rendered.moves > report.direct.moves);
+	CHECK(report.rendered.meanStep < report.direct.meanStep);
+
+	// a render takes a fraction of its period, even on a loaded host
+	CHECK(Stage_Profiler::toMicros(report.renderTicks.p99) < 1e6 / renderRate);
+}
+
+int main() {
+	const std::vector<q15_t> signal = testSignal();
+	testRenderRate(signal, ledRenderRate);
+	testRenderRate(signal, 120);
+
+	// without attack and decay the renderer follows the analysis at once and jumps like the direct output
+	Tone_Source source(signal, Config::sampleRate);
+	const Render_Options immediate = { ledRenderRate, { 0, 0, peakHoldMs, peakFall }, 1.0, (uint8_t)LED_EFFECT::VU_BARS };
+	Render_Report report;
+	CHECK(simulateRender(source, immediate, report));
+	CHECK(report.rendered.maxStep > allowedStep({ ledRenderRate, { barAttack, barDecay, peakHoldMs, peakFall }, 1.0, 0 }));
+
+	uint64_t reads = 0;
+	uint64_t bad = 0;
+	stressSlot(200, reads, bad);
+	CHECK(reads > 0);
+	CHECK_EQUAL(bad, 0u);
+	return testResult("render");
+}
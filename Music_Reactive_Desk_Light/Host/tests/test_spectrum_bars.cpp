@@ -0,0 +1,155 @@
+/*
+ Name:		test_spectrum_bars.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Spectrum_Bars on both scales: every bin shared between the triangles of its two bars, the shares
+ adding up to 1 between the first and the last bar centre, a tone on a single bin lighting only the bars whose
+ filters reach that bin, a flat spectrum lighting every bar alike, and parameters out of range rejected without
+ touching the bars in use.
+*/
+
+#include <math.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Spectrum_Bars.h"
+#include "Test_Check.h"
+
+#define BARS_COUNT 117 // a bar per led
+#define BARS_LOW_EDGE 300 // deciHz
+#define BARS_MAX_BIN 1025 // 5 kHz at 40 kHz and 8192 points
+#define BARS_WEIGHT_ERROR (1.0f / 32768) // the weights are 16 bit
+
+//! Share of a bin in the triangle of a bar, from the centre below to the centre above
+static float triangle(const Spectrum_Bars& bars, uint16_t bar, uint32_t bin) {
+	const float low = BARS_LOW_EDGE / (Config::sampleRate * 10.0f / Config::fftSize);
+	const float below = bar > 0 ? bars.centreBin(bar - 1) : low;
+	const float centre = bars.centreBin(bar);
+	const float above = bar + 1 < bars.count() ? bars.centreBin(bar + 1) : BARS_MAX_BIN;
+	if (bin <= below || bin >= above) {
+		return 0;
+	}
+	return bin <= centre ? (bin - below) / (centre - below) : (above - bin) / (above - centre);
+}
+
+/* The shares of every bin: those of the triangles, 1 in total between the first and the last centre,
+*   at most 1 outside, never more than two bars, and those two neighbours
+*/
+static void testWeights(const Spectrum_Bars& bars) {
+	const uint32_t firstCentre = (uint32_t)ceilf(bars.centreBin(0));
+	const uint32_t lastCentre = (uint32_t)floorf(bars.centreBin(bars.count() - 1));
+	uint32_t wrongSums = 0;
+	uint32_t wrongBars = 0;
+	uint32_t wrongWeights = 0;
+	for (uint32_t k = 0; k < BARS_MAX_BIN + 2; k++) {
+		float sum = 0;
+		int32_t lowest = -1;
+		uint16_t barsOfBin = 0;
+		for (uint16_t bar = 0; bar < bars.count(); bar++) {
+			const float weight = bars.binWeight(bar, k);
+			if (weight > 0) {
+				lowest = lowest < 0 ? bar : lowest;
+				barsOfBin++;
+				wrongBars += bar > lowest + 1;
+			}
+			if (k < BARS_MAX_BIN && fabsf(weight - triangle(bars, bar, k)) > BARS_WEIGHT_ERROR) {
+				if (wrongWeights == 0) {
+					fprintf(stderr, "  bar %u, bin %u: weight %.5f, triangle %.5f\n", bar, k, weight, triangle(bars, bar, k));
+				}
+				wrongWeights++;
+			}
+			sum += weight;
+		}
+		wrongBars += barsOfBin > 2;
+		if (k >= firstCentre && k <= lastCentre) {
+			wrongSums += fabsf(sum - 1) > BARS_WEIGHT_ERROR;
+		}
+		else {
+			wrongSums += sum > 1 + BARS_WEIGHT_ERROR || (k >= BARS_MAX_BIN && sum != 0);
+		}
+	}
+	CHECK_EQUAL(wrongSums, 0u);
+	CHECK_EQUAL(wrongBars, 0u);
+	CHECK_EQUAL(wrongWeights, 0u);
+}
+
+/* A tone on the bin nearest the centre of every bar in turn
+*   Only the bars with a share of that bin may light, the bar itself always does.
+*/
+static void testTones(const Spectrum_Bars& bars) {
+	std::vector<q15_t> spectrum(2 * BARS_MAX_BIN, 0);
+	std::vector<uint8_t> levels(bars.count());
+	uint32_t wrong = 0;
+	for (uint16_t bar = 0; bar < bars.count(); bar++) {
+		const uint32_t bin = (uint32_t)lroundf(bars.centreBin(bar));
+		spectrum[2 * bin] = 4000;
+		bars.compute(spectrum.data(), levels.data());
+		spectrum[2 * bin] = 0;
+		bool right = levels[bar] > 0;
+		for (uint16_t other = 0; other < bars.count(); other++) {
+			right &= (levels[other] > 0) == (bars.binWeight(other, bin) > 0);
+			right &= levels[other] == 0 || (other + 1 >= bar && other <= bar + 1u);
+		}
+		if (!right) {
+			if (wrong == 0) {
+				fprintf(stderr, "  bar %u, bin %u: ", bar, bin);
+				for (uint16_t other = 0; other < bars.count(); other++) {
+					if (levels[other] > 0) {
+						fprintf(stderr, "%u=%u ", other, levels[other]);
+					}
+				}
+				fprintf(stderr, "\n");
+			}
+			wrong++;
+		}
+	}
+	CHECK_EQUAL(wrong, 0u);
+
+	// a flat spectrum: every bar the weighted mean of equal powers
+	for (uint32_t k = 0; k < BARS_MAX_BIN; k++) {
+		spectrum[2 * k] = 1000;
+	}
+	bars.compute(spectrum.data(), levels.data());
+	uint32_t different = 0;
+	for (uint16_t bar = 1; bar < bars.count(); bar++) {
+		different += abs(levels[bar] - levels[0]) > 1;
+	}
+	CHECK(levels[0] > 0 && levels[0] < 255);
+	CHECK_EQUAL(different, 0u);
+}
+
+int main() {
+	for (BAR_SPACING spacing : { BAR_SPACING::LOG, BAR_SPACING::MEL }) {
+		Spectrum_Bars bars;
+		CHECK(bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, BARS_COUNT, BARS_LOW_EDGE, spacing));
+		bars.setRange(16, 65536);
+		CHECK_EQUAL(bars.count(), BARS_COUNT);
+		uint32_t descending = 0;
+		for (uint16_t bar = 1; bar < bars.count(); bar++) {
+			descending += bars.centreBin(bar) < bars.centreBin(bar - 1) + 1;
+		}
+		CHECK_EQUAL(descending, 0u);
+		testWeights(bars);
+		testTones(bars);
+	}
+
+	// out of range: rejected, the bars of the last begin() stay
+	Spectrum_Bars bars;
+	CHECK(bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, 16, BARS_LOW_EDGE, BAR_SPACING::LOG));
+	const float centre = bars.centreBin(5);
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, SPECTRUM_BARS_MAX + 1, BARS_LOW_EDGE, BAR_SPACING::LOG));
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, 0, BARS_LOW_EDGE, BAR_SPACING::LOG));
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, 16, 60000, BAR_SPACING::LOG)); // low edge of 6 kHz above the top
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, 16, 50049, BAR_SPACING::LOG)); // just above the top bin
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, Config::fftSize / 2 + 2, 16, BARS_LOW_EDGE, BAR_SPACING::LOG));
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, 1, 16, BARS_LOW_EDGE, BAR_SPACING::LOG));
+	CHECK(!bars.begin(Config::sampleRate, Config::fftSize, BARS_MAX_BIN, 16, BARS_LOW_EDGE, BAR_SPACING::COUNT));
+	CHECK(!bars.begin(0, Config::fftSize, BARS_MAX_BIN, 16, BARS_LOW_EDGE, BAR_SPACING::LOG));
+	CHECK_EQUAL(bars.count(), 16u);
+	CHECK(bars.centreBin(5) == centre);
+
+	// the limits themselves are fine
+	CHECK(bars.begin(Config::sampleRate, Config::fftSize, Config::fftSize / 2 + 1, SPECTRUM_BARS_MAX, BARS_LOW_EDGE, BAR_SPACING::MEL));
+	CHECK_EQUAL(bars.count(), (uint16_t)SPECTRUM_BARS_MAX);
+	return testResult("spectrum_bars");
+}
@@ -0,0 +1,137 @@
+/*
+ Name:		test_spsc_ring.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Spsc_Ring with a producer and a consumer thread running flat out. The items are numbered and carry
+ a check word, so the consumer sees a torn item, a repeat or an item out of order. Chunk sizes on both sides are
+ random and a small ring makes the indices wrap all the time. Without drops every item has to arrive once and in
+ order, with drops every gap has to be counted by itemsDropped().
+*/
+
+#include <stdint.h>
+#include <atomic>
+#include <random>
+#include <thread>
+#include "Spsc_Ring.h"
+#include "Test_Check.h"
+
+#define RING_CAPACITY 64
+#define RING_MAX_CHUNK 80 // more than the ring holds, so a write can fill it up
+#define RING_ITEMS 4000000
+
+//! A numbered item, check is derived from the number so a half copied item shows
+struct Ring_Item {
+	uint32_t number;
+	uint32_t check;
+};
+
+static Ring_Item makeItem(uint32_t number) {
+	Ring_Item item = { number, number * 2654435761u ^ 0x5a5a5a5au };
+	return item;
+}
+
+//! What the consumer saw
+struct Ring_Run {
+	uint32_t received;
+	uint32_t missing; // items skipped by the numbers
+	uint32_t torn; // items whose check word doesn't match
+	uint32_t backwards; // items with a number not above the previous one
+};
+
+/* Producer and consumer threads, RING_ITEMS items in random chunks
+*   lossless: the producer retries what didn't fit, otherwise it moves on and the ring drops it.
+*/
+static Ring_Run runRing(Spsc_Ring<Ring_Item, RING_CAPACITY>& ring, bool lossless, uint32_t seed) {
+	std::atomic<bool> producing(true);
+	std::thread producer([&]() {
+		std::mt19937 random(seed);
+		std::uniform_int_distribution<uint32_t> chunkSize(1, RING_MAX_CHUNK);
+		Ring_Item chunk[RING_MAX_CHUNK];
+		uint32_t next = 0;
+		while (next < RING_ITEMS) {
+			uint32_t count = chunkSize(random);
+			count = count < RING_ITEMS - next ? count : RING_ITEMS - next;
+			for (uint32_t i = 0; i < count; i++) {
+				chunk[i] = makeItem(next + i);
+			}
+			const uint32_t stored = ring.write(chunk, count);
+			next += lossless ? stored : count;
+			if (!lossless || stored == 0) {
+				std::this_thread::yield(); // lossy: give the consumer a chance, so only some chunks are dropped
+			}
+		}
+		producing.store(false, std::memory_order_release);
+	});
+
+	Ring_Run run = {};
+	std::mt19937 random(seed + 1);
+	std::uniform_int_distribution<uint32_t> chunkSize(1, RING_CAPACITY);
+	Ring_Item chunk[RING_CAPACITY];
+	uint32_t expected = 0;
+	while (true) {
+		// the producer's flag first: once it is down, what is still in the ring is all that is left
+		const bool done = !producing.load(std::memory_order_acquire);
+		const uint32_t want = chunkSize(random);
+		uint32_t count;
+		if (want & 1) {
+			count = ring.read(chunk, want);
+		}
+		else {
+			count = ring.readBlock(chunk, want) ? want : 0;
+			if (count == 0 && done) {
+				count = ring.read(chunk, want);
+			}
+		}
+		if (count == 0) {
+			if (done) {
+				break;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+		for (uint32_t i = 0; i < count; i++) {
+			const Ring_Item& item = chunk[i];
+			if (item.check != makeItem(item.number).check) {
+				run.torn++;
+				continue;
+			}
+			if (item.number < expected) {
+				run.backwards++;
+				continue;
+			}
+			run.missing += item.number - expected;
+			expected = item.number + 1;
+		}
+		run.received += count;
+	}
+	producer.join();
+	run.missing += RING_ITEMS - expected; // dropped after the last one received
+	return run;
+}
+
+int main() {
+	static Spsc_Ring<Ring_Item, RING_CAPACITY> ring;
+
+	// lossless: everything arrives once and in order, the parts of a chunk that didn't fit are written again
+	const Ring_Run lossless = runRing(ring, true, 1);
+	CHECK_EQUAL(lossless.received, (uint32_t)RING_ITEMS);
+	CHECK_EQUAL(lossless.missing, 0u);
+	CHECK_EQUAL(lossless.torn, 0u);
+	CHECK_EQUAL(lossless.backwards, 0u);
+	CHECK_EQUAL(ring.itemsWritten(), (uint32_t)RING_ITEMS);
+	CHECK(ring.maxFill() <= RING_CAPACITY);
+	CHECK_EQUAL(ring.available(), 0u);
+
+	// lossy: the producer doesn't write again what didn't fit, the gaps are exactly the items dropped
+	ring.resetCounters();
+	const Ring_Run lossy = runRing(ring, false, 2);
+	printf("lossy: %u received, %u dropped in %u overruns\n", lossy.received, ring.itemsDropped(), ring.overruns());
+	CHECK(ring.itemsDropped() > 0);
+	CHECK_EQUAL(lossy.missing, ring.itemsDropped());
+	CHECK_EQUAL(lossy.received, ring.itemsWritten());
+	CHECK_EQUAL(lossy.received + lossy.missing, (uint32_t)RING_ITEMS);
+	CHECK_EQUAL(lossy.torn, 0u);
+	CHECK_EQUAL(lossy.backwards, 0u);
+	return testResult("spsc_ring");
+}
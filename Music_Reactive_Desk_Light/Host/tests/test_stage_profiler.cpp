@@ -0,0 +1,149 @@
+/*
+ Name:		test_stage_profiler.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Stage_Profiler statistics from known durations: a few, a full ring, and rings written well
+ past STAGE_PROFILER_SAMPLES so only the latest durations count. The percentiles are nearest rank, the value
+ at ceil(p * count) - 1 of the sorted durations, checked by hand and against std::sort of random durations.
+*/
+
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Stage_Profiler.h"
+#include "Test_Check.h"
+
+//! Statistics as Stage_Profiler::stats() defines them, from the durations still in the ring
+static Stage_Stats expectedStats(const std::vector<uint32_t>& recorded) {
+	const size_t count = recorded.size() < STAGE_PROFILER_SAMPLES ? recorded.size() : STAGE_PROFILER_SAMPLES;
+	std::vector<uint32_t> kept(recorded.end() - count, recorded.end());
+	std::sort(kept.begin(), kept.end());
+	Stage_Stats stats = { (uint32_t)count, 0, 0, 0, 0 };
+	if (count > 0) {
+		stats.min = kept.front();
+		stats.p50 = kept[(count * 50 + 99) / 100 - 1];
+		stats.p99 = kept[(count * 99 + 99) / 100 - 1];
+		stats.max = kept.back();
+	}
+	return stats;
+}
+
+//! Compare two sets of statistics
+static bool checkStats(const Stage_Stats& actual, const Stage_Stats& expected) {
+	bool same = CHECK_EQUAL(actual.count, expected.count);
+	same &= CHECK_EQUAL(actual.min, expected.min);
+	same &= CHECK_EQUAL(actual.p50, expected.p50);
+	same &= CHECK_EQUAL(actual.p99, expected.p99);
+	same &= CHECK_EQUAL(actual.max, expected.max);
+	return same;
+}
+
+/* Known durations in shuffled order
+*
+*/
+static void testKnown() {
+	std::mt19937 random(16);
+	Stage_Profiler profiler;
+	profiler.begin();
+	checkStats(profiler.stats(PIPELINE_STAGE::FFT), { 0, 0, 0, 0, 0 });
+
+	// 1 to 10: the median is the 5th, p99 the 10th
+	std::vector<uint32_t> durations;
+	for (uint32_t d = 1; d <= 10; d++) {
+		durations.push_back(d);
+	}
+	std::shuffle(durations.begin(), durations.end(), random);
+	for (uint32_t d : durations) {
+		profiler.record(PIPELINE_STAGE::FFT, d);
+	}
+	checkStats(profiler.stats(PIPELINE_STAGE::FFT), { 10, 1, 5, 10, 10 });
+	checkStats(profiler.stats(PIPELINE_STAGE::BANDS), { 0, 0, 0, 0, 0 }); // the stages have their own rings
+
+	// a full ring of 10 to 2560 in steps of 10: the 128th and the 254th
+	profiler.begin();
+	durations.clear();
+	for (uint32_t d = 1; d <= STAGE_PROFILER_SAMPLES; d++) {
+		durations.push_back(10 * d);
+	}
+	std::shuffle(durations.begin(), durations.end(), random);
+	for (uint32_t d : durations) {
+		profiler.record(PIPELINE_STAGE::SHOW, d);
+	}
+	checkStats(profiler.stats(PIPELINE_STAGE::SHOW), { 256, 10, 1280, 2540, 2560 });
+
+	// 1000 durations, a slow start of 744 long ones and then 1 to 256: the long ones are overwritten
+	profiler.begin();
+	std::vector<uint32_t> recorded;
+	for (uint32_t d = 0; d < 1000 - STAGE_PROFILER_SAMPLES; d++) {
+		recorded.push_back(1000000 + d);
+	}
+	durations.clear();
+	for (uint32_t d = 1; d <= STAGE_PROFILER_SAMPLES; d++) {
+		durations.push_back(d);
+	}
+	std::shuffle(durations.begin(), durations.end(), random);
+	recorded.insert(recorded.end(), durations.begin(), durations.end());
+	for (uint32_t d : recorded) {
+		profiler.record(PIPELINE_STAGE::FRAME, d);
+	}
+	CHECK_EQUAL(profiler.recorded(PIPELINE_STAGE::FRAME), 1000u);
+	checkStats(profiler.stats(PIPELINE_STAGE::FRAME), { 256, 1, 128, 254, 256 });
+
+	// one more long one replaces the oldest of the short ones, not the newest or a random one
+	profiler.record(PIPELINE_STAGE::FRAME, 5000);
+	recorded.push_back(5000);
+	checkStats(profiler.stats(PIPELINE_STAGE::FRAME), expectedStats(recorded));
+	CHECK_EQUAL(profiler.stats(PIPELINE_STAGE::FRAME).min, durations[0] == 1 ? 2u : 1u);
+
+	// paused, nothing is recorded
+	profiler.setEnabled(false);
+	profiler.record(PIPELINE_STAGE::FRAME, 9000000);
+	CHECK_EQUAL(profiler.recorded(PIPELINE_STAGE::FRAME), 1001u);
+	profiler.setEnabled(true);
+	CHECK_EQUAL(profiler.stats(PIPELINE_STAGE::FRAME).max, 5000u);
+
+	// begin() clears all stages
+	profiler.begin();
+	CHECK_EQUAL(profiler.recorded(PIPELINE_STAGE::FRAME), 0u);
+	checkStats(profiler.stats(PIPELINE_STAGE::FRAME), { 0, 0, 0, 0, 0 });
+}
+
+/* Random durations and counts against std::sort, counts up to well past the ring size
+*
+*/
+static void testRandom() {
+	std::mt19937 random(1);
+	std::uniform_int_distribution<uint32_t> duration(0, 0xffffffff);
+	std::uniform_int_distribution<uint32_t> length(1, 3 * STAGE_PROFILER_SAMPLES);
+	Stage_Profiler profiler;
+	uint32_t wrong = 0;
+	for (uint32_t round = 0; round < 200; round++) {
+		profiler.begin();
+		std::vector<uint32_t> recorded(length(random));
+		for (uint32_t& d : recorded) {
+			d = round % 2 ? duration(random) : duration(random) % 64; // many equal durations every other round
+			profiler.record(PIPELINE_STAGE::COPY, d);
+		}
+		if (!checkStats(profiler.stats(PIPELINE_STAGE::COPY), expectedStats(recorded))) {
+			fprintf(stderr, "  round %u, %u durations\n", round, (unsigned)recorded.size());
+			wrong++;
+		}
+	}
+	CHECK_EQUAL(wrong, 0u);
+}
+
+int main() {
+	testKnown();
+	testRandom();
+
+	// lap() records the time since its start and returns the start of the next stage
+	Stage_Profiler profiler;
+	profiler.begin();
+	const uint32_t start = Stage_Profiler::now() - 5 * Stage_Profiler::ticksPerSecond() / 1000; // 5 ms ago
+	const uint32_t next = profiler.lap(PIPELINE_STAGE::BANDS, start);
+	const Stage_Stats bands = profiler.stats(PIPELINE_STAGE::BANDS);
+	CHECK_EQUAL(bands.count, 1u);
+	CHECK(bands.max >= 5 * Stage_Profiler::ticksPerSecond() / 1000 && bands.max == next - start);
+	return testResult("stage_profiler");
+}
@@ -0,0 +1,110 @@
+/*
+ Name:		test_stft.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Stft on a tone written in blocks that don't line up with the hops. Every spectrum has to peak
+ at the bin of the tone and be the same to the value as a windowed FFT of the last fftSize samples in time
+ order, so the ring buffer, the DC removal from its running sum and the hop counting are all checked.
+*/
+
+#include <math.h>
+#include <vector>
+#include "Desk_Light_Config.h"
+#include "Full_Rfft.h"
+#include "Stft.h"
+#include "Test_Check.h"
+#include "Test_Signals.h"
+
+#define STFT_TONE_BIN 307 // 1499 Hz at 40 kHz, on a bin
+#define STFT_BIAS 2048 // the DC level of the ADC
+#define STFT_BLOCK 1000 // samples per write, not a multiple of the hop
+#define STFT_HOPS 6 // spectra after the first window
+
+//! Strongest bin of a spectrum of Fft_Engine::rfft layout
+static uint32_t peakBin(const q15_t* spectrum, uint32_t bins) {
+	uint32_t peak = 0;
+	int64_t peakPower = -1;
+	for (uint32_t k = 0; k < bins; k++) {
+		const int64_t power = (int64_t)spectrum[2 * k] * spectrum[2 * k] + (int64_t)spectrum[2 * k + 1] * spectrum[2 * k + 1];
+		if (power > peakPower) {
+			peakPower = power;
+			peak = k;
+		}
+	}
+	return peak;
+}
+
+/* The window ending at a sample, conditioned and transformed directly
+*   The mean of the window as the bias, like Stft.
+*/
+static std::vector<q15_t> directSpectrum(const std::vector<q15_t>& samples, uint32_t end, Fft_Backend& fft, const Fft_Window& window) {
+	const uint32_t first = end - Config::fftSize;
+	int32_t sum = 0;
+	for (uint32_t i = first; i < end; i++) {
+		sum += samples[i];
+	}
+	std::vector<q15_t> frame(Config::fftSize);
+	window.apply(&samples[first], frame.data(), 0, Config::fftSize, (q15_t)(sum / (int32_t)Config::fftSize));
+	std::vector<q15_t> spectrum(2 * Config::maxBin());
+	CHECK(fft.transform(frame.data(), spectrum.data()));
+	return spectrum;
+}
+
+int main() {
+	std::vector<q15_t> samples = testTone(STFT_TONE_BIN * (double)Config::sampleRate / Config::fftSize, 600, Config::sampleRate,
+		Config::fftSize + STFT_HOPS * Config::hopSize + 300);
+	for (q15_t& sample : samples) {
+		sample += STFT_BIAS;
+	}
+
+	Fft_Engine engine;
+	Full_Rfft stftFft(engine);
+	Stft stft(stftFft);
+	CHECK(!stft.begin(Config::fftSize, 0, Config::maxBin()));
+	CHECK(!stft.begin(Config::fftSize, Config::fftSize + 1, Config::maxBin()));
+	CHECK(stft.begin(Config::fftSize, Config::hopSize, Config::maxBin(), fftWindow));
+	stft.setGain(inputGain);
+	CHECK_EQUAL(stft.maxBin(), (uint32_t)Config::maxBin());
+
+	Full_Rfft directFft(engine);
+	CHECK(directFft.begin(Config::fftSize, Config::maxBin()));
+	Fft_Window window;
+	CHECK(window.begin(Config::fftSize, fftWindow));
+	window.setGain(inputGain);
+
+	uint32_t written = 0;
+	uint32_t mismatches = 0;
+	uint32_t wrongPeaks = 0;
+	while (written < samples.size()) {
+		uint32_t count = (uint32_t)samples.size() - written < STFT_BLOCK ? (uint32_t)samples.size() - written : STFT_BLOCK;
+		while (count > 0) {
+			const uint32_t used = stft.write(&samples[written], count);
+			written += used;
+			count -= used;
+			const bool due = written >= Config::fftSize && written % Config::hopSize == 0;
+			if (!CHECK_EQUAL(stft.available(), due)) {
+				fprintf(stderr, "  after %u samples\n", written);
+			}
+			if (stft.available()) {
+				const q15_t* spectrum = stft.spectrum();
+				CHECK(!stft.available());
+				wrongPeaks += peakBin(spectrum, stft.maxBin()) != STFT_TONE_BIN;
+				const std::vector<q15_t> direct = directSpectrum(samples, written, directFft, window);
+				uint32_t different = 0;
+				for (uint32_t i = 0; i < direct.size(); i++) {
+					different += spectrum[i] != direct[i];
+				}
+				if (different > 0) {
+					fprintf(stderr, "  spectrum after %u samples: %u values differ\n", written, different);
+					mismatches++;
+				}
+			}
+		}
+	}
+	printf("%u spectra, peak at bin %u\n", stft.frames(), STFT_TONE_BIN);
+	CHECK_EQUAL(stft.frames(), (uint32_t)STFT_HOPS + 1);
+	CHECK_EQUAL(wrongPeaks, 0u);
+	CHECK_EQUAL(mismatches, 0u);
+	return testResult("stft");
+}
@@ -0,0 +1,124 @@
+/*
+ Name:		test_telemetry.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Telemetry loopback: Telemetry_Writer into a port that feeds Telemetry_Decoder. The port takes a
+ random number of bytes per pump and often writes fewer than it offered, like a serial port whose buffer fills
+ up in between. Every frame the writer queued has to come out of the decoder whole, in order and with its payload;
+ frames the full queue dropped have to show up as lost, and there must be no crc errors.
+*/
+
+#include <string.h>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include "Telemetry_Writer.h"
+#include "Telemetry_Decoder.h"
+#include "Test_Check.h"
+
+#define LOOPBACK_FRAMES 3000
+
+/** Class Loopback_Port: a port with little room that writes short, straight into a decoder
+*/
+class Loopback_Port : public Telemetry_Port {
+
+public:
+
+	Loopback_Port(Telemetry_Decoder& decoder, uint32_t seed) : decoder(decoder), random(seed), received(), short_writes(0) {
+	}
+
+	uint32_t writable() override {
+		return std::uniform_int_distribution<uint32_t>(0, 200)(random);
+	}
+
+	uint32_t write(const uint8_t* data, uint32_t count) override {
+		uint32_t taken = count;
+		if (std::uniform_int_distribution<uint32_t>(0, 3)(random) == 0) {
+			taken = std::uniform_int_distribution<uint32_t>(0, count)(random); // the buffer filled up in between
+			short_writes += taken < count;
+		}
+		for (uint32_t i = 0; i < taken; i++) {
+			if (decoder.push(data[i])) {
+				received.push_back(decoder.message());
+			}
+		}
+		return taken;
+	}
+
+	//! Writes that took fewer bytes than offered
+	uint32_t shortWrites() const { return short_writes; }
+
+	Telemetry_Decoder& decoder;
+	std::mt19937 random;
+	std::vector<Telemetry_Message> received;
+
+private:
+	uint32_t short_writes;
+};
+
+int main() {
+	Telemetry_Writer writer;
+	Telemetry_Decoder decoder;
+	Loopback_Port port(decoder, 7);
+	std::mt19937 random(3);
+	std::uniform_int_distribution<uint32_t> length(0, TELEMETRY_MAX_PAYLOAD);
+	std::uniform_int_distribution<uint32_t> byte(0, 255);
+
+	// raw payloads of any length, a third of the bytes 0 so COBS has runs of every kind, and band levels
+	std::deque<Telemetry_Message> queued;
+	for (uint32_t f = 0; f < LOOPBACK_FRAMES; f++) {
+		Telemetry_Message message;
+		if (f % 4 == 3) {
+			const q31_t levels[3] = { (q31_t)(f * 1000), 0, -(q31_t)f };
+			message.type = TELEMETRY_TYPE::BANDS;
+			const Telemetry_Frame_Header header = { f, 3 };
+			message.payload.resize(sizeof(header) + sizeof(levels));
+			memcpy(message.payload.data(), &header, sizeof(header));
+			memcpy(message.payload.data() + sizeof(header), levels, sizeof(levels));
+			if (writer.sendBands(f, levels, 3)) {
+				queued.push_back(message);
+			}
+		}
+		else {
+			message.type = TELEMETRY_TYPE::SPECTRUM;
+			message.payload.resize(length(random));
+			for (uint8_t& value : message.payload) {
+				value = byte(random) % 3 == 0 ? 0 : (uint8_t)byte(random);
+			}
+			if (writer.send(message.type, message.payload.data(), (uint32_t)message.payload.size())) {
+				queued.push_back(message);
+			}
+		}
+		if (f % 3 == 0) {
+			writer.pump(port); // slower than the frames come, so the queue fills up now and then
+		}
+	}
+	for (uint32_t i = 0; i < 100000 && writer.queued() > 0; i++) {
+		writer.pump(port);
+	}
+	printf("%u frames queued, %u dropped, %u received, %u short writes\n", writer.framesSent(), writer.framesDropped(),
+		(unsigned)port.received.size(), port.shortWrites());
+
+	CHECK_EQUAL(writer.queued(), 0u);
+	CHECK(port.shortWrites() > 0);
+	CHECK(writer.framesDropped() > 0);
+	CHECK_EQUAL(decoder.errors(), 0u);
+	CHECK_EQUAL(decoder.frames(), (uint32_t)queued.size());
+	CHECK_EQUAL(decoder.lost(), writer.framesDropped());
+	CHECK_EQUAL(port.received.size(), queued.size());
+
+	uint32_t mismatches = 0;
+	for (size_t i = 0; i < port.received.size() && i < queued.size(); i++) {
+		const Telemetry_Message& got = port.received[i];
+		mismatches += got.type != queued[i].type || got.payload != queued[i].payload;
+	}
+	CHECK_EQUAL(mismatches, 0u);
+
+	// the first band frame is frame 3, nothing was dropped before it: type, sequence, frame and the levels
+	std::string line;
+	CHECK(port.received.size() > 3 && telemetryCsv(port.received[3], line));
+	CHECK(line == "bands,3,3,3000,0,-3");
+	return testResult("telemetry");
+}
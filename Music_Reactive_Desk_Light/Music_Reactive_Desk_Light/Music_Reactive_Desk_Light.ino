@@ -15,77 +15,106 @@
 #include <ADC.h>
 #include "math.h"
 #include "My_ADC.h"
-#include <list>
+#include "Spsc_Ring.h"
+#include "Fft_Engine.h"
+#include "src/Full_Rfft.h"
+#include "src/Sample_Source.h"
+#include "src/Led_Sink.h"
+#include "src/Audio_Pipeline.h"
+#include "src/Led_Renderer.h"
+#include "src/Desk_Light_Config.h"
+#include "Telemetry_Writer.h"
+#include "src/Command_Channel.h"
 
 /*
 * ADC variables and definitions
 */
 #define ADC_IR_Priority 64 // interrupt priority
-#define N_SAMPLES 8192 // number of samples
+#define ADC_BLOCK_SIZE 256 // samples per DMA block, one interrupt per block
 
-void readAdc(void);
+void readAdc(volatile uint16_t* block, uint16_t blockSize);
+void sendFrameTelemetry();
+void sendCounters();
+void pollCommands();
 
 My_ADC ADC0(0);
-short samples[N_SAMPLES];
-int sampleCounter = 0;
-bool samplesReady = false; // 8192 points have been sampled, ready to be processed by FFT
+Spsc_Ring<q15_t, 4 * Config::hopSize> sampleRing; // the only link between the ADC interrupt and the analysis, 102.4 ms of samples
+DMAMEM __attribute__((aligned(32))) uint16_t adcBlocks[2 * ADC_BLOCK_SIZE]; // written by the DMA
 
 /*
-* FFT and LED variables and definitions
+* LED variables and definitions
 */
-#define numLeds 117
-#define numLedsBy3 39 // number of leds divided by 3
-#define numLedsBy3By3 13 // number of leds divided by 9
-#define numLedsLowLimit 4 // If less than 5 leds are on in a region, that region of sound is considered to be quiet.
 #define dataPin 14
 #define sampleBias 1522 // the DC bias of the microphone, 1.25 V
-#define maxPeak 1240 // Max peak AC signal, 1 V
-#define sqrt_2 1.4142 // square root of 2
-#define bassUpper 2500 // bass upper frequency in deciHz
-#define midUpper 15000 // mid upper frequency in deciHz
-#define trebleUpper 50000 // treble upper frequency in deciHz
-#define fundamentalFreq 71 // fundamental frequency in deciHz
-#define numRecordedLedValues 60
 
-CRGB leds[numLeds];
-q31_t bassAmplitude;
-q31_t midAmplitude;
-q31_t trebleAmplitude;
-short bassLedsOn; // number of leds that are turned on in the bass range
-short midLedsOn; // number of leds that are turned on in the bass range
-short trebleLedsOn; // number of leds that are turned on in the bass range
+/*
+* Pipeline stages on the Teensy: samples from the ADC ring buffer, frames to the led strip
+*/
+class Adc_Source : public Sample_Source {
+public:
+    uint32_t read(q15_t* samples, uint32_t count) override { return sampleRing.read(samples, count); }
+    uint32_t sampleRate() const override { return ADC0.getTimerFrequency(); } // the timer can only divide the bus clock
+    uint32_t samplesDropped() const override { return sampleRing.itemsDropped(); }
+    uint32_t overruns() const override { return sampleRing.overruns(); }
+};
+
+class Strip_Sink : public Led_Sink {
+public:
+    void show(const Rgb*, uint16_t) override { FastLED.show(); } // FastLED drives the renderer's led frame directly
+    void repeat(const Rgb*, uint16_t) override {} // the strip holds the last frame, the serial DMA stays free
+    void setBrightness(uint8_t brightness) override { FastLED.setBrightness(brightness); }
+};
+
+Adc_Source adcSource;
+Strip_Sink stripSink;
+Fft_Engine fft; // keeps the plan of the transform
+Full_Rfft spectrum(fft); // the 8192 point CMSIS transform, Pruned_Rfft only estimates 8 % less work here and isn't timed on the Teensy yet
+Audio_Pipeline<Config> pipeline(adcSource, spectrum, stripSink);
 
-int maxBass = 2000000; // max bass amplitude
-int maxMid = 4000000; // max mid amplitude
-int maxTreble = 4000000; // max treble amplitude
+/*
+* The leds are rendered at their own rate, the bars glide between the analysis frames
+*/
+#define RENDER_PERIOD_US (1000000 / ledRenderRate)
 
-q15_t fftSamples[N_SAMPLES];
-q15_t fftOutput[N_SAMPLES * 2];
-q15_t frequencies[N_SAMPLES];
+Led_Renderer<Config> renderer(pipeline.bandFrames(), stripSink);
+uint32_t lastRender = 0;
 
-q31_t bassReal; // sum of real components in the bass frequency range
-q31_t bassImaginary; // sum of imaginary components in the bass frequency range
-q31_t midReal; // sum of real components in the mid frequency range
-q31_t midImaginary; // sum of imaginary components in the mid frequency range
-q31_t trebleReal; // sum of real components in the treble frequency range
-q31_t trebleImaginary; // sum of imaginary components in the treble frequency range
+/*
+* Telemetry, binary frames over the USB serial port (see Telemetry_Protocol.h of libraries/Desk_Light_Common), decoded by desk_light_telemetry
+*/
+#define TELEMETRY_INTERVAL_MS 5000 // time between two records of the frame counters
+#define TELEMETRY_SPECTRUM_DECIMATION 16 // bins per magnitude in the spectrum frames, 1 for the full spectrum
+
+class Serial_Port : public Telemetry_Port {
+public:
+    uint32_t writable() override { return Serial.availableForWrite(); }
+    uint32_t write(const uint8_t* data, uint32_t count) override { return Serial.write(data, count); }
+};
 
-q31_t bass[2]; // sum of real and sum of imaginary components in the bass frequency range
-q31_t mid[2]; // sum of real and sum of imaginary components in the mid frequency range
-q31_t treble[2]; // sum of real and sum of imaginary components in the treble frequency range
+Serial_Port serialPort;
+Telemetry_Writer telemetry; // frames wait here until the serial port takes them, the loop never blocks on the port
+uint32_t lastTelemetry = 0;
+uint16_t telemetrySequence = 0;
 
-double average;
-double rms;
-double peak;
+/*
+* Tuning commands from the USB serial port, see src/Command_Channel.h for the commands
+*/
+class Serial_Input : public Command_Input {
+public:
+    int read() override { return Serial.read(); } // -1 when nothing has arrived
+};
 
-arm_rfft_instance_q15 fftInstance;
+Serial_Input serialInput;
+Command_Channel commands;
 
 void setup() {
+    Serial.begin(115200);
     pinMode(A1, INPUT);
     pinMode(dataPin, OUTPUT);
 
-    LEDS.addLeds<WS2812SERIAL, dataPin, RGB>(leds, numLeds);
-    LEDS.setBrightness(84);
+    LEDS.addLeds<WS2812SERIAL, dataPin, RGB>(renderer.ledFrame(), Config::numLeds);
+    LEDS.setBrightness(ledBrightness);
+    LEDS.setDither(DISABLE_DITHER); // unchanged frames aren't sent, temporal dithering would freeze on them
 
     // setup the ADC
     ADC0.setReference(ADC_REFERENCE::REF_3V3);
@@ -96,200 +125,108 @@ void setup() {
     ADC0.recalibrate();
 
     ADC0.setOffset(sampleBias, true); // remove sample bias from ADC result
-    ADC0.enableInterrupts(readAdc, ADC_IR_Priority);
-    ADC0.startContinuous(A1);
+    ADC0.startStream(A1, Config::sampleRate, adcBlocks, ADC_BLOCK_SIZE, readAdc, ADC_IR_Priority);
+
+    pipeline.begin(analysisEngine, fftWindow, inputGain, goertzelFiltersPerBand);
+    Pipeline_Params params = pipeline.params(); // the start values, the command channel changes them later
+    params.maxLevels[0] = maxBass;
+    params.maxLevels[1] = maxMid;
+    params.maxLevels[2] = maxTreble;
+    params.brightness = ledBrightness;
+    pipeline.setParams(params);
+    pipeline.setLedOutput(false); // the renderer shows the leds
+
+    const Led_Envelope envelope = { barAttack, barDecay, peakHoldMs, peakFall };
+    renderer.begin((uint32_t)((uint64_t)Config::hopSize * 1000000 / adcSource.sampleRate()), envelope);
+    lastRender = micros();
 }
 
 void loop() {
-    // long micros1, micros2;
-    // micros1 = micros();
-    // Sample window = 75.4 ms, fundamental frequency 13.3 Hz (4 readings)
-    // Sample window = 150.7 ms, fundamental frequency 6.63 Hz (8 readings)
-    if (sampleCounter == N_SAMPLES - 1) {
-        // ADC0.stopContinuous();
-        sampleCounter = 0;
-
-        // copy samples over to fft array
-        for (int i = 0; i < N_SAMPLES; i++) {
-            fftSamples[i] = samples[i];
-        }
-
-        arm_rfft_init_q15(&fftInstance, N_SAMPLES, 0, 1);
-        arm_rfft_q15(&fftInstance, fftSamples, fftOutput); // Q13.3 output format
-
-        // Add up fft real and complex magnitudes for base frequencies, < 300 Hz
-        int iFFT; // counter
-        bass[0] = 0;
-        bass[1] = 0;
-        mid[0] = 0;
-        mid[1] = 0;
-        treble[0] = 0;
-        treble[1] = 0;
-        for (iFFT = 2; (iFFT >> 1) * fundamentalFreq < bassUpper; iFFT += 2) {
-            bass[0] += abs(fftOutput[iFFT]);
-            bass[1] += abs(fftOutput[iFFT + 1]);
-        }
-
-        // Add up fft real and complex magnitudes for midrange frequencies, [300, 1500] Hz
-        for (iFFT; (iFFT >> 1) * fundamentalFreq < midUpper; iFFT += 2) {
-            mid[0] += abs(fftOutput[iFFT]);
-            mid[1] += abs(fftOutput[iFFT + 1]);
-        }
-
-        // Add up fft real and complex magnitudes for treble frequencies, [1500, 5000] Hz
-        for (iFFT; (iFFT >> 1) * fundamentalFreq < trebleUpper; iFFT += 2) {
-            treble[0] += abs(fftOutput[iFFT]);
-            treble[1] += abs(fftOutput[iFFT + 1]);
-        }
-        bass[0] <<= 8;
-        bass[1] <<= 8;
-        mid[0] <<= 8;
-        mid[1] <<= 8;
-        treble[0] <<= 8;
-        treble[1] <<= 8;
-
-        //for (int i = 2; i < 50; i++) {
-        //    Serial.print("Harmonic ");
-        //    Serial.print(i);
-        //    Serial.print(": ");
-        //    unsigned char* p = (unsigned char*)(frequencies + i);
-        //    for (int j = (sizeof * frequencies) - 1; j >= 0; j--) {
-        //        Serial.print(p[j], HEX);
-        //    }
-        //    Serial.println();
-        //    /*Serial.print("Real: ");
-
-        //    unsigned char* p5 = (unsigned char*)(fftOutput + 2*i);
-        //    for (int j = (sizeof * fftOutput) - 1; j >= 0; j--) {
-        //        Serial.print(p5[j], HEX);
-        //    }
-        //    Serial.println();
-        //    Serial.print("Imaginary: ");
-        //    unsigned char* p6 = (unsigned char*)(fftOutput + 2*i + 1);
-        //    for (int j = (sizeof * fftOutput) - 1; j >= 0; j--) {
-        //        Serial.print(p6[j], HEX);
-        //    }
-        //    Serial.println();*/
-        //}
-        arm_cmplx_mag_q31(bass, &bassAmplitude, 1); // output is in Q2,30 format
-        arm_cmplx_mag_q31(mid, &midAmplitude, 1); // output is in Q2,30 format
-        arm_cmplx_mag_q31(treble, &trebleAmplitude, 1); // output is in Q2,30 format
-        /*Serial.print("Bass: ");
-        Serial.println(bassAmplitude);
-        Serial.print("Mid: ");
-        Serial.println(midAmplitude);
-        Serial.print("Treble: ");
-        Serial.println(trebleAmplitude);*/
-        bassLedsOn = numLedsBy3 * bassAmplitude / maxBass;
-        midLedsOn = numLedsBy3 * midAmplitude / maxMid;
-        trebleLedsOn = numLedsBy3 * trebleAmplitude / maxTreble;
-        if (bassLedsOn > numLedsBy3) bassLedsOn = numLedsBy3;
-        if (midLedsOn > numLedsBy3) midLedsOn = numLedsBy3;
-        if (trebleLedsOn > numLedsBy3) trebleLedsOn = numLedsBy3;
-
-        //// Adjust the max values for bass, mid and treble amplitude 
-        //// based on the last 60 values of bassLedsOn, midLedsOn and trebleLedsOn
-        //if (lastBassLeds[lastLedsIndex] == numLedsBy3) numMaxBassValues--;
-        //else if (lastBassLeds[lastLedsIndex] > numLedsBy3By3) numHighBassValues--;
-        //if (lastMidLeds[lastLedsIndex] == numLedsBy3) numMaxMidValues--;
-        //else if (lastMidLeds[lastLedsIndex] > numLedsBy3By3) numHighMidValues--;
-        //if (lastTrebleLeds[lastLedsIndex] == numLedsBy3) numMaxTrebleValues--;
-        //else if (lastTrebleLeds[lastLedsIndex] > numLedsBy3By3) numHighTrebleValues--;
-        //
-        //if (bassLedsOn == numLedsBy3) numMaxBassValues++;
-        //else if (bassLedsOn > numLedsBy3By3 && bassLedsOn > numLedsLowLimit) numHighBassValues++;
-        //if (midLedsOn == numLedsBy3) numMaxMidValues++;
-        //else if (midLedsOn > numLedsBy3By3 && midLedsOn > numLedsLowLimit) numHighMidValues++;
-        //if (trebleLedsOn == numLedsBy3) numMaxTrebleValues++;
-        //else if (trebleLedsOn > numLedsBy3By3 && trebleLedsOn > numLedsLowLimit) numHighTrebleValues++;
-
-        //Serial.println("LED values");
-        ///*Serial.println(numHighBassValues);
-        //Serial.println(numHighMidValues);
-        //Serial.println(numHighTrebleValues);*/
-        //Serial.println(maxBass);
-        //Serial.println(maxMid);
-        //Serial.println(maxTreble);
-
-        //// Add latest values to the lists
-        //lastBassLeds[lastLedsIndex] = bassLedsOn;
-        //lastMidLeds[lastLedsIndex] = midLedsOn;
-        //lastTrebleLeds[lastLedsIndex] = trebleLedsOn;
-
-        //if (numMaxBassValues > 5) {
-        //    maxBass <<= 1;
-        //    numMaxBassValues = 0;
-        //}
-        //if (numMaxMidValues > 5) {
-        //    maxMid <<= 1;
-        //    numMaxMidValues = 0;
-        //}
-        //if (numMaxTrebleValues > 5) {
-        //    maxTreble <<= 1;
-        //    numMaxTrebleValues = 0;
-        //}
+    // Sample window = 204.8 ms, bin width 4.88 Hz, a new window every hop of 25.6 ms
+    if (pipeline.process()) {
+        sendFrameTelemetry();
+    }
 
-        //if (numHighBassValues < 5 && lastLedsIndex == (numRecordedLedValues - 1)) {
-        //    maxBass >>= 1;
-        //}
-        //if (numHighMidValues < 5 && lastLedsIndex == (numRecordedLedValues - 1)) {
-        //    maxMid >>= 1;
-        //}
-        //if (numHighTrebleValues < 5 && lastLedsIndex == (numRecordedLedValues - 1)) {
-        //    maxTreble >>= 1;
-        //}
+    const uint32_t now = micros();
+    if (now - lastRender >= RENDER_PERIOD_US) {
+        lastRender = now - lastRender < 2 * RENDER_PERIOD_US ? lastRender + RENDER_PERIOD_US : now; // keep the cadence, start over after a stall
+        renderer.render(now);
+    }
 
-        //lastLedsIndex++;
-        //if (lastLedsIndex == numRecordedLedValues) {
-        //    lastLedsIndex = 0;
-        //    lastLedsCycleCompleted = true;
-        //}
+    pollCommands();
 
-        /*bassLedsOn = numLedsBy3 - log2(maxBass / bassAmplitude);
-        midLedsOn = numLedsBy3 - log2(maxMid / midAmplitude);
-        trebleLedsOn = numLedsBy3 - log2(maxTreble / trebleAmplitude);*/
+    if (millis() - lastTelemetry >= TELEMETRY_INTERVAL_MS) {
+        lastTelemetry += TELEMETRY_INTERVAL_MS;
+        sendCounters();
+    }
+    telemetry.pump(serialPort);
+}
 
-        /*Serial.print("Bass leds: ");
-        Serial.println(bassLedsOn);
-        Serial.print("Mid leds: ");
-        Serial.println(midLedsOn);
-        Serial.print("Treble leds: ");
-        Serial.println(trebleLedsOn);*/
+/*
+* Band levels, leds lit per band and the decimated spectrum of the frame just shown.
+*/
+void sendFrameTelemetry() {
+    q31_t levels[Config::numBands];
+    uint16_t ledsOn[Config::numBands];
+    for (uint8_t b = 0; b < Config::numBands; b++) {
+        levels[b] = pipeline.level(b);
+        ledsOn[b] = pipeline.ledsOn(b);
+    }
+    const uint32_t frame = pipeline.framesShown();
+    telemetry.sendBands(frame, levels, Config::numBands);
+    telemetry.sendLeds(frame, ledsOn, Config::numBands);
+    if (pipeline.spectrum() != nullptr) {
+        telemetry.sendSpectrum(frame, pipeline.spectrum(), pipeline.spectrumBins(),
+            (uint32_t)((uint64_t)adcSource.sampleRate() * 1000 / Config::fftSize), TELEMETRY_SPECTRUM_DECIMATION);
+    }
+}
 
-        uint8_t hue = 100;
-        int ledCounter;
-        for (ledCounter = 0; ledCounter < bassLedsOn; ledCounter++) {
-            leds[ledCounter] = CHSV(hue++, 255, 255);
-        }
-        for (; ledCounter < numLedsBy3; ledCounter++) {
-            leds[ledCounter] = CHSV(hue++, 255, 0);
-        }
-        for (ledCounter = 0; ledCounter < midLedsOn; ledCounter++) {
-            leds[ledCounter + numLedsBy3] = CHSV(hue++, 255, 255);
-        }
-        for (; ledCounter < numLedsBy3; ledCounter++) {
-            leds[ledCounter + numLedsBy3] = CHSV(hue++, 255, 0);
-        }
-        for (ledCounter = 0; ledCounter < trebleLedsOn; ledCounter++) {
-            leds[ledCounter + numLedsBy3 * 2] = CHSV(hue++, 255, 255);
-        }
-        for (; ledCounter < numLedsBy3; ledCounter++) {
-            leds[ledCounter + numLedsBy3 * 2] = CHSV(hue++, 255, 0);
-        }
+/*
+* The frame counters and the highest fill level of the sample ring. Dropped windows and deadline misses show up
+* here even when the leds look fine.
+*/
+void sendCounters() {
+    Telemetry_Record record;
+    record.sequence = telemetrySequence++;
+    record.millis = millis();
+    record.counters = pipeline.counters();
+    record.counters.ledFrames = renderer.framesRendered(); // the renderer shows the leds, not the pipeline
+    record.counters.ledFramesUnchanged = renderer.framesUnchanged();
+    record.maxFillPercent = (uint16_t)(sampleRing.maxFill() * 100 / sampleRing.capacity());
+    telemetry.sendCounters(record);
+}
 
-        FastLED.show();
+/*
+* Take a command line if one is complete. New parameters are applied by the pipeline at the next frame boundary,
+* the answer is a params frame with the parameters as they will be, or with the old ones if the command was rejected.
+*/
+void pollCommands() {
+    Pipeline_Params params = pipeline.params();
+    switch (commands.poll(serialInput, params)) {
+    case COMMAND_RESULT::SET: {
+        const uint8_t status = pipeline.setParams(params) ? TELEMETRY_PARAMS_CURRENT : TELEMETRY_PARAMS_INVALID;
+        telemetry.sendParams(pipeline.params(), status);
+        break;
+    }
+    case COMMAND_RESULT::GET:
+        telemetry.sendParams(pipeline.params(), TELEMETRY_PARAMS_CURRENT);
+        break;
+    case COMMAND_RESULT::PROFILE:
+        telemetry.sendProfile(pipeline.profiler());
+        break;
+    case COMMAND_RESULT::INVALID:
+        telemetry.sendParams(pipeline.params(), TELEMETRY_PARAMS_INVALID);
+        break;
+    default:
+        break;
     }
-    // micros2 = micros();
-    // Serial.print("Time to compute fft: ");
-    // Serial.println(micros2 - micros1);
 }
 
 /*
-* ADC interrupt callback function. Executes when an ADC conversion has completed.
-* Read the ADC sample and store it in an array.
+* ADC stream callback function. Executes from the DMA interrupt when a block of conversions has completed.
+* Store the samples in the ring buffer, if the analysis has fallen behind the samples that don't fit are counted as dropped.
+* The DMA is done with the block and the cache lines have been invalidated, so it can be copied as normal memory.
 */
-void readAdc(void) {
-    samples[sampleCounter] = ADC0.analogReadContinuous() * 26; // scale samples to maximise resolution (* 26)
-    sampleCounter++;
-    asm("DSB");
-}
\ No newline at end of file
+void readAdc(volatile uint16_t* block, uint16_t blockSize) {
+    sampleRing.write((const q15_t*)block, blockSize); // gain and window are applied in one pass before the analysis
+}
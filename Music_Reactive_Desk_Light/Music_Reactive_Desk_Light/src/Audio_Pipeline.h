@@ -0,0 +1,477 @@
+/*
+ Name:		Audio_Pipeline.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The audio to led pipeline: samples from a Sample_Source, spectrum from an Fft_Backend,
+ band levels, led rendering and output to a Led_Sink. Nothing in here depends on the Teensy,
+ so the same code runs on the desk light and in the host build.
+*/
+#ifndef Audio_Pipeline_H
+#define Audio_Pipeline_H
+
+#include "Dsp_Types.h"
+#include "Sample_Source.h"
+#include "Fft_Backend.h"
+#include "Led_Sink.h"
+#include "Led_Color.h"
+#include "Led_Palette.h"
+#include "Band_Map.h"
+#include "Band_Energy.h"
+#include "Stft.h"
+#include "Fft_Window.h"
+#include "Goertzel_Bands.h"
+#include "Stage_Profiler.h"
+#include "Frame_Telemetry.h"
+#include "Pipeline_Params.h"
+#include "Band_Frame.h"
+#include "Spectrum_Bars.h"
+#include "Latest_Slot.h"
+
+#define PIPELINE_SPECTRUM_LOW 300 // lower edge of the spectrum bars of the band frames in deciHz
+
+//! Analysis engines
+enum class ANALYSIS_ENGINE : uint8_t {
+	FFT, // overlapping spectra from the Fft_Backend
+	GOERTZEL // Goertzel filter bank, one result per fftSize samples
+};
+
+/** Class Audio_Pipeline: from samples to led frames
+*
+*   Usage:
+*   \code
+*   Audio_Pipeline<Config> pipeline(source, backend, sink);
+*   pipeline.begin(ANALYSIS_ENGINE::FFT, WINDOW_TYPE::HANN, 26, 8);
+*   while (true) {
+*       pipeline.process();
+*   }
+*   \endcode
+*   Every call of process() takes the samples the source has, once a hop is complete it is analysed.
+*   When the analysis has new band levels, the leds are rendered and shown: one segment per band,
+*   lit in proportion to level / max level, with a hue running along the strip.
+*   Every stage of a hop is timed by a Stage_Profiler, see profiler().
+*   A frame with the same leds lit as the previous one goes to Led_Sink::repeat(), the strip doesn't need it again.
+*   Every frame is also published to bandFrames(), with log or mel spaced spectrum bars, for a Led_Renderer that
+*   shows the leds at a rate of its own.
+*   Hops lost by the capture and hops that take longer to process than they last are counted, see counters().
+*   Max levels, band edges, brightness, the quiet limit and the spectrum bars can be changed while it runs, see setParams().
+*
+*   \tparam Config a Pipeline_Config, gives the sizes and the band and led tables.
+*/
+template <class Config>
+class Audio_Pipeline {
+
+public:
+
+	//! Constructor
+	/** \param input sample source, its sample rate sets the bin ranges.
+	*   \param backend spectrum stage of the FFT engine.
+	*   \param output receives the led frames.
+	*/
+	Audio_Pipeline(Sample_Source& input, Fft_Backend& backend, Led_Sink& output) : source(input), sink(output), stft(backend),
+		engine(ANALYSIS_ENGINE::FFT), fixed_bands(false), goertzel_offset(0), window_type(WINDOW_TYPE::HANN), input_gain(1), goertzel_filters(1),
+		hop_fill(0), levels{}, leds{}, leds_on{}, shown_leds_on{}, shown_valid(false), frames_shown(0), frames_unchanged(0), led_output(true), band_frame{}, latest_spectrum(nullptr),
+		copy_ticks(0), hop_end(0), hop_seen(false), samples_read(0), frames_processed(0), deadline_misses(0),
+		deadline_ticks(0), dropped_base(0), overruns_base(0), current_params{}, next_params{}, params_pending(false), params_applied(0) {
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			current_params.maxLevels[b] = 1;
+			current_params.bandUpper[b] = Config::bandUpper(b);
+		}
+		current_params.numBands = Config::numBands;
+		current_params.brightness = 255;
+		current_params.spectrumBars = Config::numLeds < SPECTRUM_BARS_MAX ? Config::numLeds : SPECTRUM_BARS_MAX; // a bar per led
+		current_params.barSpacing = (uint8_t)BAR_SPACING::LOG;
+		palette.begin(255, 255); // full colours, the sink scales the brightness
+	}
+
+	//! Set up the analysis
+	/** \param analysis analysis engine.
+	*   \param window window function applied before the analysis.
+	*   \param gain applied to the samples before the window.
+	*   \param goertzelFilters filters per band of the Goertzel engine.
+	*   \return false if a stage couldn't be set up.
+	*/
+	bool begin(ANALYSIS_ENGINE analysis, WINDOW_TYPE window, int16_t gain, uint8_t goertzelFilters) {
+		// the source may not run at exactly the configured rate, e.g. a timer that can only divide the bus clock
+		const uint32_t rate = source.sampleRate();
+		engine = analysis;
+		window_type = window;
+		input_gain = gain;
+		goertzel_filters = goertzelFilters;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			current_params.bandUpper[b] = Config::bandUpper(b);
+		}
+		params_pending = false;
+		params_applied = 0;
+
+		goertzel_offset = 0;
+		hop_fill = 0;
+		frames_shown = 0;
+		frames_unchanged = 0;
+		shown_valid = false;
+		latest_spectrum = nullptr;
+		band_frame.spectrumBars = 0; // the Goertzel engine has no spectrum
+		stage_profiler.begin();
+		copy_ticks = 0;
+		hop_seen = false;
+		samples_read = 0;
+		frames_processed = 0;
+		deadline_misses = 0;
+		deadline_ticks = (uint32_t)((uint64_t)Config::hopSize * Stage_Profiler::ticksPerSecond() / rate);
+		dropped_base = source.samplesDropped();
+		overruns_base = source.overruns();
+		if (engine == ANALYSIS_ENGINE::GOERTZEL) {
+			if (!goertzel_window.begin(Config::fftSize, window)) {
+				return false;
+			}
+			goertzel_window.setGain(gain);
+		}
+		return configureBands(current_params, true);
+	}
+
+	//! Set the level at which all leds of a band are on, right away. Use setParams() while the pipeline runs.
+	void setMaxLevel(uint8_t band, q31_t level) {
+		current_params.maxLevels[band] = level > 0 ? level : 1;
+		next_params.maxLevels[band] = current_params.maxLevels[band];
+	}
+
+	//! Level at which all leds of a band are on
+	q31_t maxLevel(uint8_t band) const { return current_params.maxLevels[band]; }
+
+	//! Change the parameters at the next frame boundary
+	/** All parameters change together before the next hop is analysed, a frame never mixes old and new values.
+	*   The bin ranges are only recomputed if a band edge changed. If the last band edge moves to another bin,
+	*   the spectrum is resized and the window starts again, the leds pause for up to fftSize / hopSize hops.
+	*   \param params new parameters, numBands has to be that of the Config.
+	*   \return false if the parameters are invalid: a max level of 0 or less, edges that aren't ascending,
+	*   a band without a bin at the rate of the source, a quiet limit above the leds of a band, an unknown effect
+	*   or spectrum bars out of range.
+	*/
+	bool setParams(const Pipeline_Params& params) {
+		if (params.numBands != Config::numBands || params.effect >= (uint8_t)LED_EFFECT::COUNT || params.spectrumBars == 0
+			|| params.spectrumBars > SPECTRUM_BARS_MAX || params.barSpacing >= (uint8_t)BAR_SPACING::COUNT) {
+			return false;
+		}
+		Band_Map check;
+		if (!check.configure(source.sampleRate(), Config::fftSize, params.bandUpper, Config::numBands)) {
+			return false;
+		}
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			if (params.maxLevels[b] <= 0 || check.band(b).endBin <= check.band(b).firstBin || params.quietLeds > Config::ledSegment(b).numLeds) {
+				return false;
+			}
+		}
+		next_params = params;
+		params_pending = true;
+		return true;
+	}
+
+	//! Parameters as of the next frame: the ones passed to setParams() if they are still pending
+	const Pipeline_Params& params() const { return params_pending ? next_params : current_params; }
+
+	//! Number of parameter sets applied since begin()
+	uint32_t paramsApplied() const { return params_applied; }
+
+	//! Take the available samples, analyse a complete hop and show the leds
+	/** \return true if a led frame was shown.
+	*/
+	bool process() {
+		const uint32_t start = Stage_Profiler::now();
+		const uint32_t received = source.read(hop + hop_fill, Config::hopSize - hop_fill);
+		uint32_t time = Stage_Profiler::now();
+		if (received == 0) {
+			return false; // waiting for the capture, not copying
+		}
+		hop_fill += received;
+		samples_read += received;
+		copy_ticks += time - start;
+		if (hop_fill < Config::hopSize) {
+			return false;
+		}
+		hop_fill = 0;
+		if (params_pending) {
+			applyParams(); // between two frames
+		}
+		if (hop_seen) {
+			stage_profiler.record(PIPELINE_STAGE::CAPTURE_WAIT, start - hop_end);
+		}
+		hop_seen = true;
+
+		const bool analysed = analyse(time);
+		if (analysed) {
+			render();
+			time = stage_profiler.lap(PIPELINE_STAGE::LED_FILL, time);
+			if (led_output) { // otherwise a Led_Renderer shows the frame
+				if (frameChanged()) {
+					sink.show(leds, Config::numLeds);
+					time = stage_profiler.lap(PIPELINE_STAGE::SHOW, time);
+				}
+				else {
+					sink.repeat(leds, Config::numLeds);
+					time = Stage_Profiler::now(); // SHOW keeps the times of the frames that were sent
+					frames_unchanged++;
+				}
+			}
+			stage_profiler.record(PIPELINE_STAGE::FRAME, time - start);
+			frames_shown++;
+			band_frame.frame = frames_shown;
+			band_frame.brightness = current_params.brightness;
+			band_frame.effect = current_params.effect;
+			band_slot.publish(band_frame);
+		}
+		hop_end = time;
+		frames_processed++;
+		if (time - start > deadline_ticks) {
+			deadline_misses++;
+		}
+		return analysed;
+	}
+
+	//! Level of a band in the latest frame, RMS bin magnitude with BAND_ENERGY_FRACTION_BITS fractional bits
+	q31_t level(uint8_t band) const { return levels[band]; }
+
+	//! Led frame, rendered by process()
+	Rgb* ledFrame() { return leds; }
+
+	//! Number of leds lit in the segment of a band in the latest frame
+	uint16_t ledsOn(uint8_t band) const { return leds_on[band]; }
+
+	//! Spectrum of the latest frame, see Stft::spectrum()
+	/** \return spectrumBins() bins as real, imaginary pairs, nullptr before the first frame and for the Goertzel engine.
+	*/
+	const q15_t* spectrum() const { return latest_spectrum; }
+
+	//! Number of bins of spectrum(), up to the upper edge of the last band
+	uint32_t spectrumBins() const { return stft.maxBin(); }
+
+	//! Number of led frames shown since begin(), unchanged frames included
+	uint32_t framesShown() const { return frames_shown; }
+
+	//! Number of led frames since begin() that were equal to the previous one and went to Led_Sink::repeat()
+	uint32_t framesUnchanged() const { return frames_unchanged; }
+
+	//! Leds lit per band of every frame, the input of a Led_Renderer
+	Latest_Slot<Band_Frame>& bandFrames() { return band_slot; }
+
+	//! Show the leds from process(), or leave the led sink to a Led_Renderer
+	/** \param enabled false: process() only publishes bandFrames(), ledFrame() stays dark and the sink isn't used.
+	*/
+	void setLedOutput(bool enabled) { led_output = enabled; }
+
+	//! Bin ranges of the bands at the rate of the source
+	const Band_Map& bandMap() const { return bands; }
+
+	//! Stage timing, cleared by begin()
+	Stage_Profiler& profiler() { return stage_profiler; }
+
+	//! Frame and overrun counters since begin()
+	Frame_Counters counters() const {
+		const uint32_t dropped = source.samplesDropped() - dropped_base;
+		Frame_Counters result;
+		result.framesProduced = (uint32_t)((samples_read + dropped) / Config::hopSize);
+		result.framesProcessed = frames_processed;
+		result.windowsSkipped = dropped / Config::hopSize;
+		result.isrOverruns = source.overruns() - overruns_base;
+		result.deadlineMisses = deadline_misses;
+		result.ledFrames = frames_shown;
+		result.ledFramesUnchanged = frames_unchanged;
+		return result;
+	}
+
+	//! Processing time a hop may take, the duration of a hop in Stage_Profiler ticks
+	uint32_t deadline() const { return deadline_ticks; }
+
+private:
+	//! Band levels of the hop in hop[], false if there are no new levels
+	/** \param time start of the stage after the read, updated to the end of the last stage.
+	*/
+	bool analyse(uint32_t& time) {
+		if (engine == ANALYSIS_ENGINE::GOERTZEL) {
+			time = flushCopyTicks();
+			goertzel_window.apply(hop, hop, goertzel_offset, Config::hopSize, 0); // the source already removed the bias
+			goertzel_offset = (goertzel_offset + Config::hopSize) % Config::fftSize;
+			const bool complete = goertzel.process(hop, Config::hopSize); // completes a block every fftSize samples
+			if (complete) {
+				for (uint8_t b = 0; b < Config::numBands; b++) {
+					levels[b] = goertzel.magnitude(b);
+				}
+			}
+			time = stage_profiler.lap(PIPELINE_STAGE::BANDS, time);
+			return complete;
+		}
+
+		stft.write(hop, Config::hopSize); // exactly one hop of raw samples
+		copy_ticks += Stage_Profiler::now() - time;
+		time = flushCopyTicks();
+		if (!stft.available()) {
+			return false; // the first window isn't full yet
+		}
+		const q15_t* spectrum = stft.spectrum(); // Q13.3 output format, bins above the last band aren't computed
+		latest_spectrum = spectrum;
+		time = stage_profiler.lap(PIPELINE_STAGE::FFT, time);
+		if (fixed_bands) {
+			energy.template accumulate<Config>(spectrum); // fixed trip counts
+		}
+		else {
+			energy.accumulate(spectrum);
+		}
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			levels[b] = energy.magnitude(b);
+		}
+		spectrum_bars.compute(spectrum, band_frame.spectrum);
+		band_frame.spectrumBars = spectrum_bars.count();
+		time = stage_profiler.lap(PIPELINE_STAGE::BANDS, time);
+		return true;
+	}
+
+	//! Bin ranges and the tables that follow from them
+	/** \param params band edges and spectrum bars.
+	*   \param restart set up the spectrum even if its size doesn't change.
+	*/
+	bool configureBands(const Pipeline_Params& params, bool restart) {
+		const uint32_t* upper = params.bandUpper;
+		const uint32_t rate = source.sampleRate();
+		if (!bands.configure(rate, Config::fftSize, upper, Config::numBands)) {
+			return false;
+		}
+		fixed_bands = rate == Config::sampleRate;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			fixed_bands &= upper[b] == Config::bandUpper(b);
+		}
+
+		if (engine == ANALYSIS_ENGINE::GOERTZEL) {
+			return goertzel.begin(bands, goertzel_filters);
+		}
+		const uint32_t maxBin = bands.band(Config::numBands - 1).endBin;
+		if (restart || maxBin != stft.maxBin()) {
+			if (!stft.begin(Config::fftSize, Config::hopSize, maxBin, window_type)) {
+				return false;
+			}
+			stft.setGain(input_gain);
+			latest_spectrum = nullptr;
+			restart = true;
+		}
+		if (restart || params.spectrumBars != spectrum_bars.count() || params.barSpacing != (uint8_t)spectrum_bars.spacing()) {
+			if (!spectrum_bars.begin(rate, Config::fftSize, maxBin, params.spectrumBars, PIPELINE_SPECTRUM_LOW, (BAR_SPACING)params.barSpacing)) {
+				return false;
+			}
+		}
+		return energy.begin(bands);
+	}
+
+	//! Switch to the pending parameters, the derived tables only if their inputs changed
+	void applyParams() {
+		params_pending = false;
+		bool bandsChanged = next_params.spectrumBars != current_params.spectrumBars || next_params.barSpacing != current_params.barSpacing;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			bandsChanged |= next_params.bandUpper[b] != current_params.bandUpper[b];
+		}
+		if (bandsChanged && !configureBands(next_params, false)) {
+			// out of memory for the spectrum or the bar weights, keep the old edges and bars
+			for (uint8_t b = 0; b < Config::numBands; b++) {
+				next_params.bandUpper[b] = current_params.bandUpper[b];
+			}
+			next_params.spectrumBars = current_params.spectrumBars;
+			next_params.barSpacing = current_params.barSpacing;
+			configureBands(current_params, true);
+		}
+		if (next_params.brightness != current_params.brightness && led_output) { // a Led_Renderer takes it from the band frame
+			sink.setBrightness(next_params.brightness);
+			shown_valid = false; // the strip only takes the brightness with the next frame sent
+		}
+		current_params = next_params;
+		params_applied++;
+	}
+
+	//! Record the copy time of the hop, the reads of all process() calls it took, return the current time
+	uint32_t flushCopyTicks() {
+		stage_profiler.record(PIPELINE_STAGE::COPY, copy_ticks);
+		copy_ticks = 0;
+		return Stage_Profiler::now();
+	}
+
+	//! Is the rendered frame different from the last one sent to the sink? Remembers it if so.
+	/** The palette is fixed, so the leds lit per band decide the whole frame.
+	*/
+	bool frameChanged() {
+		bool changed = !shown_valid;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			changed |= leds_on[b] != shown_leds_on[b];
+			shown_leds_on[b] = leds_on[b];
+		}
+		shown_valid = true;
+		return changed;
+	}
+
+	//! Light every band segment in proportion to its level
+	void render() {
+		uint8_t hue = LED_FIRST_HUE;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const Led_Segment segment = Config::ledSegment(b);
+			const int64_t full = (int64_t)segment.numLeds << BAND_FRAME_FRACTION_BITS;
+			int64_t scaled = full * levels[b] / current_params.maxLevels[b]; // leds with fractional bits for the renderer
+			if (scaled > full) {
+				scaled = full;
+			}
+			if (current_params.quietLeds > 0 && (scaled >> BAND_FRAME_FRACTION_BITS) <= current_params.quietLeds) {
+				scaled = 0;
+			}
+			leds_on[b] = (uint16_t)(scaled >> BAND_FRAME_FRACTION_BITS);
+			band_frame.leds[b] = (uint32_t)scaled;
+			if (led_output) {
+				palette.fillBar(leds, segment, leds_on[b], hue);
+			}
+			hue += segment.numLeds;
+		}
+	}
+
+	Sample_Source& source;
+	Led_Sink& sink;
+
+	Band_Map bands;
+	Stft stft;
+	Band_Energy energy;
+	Goertzel_Bands goertzel;
+	Fft_Window goertzel_window; // the filter bank gets the same window as the fft
+	ANALYSIS_ENGINE engine;
+	bool fixed_bands; // the source runs at exactly the configured rate, the constexpr bin ranges apply
+	uint32_t goertzel_offset; // position of the next hop in the window
+	WINDOW_TYPE window_type;
+	int16_t input_gain;
+	uint8_t goertzel_filters;
+
+	q15_t hop[Config::hopSize];
+	uint32_t hop_fill; // samples in hop[]
+	q31_t levels[Config::numBands];
+	Rgb leds[Config::numLeds];
+	uint16_t leds_on[Config::numBands];
+	uint16_t shown_leds_on[Config::numBands]; // leds_on of the last frame sent to the sink
+	bool shown_valid; // shown_leds_on is what the strip shows
+	Led_Palette palette;
+	uint32_t frames_shown;
+	uint32_t frames_unchanged;
+	bool led_output; // process() shows the leds, otherwise a Led_Renderer does
+	Band_Frame band_frame; // built by render()
+	Latest_Slot<Band_Frame> band_slot;
+	Spectrum_Bars spectrum_bars;
+	const q15_t* latest_spectrum; // owned by stft
+
+	Stage_Profiler stage_profiler;
+	uint32_t copy_ticks; // read time of the hop so far
+	uint32_t hop_end; // end of the previous hop, start of the capture wait
+	bool hop_seen; // hop_end is valid
+
+	uint64_t samples_read; // since begin()
+	uint32_t frames_processed;
+	uint32_t deadline_misses;
+	uint32_t deadline_ticks; // duration of a hop
+	uint32_t dropped_base; // samples dropped by the source before begin()
+	uint32_t overruns_base; // overruns of the source before begin()
+
+	Pipeline_Params current_params;
+	Pipeline_Params next_params; // applied at the next frame boundary if params_pending
+	bool params_pending;
+	uint32_t params_applied;
+};
+
+#endif // Audio_Pipeline_H
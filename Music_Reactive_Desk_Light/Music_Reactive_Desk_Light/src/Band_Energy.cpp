@@ -0,0 +1,50 @@
+/*
+ Name:		Band_Energy.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Band levels from a spectrum.
+*/
+
+#include "Band_Energy.h"
+#include <math.h>
+
+/* Constructor
+*   No bands until begin().
+*/
+Band_Energy::Band_Energy() : ranges{}, num_bands(0), band_power{}, band_magnitude{} {
+}
+
+/* Copy the bin ranges
+*
+*/
+bool Band_Energy::begin(const Band_Map& map) {
+	if (map.numBands() == 0) {
+		return false;
+	}
+	num_bands = map.numBands();
+	for (uint8_t b = 0; b < num_bands; b++) {
+		ranges[b] = map.band(b);
+		band_power[b] = 0;
+		band_magnitude[b] = 0;
+	}
+	return true;
+}
+
+/* Sum real^2 + imaginary^2 over the bins of every band
+*   The largest bin power is 2^31, so even 4096 bins fit in the 64 bit sums.
+*/
+void Band_Energy::accumulate(const q15_t* spectrum) {
+	for (uint8_t b = 0; b < num_bands; b++) {
+		uint32_t bins = ranges[b].endBin - ranges[b].firstBin;
+		store(b, binPower(spectrum + 2 * ranges[b].firstBin, bins), bins);
+	}
+}
+
+/* The magnitude is computed once per band, sqrt(power / bins) scaled by 2^BAND_ENERGY_FRACTION_BITS
+*
+*/
+void Band_Energy::store(uint8_t band, q63_t power, uint32_t bins) {
+	band_power[band] = power;
+	band_magnitude[band] = bins ? (q31_t)(sqrtf((float)power / bins) * (1 << BAND_ENERGY_FRACTION_BITS)) : 0;
+}
@@ -0,0 +1,119 @@
+/*
+ Name:		Band_Energy.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Band levels from a spectrum. The power of every bin, real^2 + imaginary^2, is added up
+ per band, so the level doesn't depend on the phases of the bins like a sum of components does.
+*/
+#ifndef Band_Energy_H
+#define Band_Energy_H
+
+#include "Dsp_Types.h"
+#include "Band_Map.h"
+#include <string.h>
+
+#define BAND_ENERGY_FRACTION_BITS 8 // fractional bits of magnitude()
+
+/** Class Band_Energy: per band power and RMS magnitude
+*
+*   The bin ranges are copied from a Band_Map into a table in begin(), accumulate() then only walks that table.
+*   A bin is one word with the real and imaginary part, on the Teensy one SMLALD per bin
+*   adds real^2 + imaginary^2 to a 64 bit sum. A host build does the same with plain multiplies.
+*   With a Pipeline_Config the bin ranges are compile time constants instead, accumulate<Config>()
+*   then runs loops with a fixed trip count that the compiler can unroll.
+*/
+class Band_Energy {
+
+public:
+
+	//! Constructor
+	Band_Energy();
+
+	//! Copy the bin ranges of the bands
+	/** \param map bin ranges, see Band_Map.
+	*   \return false if the map has no bands.
+	*/
+	bool begin(const Band_Map& map);
+
+	//! Compute the band levels of a spectrum
+	/** \param spectrum bins in the layout of Fft_Engine::rfft, at least up to the end of the last band.
+	*/
+	void accumulate(const q15_t* spectrum);
+
+	//! Compute the band levels of a spectrum with the bin ranges of a Pipeline_Config
+	/** begin() isn't needed.
+	*   \param spectrum bins in the layout of Fft_Engine::rfft, at least up to Config::maxBin().
+	*/
+	template <class Config>
+	void accumulate(const q15_t* spectrum) {
+		static_assert(Config::numBands <= BAND_MAP_MAX_BANDS, "too many bands");
+		accumulateFixed<Config>(spectrum, Band_Index<Config::numBands>());
+		num_bands = Config::numBands;
+	}
+
+	//! Sum of real^2 + imaginary^2 over a range of bins
+	/** \param bins first bin, real and imaginary interleaved.
+	*   \param count number of bins.
+	*/
+	static inline q63_t binPower(const q15_t* bins, uint32_t count) {
+		q63_t sum = 0;
+#if defined(ARDUINO) && defined(__ARM_FEATURE_DSP)
+		uint32_t pairs = count >> 1;
+		while (pairs > 0) {
+			int32_t first, second;
+			memcpy(&first, bins, sizeof(first));
+			memcpy(&second, bins + 2, sizeof(second));
+			sum = __SMLALD(first, first, sum); // re * re + im * im + sum
+			sum = __SMLALD(second, second, sum);
+			bins += 4;
+			pairs--;
+		}
+		count &= 1;
+#endif
+		for (uint32_t i = 0; i < count; i++) {
+			int32_t re = bins[2 * i];
+			int32_t im = bins[2 * i + 1];
+			sum += (q63_t)(re * re) + (q63_t)(im * im);
+		}
+		return sum;
+	}
+
+	//! Sum of the bin powers in a band
+	q63_t power(uint8_t band) const { return band_power[band]; }
+
+	//! RMS magnitude of the bins in a band
+	/** \return sqrt(power / bins) in the units of the spectrum, with BAND_ENERGY_FRACTION_BITS fractional bits.
+	*/
+	q31_t magnitude(uint8_t band) const { return band_magnitude[band]; }
+
+	//! Number of bands
+	uint8_t numBands() const { return num_bands; }
+
+private:
+	template <uint8_t Band>
+	struct Band_Index {
+	};
+
+	//! Bands 0 up to Band, one instantiation per band so the bin range is a constant
+	template <class Config, uint8_t Band>
+	void accumulateFixed(const q15_t* spectrum, Band_Index<Band>) {
+		accumulateFixed<Config>(spectrum, Band_Index<Band - 1>());
+		constexpr Band_Range range = Config::band(Band - 1);
+		store(Band - 1, binPower(spectrum + 2 * range.firstBin, range.endBin - range.firstBin), range.endBin - range.firstBin);
+	}
+
+	template <class Config>
+	void accumulateFixed(const q15_t*, Band_Index<0>) {
+	}
+
+	//! Store the power of a band and its magnitude
+	void store(uint8_t band, q63_t power, uint32_t bins);
+
+	Band_Range ranges[BAND_MAP_MAX_BANDS];
+	uint8_t num_bands;
+	q63_t band_power[BAND_MAP_MAX_BANDS];
+	q31_t band_magnitude[BAND_MAP_MAX_BANDS];
+};
+
+#endif // Band_Energy_H
@@ -0,0 +1,28 @@
+/*
+ Name:		Band_Frame.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Result of one analysis frame as the led renderer needs it, handed over through a
+ Latest_Slot (see Led_Renderer.h).
+*/
+#ifndef Band_Frame_H
+#define Band_Frame_H
+
+#include <stdint.h>
+#include "Band_Map.h"
+#include "Spectrum_Bars.h"
+
+#define BAND_FRAME_FRACTION_BITS 8 // fractional bits of the led counts
+
+//! Leds lit per band of an analysis frame
+struct Band_Frame {
+	uint32_t frame; // led frame number, see Audio_Pipeline::framesShown()
+	uint32_t leds[BAND_MAP_MAX_BANDS]; // leds lit per band with BAND_FRAME_FRACTION_BITS fractional bits, 0 for a quiet band
+	uint8_t brightness; // global led brightness, 255 is full
+	uint8_t effect; // LED_EFFECT the renderer shows
+	uint16_t spectrumBars; // bars in spectrum[], 0 without a spectrum (Goertzel engine)
+	uint8_t spectrum[SPECTRUM_BARS_MAX]; // log or mel spaced spectrum, see Spectrum_Bars
+};
+
+#endif // Band_Frame_H
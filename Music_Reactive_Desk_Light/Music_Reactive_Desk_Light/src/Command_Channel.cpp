@@ -0,0 +1,153 @@
+/*
+ Name:		Command_Channel.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Parsing of the tuning commands.
+*/
+
+#include "Command_Channel.h"
+#include <stdlib.h>
+#include <string.h>
+
+Command_Channel::Command_Channel() : line{}, length(0), overflow(false), error_count(0) {
+}
+
+/* Collect characters up to a newline, '\r' is ignored so both line ends work
+*   Stops at the end of a line, the characters after it stay in the input for the next poll().
+*/
+COMMAND_RESULT Command_Channel::poll(Command_Input& input, Pipeline_Params& params) {
+	int c;
+	while ((c = input.read()) >= 0) {
+		if (c == '\r') {
+			continue;
+		}
+		if (c != '\n') {
+			if (length < COMMAND_MAX_LINE) {
+				line[length++] = (char)c;
+			}
+			else {
+				overflow = true;
+			}
+			continue;
+		}
+
+		line[length] = '\0';
+		const bool tooLong = overflow;
+		const bool empty = length == 0;
+		length = 0;
+		overflow = false;
+		if (tooLong) {
+			error_count++;
+			return COMMAND_RESULT::INVALID;
+		}
+		if (!empty) {
+			return interpret(params);
+		}
+	}
+	return COMMAND_RESULT::NONE;
+}
+
+/* get and profile stand alone, everything else is a list of settings
+*   The settings go to a copy, params only changes if all of them are valid.
+*/
+COMMAND_RESULT Command_Channel::interpret(Pipeline_Params& params) {
+	char* start = line;
+	while (*start == ' ' || *start == '\t') {
+		start++;
+	}
+	char* end = start + strlen(start);
+	while (end > start && (end[-1] == ' ' || end[-1] == '\t')) {
+		*--end = '\0';
+	}
+	if (strcmp(start, "get") == 0) {
+		return COMMAND_RESULT::GET;
+	}
+	if (strcmp(start, "profile") == 0 || strcmp(start, "p") == 0) {
+		return COMMAND_RESULT::PROFILE;
+	}
+
+	Pipeline_Params changed = params;
+	char* setting = start;
+	while (setting != nullptr) {
+		char* next = strchr(setting, ';');
+		if (next != nullptr) {
+			*next++ = '\0';
+		}
+		if (!applySetting(setting, changed)) {
+			error_count++;
+			return COMMAND_RESULT::INVALID;
+		}
+		setting = next;
+	}
+	params = changed;
+	return COMMAND_RESULT::SET;
+}
+
+/* A name and one or two unsigned decimal numbers, nothing else on the setting
+*   The ranges checked here only depend on the command, the pipeline checks the rest in setParams().
+*/
+bool Command_Channel::applySetting(const char* setting, Pipeline_Params& params) {
+	while (*setting == ' ' || *setting == '\t') {
+		setting++;
+	}
+	const char* name = setting;
+	while (*setting != '\0' && *setting != ' ' && *setting != '\t') {
+		setting++;
+	}
+	const size_t nameLength = setting - name;
+
+	uint32_t values[2];
+	uint8_t count = 0;
+	while (true) {
+		while (*setting == ' ' || *setting == '\t') {
+			setting++;
+		}
+		if (*setting == '\0') {
+			break;
+		}
+		if (count == 2 || *setting < '0' || *setting > '9') {
+			return false;
+		}
+		char* end;
+		const unsigned long value = strtoul(setting, &end, 10);
+		if (value > INT32_MAX || (*end != '\0' && *end != ' ' && *end != '\t')) {
+			return false;
+		}
+		values[count++] = (uint32_t)value;
+		setting = end;
+	}
+
+	if (nameLength == 0 && count == 0) {
+		return true; // e.g. after a trailing ';'
+	}
+	if (nameLength == 3 && strncmp(name, "max", 3) == 0 && count == 2 && values[0] < params.numBands && values[1] > 0) {
+		params.maxLevels[values[0]] = (q31_t)values[1];
+		return true;
+	}
+	if (nameLength == 4 && strncmp(name, "edge", 4) == 0 && count == 2 && values[0] < params.numBands) {
+		params.bandUpper[values[0]] = values[1];
+		return true;
+	}
+	if (nameLength == 10 && strncmp(name, "brightness", 10) == 0 && count == 1 && values[0] <= 255) {
+		params.brightness = (uint8_t)values[0];
+		return true;
+	}
+	if (nameLength == 5 && strncmp(name, "quiet", 5) == 0 && count == 1 && values[0] <= UINT16_MAX) {
+		params.quietLeds = (uint16_t)values[0];
+		return true;
+	}
+	if (nameLength == 6 && strncmp(name, "effect", 6) == 0 && count == 1 && values[0] < (uint32_t)LED_EFFECT::COUNT) {
+		params.effect = (uint8_t)values[0];
+		return true;
+	}
+	if (nameLength == 4 && strncmp(name, "bars", 4) == 0 && count == 1 && values[0] > 0 && values[0] <= SPECTRUM_BARS_MAX) {
+		params.spectrumBars = (uint8_t)values[0];
+		return true;
+	}
+	if (nameLength == 7 && strncmp(name, "spacing", 7) == 0 && count == 1 && values[0] < (uint32_t)BAR_SPACING::COUNT) {
+		params.barSpacing = (uint8_t)values[0];
+		return true;
+	}
+	return false;
+}
@@ -0,0 +1,111 @@
+/*
+ Name:		Command_Channel.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Text commands that tune the pipeline while it runs, read from the serial port without
+ blocking. Saves a rebuild and reflash per tuning step.
+*/
+#ifndef Command_Channel_H
+#define Command_Channel_H
+
+#include <stdint.h>
+#include "Pipeline_Params.h"
+
+#define COMMAND_MAX_LINE 96 // characters per command line, longer lines are rejected
+
+/** Class Command_Input: byte input of the commands, e.g. the USB serial port
+*/
+class Command_Input {
+
+public:
+
+	virtual ~Command_Input() {}
+
+	//! Next byte
+	/** \return the byte, -1 if none is available yet. Never blocks.
+	*/
+	virtual int read() = 0;
+};
+
+/** Class Text_Command_Input: commands from a string in memory, e.g. the command line of the host build
+*/
+class Text_Command_Input : public Command_Input {
+
+public:
+
+	//! Constructor
+	/** \param commands text, kept by the caller.
+	*/
+	explicit Text_Command_Input(const char* commands) : text(commands) {}
+
+	int read() override { return text != nullptr && *text != '\0' ? (uint8_t)*text++ : -1; }
+
+private:
+	const char* text;
+};
+
+//! What a command line asked for
+enum class COMMAND_RESULT : uint8_t {
+	NONE, // no complete line yet
+	SET, // parameters changed, pass them to Audio_Pipeline::setParams()
+	GET, // report the parameters
+	PROFILE, // report the stage timing
+	INVALID // unknown command, bad value or line too long, nothing changed
+};
+
+/** Class Command_Channel: line based command interpreter
+*
+*   Usage:
+*   \code
+*   Pipeline_Params params = pipeline.params();
+*   if (commands.poll(input, params) == COMMAND_RESULT::SET) {
+*       pipeline.setParams(params); // applied at the next frame boundary
+*   }
+*   \endcode
+*   Commands, one line each, settings separated by ';' are applied together:
+*   \code
+*   max <band> <level>     level at which all leds of a band are on
+*   edge <band> <deciHz>   upper edge of a band
+*   brightness <0-255>     global led brightness
+*   quiet <leds>           show a band dark while at most this many of its leds are on
+*   effect <n>             visualizer of the led renderer, a LED_EFFECT: 0 vu, 1 spectrum, 2 pulse, 3 mirror, 4 waterfall
+*   bars <n>               number of spectrum bars, 1 to SPECTRUM_BARS_MAX
+*   spacing <n>            frequency scale of the spectrum bars, a BAR_SPACING: 0 log, 1 mel
+*   get                    report the parameters
+*   profile                report the stage timing, 'p' for short
+*   \endcode
+*   e.g. "max 0 40000; edge 0 2000". poll() only reads what the input has and returns after at most
+*   one complete line, so it can run every loop between frames.
+*/
+class Command_Channel {
+
+public:
+
+	//! Constructor
+	Command_Channel();
+
+	//! Read the available input and interpret a complete line
+	/** \param input byte input, read without blocking.
+	*   \param params parameters the settings are applied to, only changed if the whole line is valid.
+	*   \return what the line asked for, COMMAND_RESULT::NONE while no line is complete.
+	*/
+	COMMAND_RESULT poll(Command_Input& input, Pipeline_Params& params);
+
+	//! Lines rejected since construction
+	uint32_t errors() const { return error_count; }
+
+private:
+	//! Interpret the line in line[]
+	COMMAND_RESULT interpret(Pipeline_Params& params);
+
+	//! Apply one setting, e.g. "max 0 40000"
+	bool applySetting(const char* setting, Pipeline_Params& params);
+
+	char line[COMMAND_MAX_LINE + 1];
+	uint32_t length; // characters in line[]
+	bool overflow; // the line is too long, skip up to its end
+	uint32_t error_count;
+};
+
+#endif // Command_Channel_H
@@ -0,0 +1,41 @@
+/*
+ Name:		Desk_Light_Config.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Settings of the desk light, shared by the sketch and the host build so both run
+ the pipeline with identical parameters.
+*/
+#ifndef Desk_Light_Config_H
+#define Desk_Light_Config_H
+
+#include "Pipeline_Config.h"
+#include "Fft_Window.h"
+
+/*
+* Pipeline configuration, checked at compile time
+*   fft window of 8192 samples, hop of 1024 samples (a new spectrum every 25.6 ms), 40000 conversions per second
+*   triggered by the QuadTimer, 117 leds, bass up to 250 Hz, mid up to 1500 Hz and treble up to 5000 Hz (deciHz)
+*/
+typedef Pipeline_Config<8192, 1024, 40000, 117, 2500, 15000, 50000> Config;
+static_assert(Config::numBands == 3, "the leds show bass, mid and treble");
+
+#define inputGain 26 // scale samples to maximise resolution, applied with the window
+#define fftWindow WINDOW_TYPE::HANN // window function applied before the analysis
+#define analysisEngine ANALYSIS_ENGINE::FFT // band levels from the pruned FFT or from a Goertzel filter bank
+#define goertzelFiltersPerBand 8
+#define maxBass 44000 // max bass amplitude, RMS bin magnitude with 8 fractional bits
+#define maxMid 18000 // max mid amplitude
+#define maxTreble 6000 // max treble amplitude
+#define ledBrightness 84 // global led brightness, 255 is full
+
+/*
+* Led renderer, runs at its own rate between the analysis frames (see Led_Renderer.h)
+*/
+#define ledRenderRate 200 // led frames per second, the 3.8 ms transfer of 117 leds allows up to 260
+#define barAttack 1000 // leds per second a bar rises at most, a whole segment in 39 ms
+#define barDecay 120 // leds per second a bar falls at most
+#define peakHoldMs 300 // time the peak marker stays up
+#define peakFall 40 // leds per second the peak marker falls after the hold
+
+#endif // Desk_Light_Config_H
@@ -0,0 +1,137 @@
+/*
+ Name:		Effect_Set.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Registry of the led visualizers. The effects are a list of types fixed at compile time,
+ one of them is selected at run time and draws the whole frame, so there is no virtual call per led.
+*/
+#ifndef Effect_Set_H
+#define Effect_Set_H
+
+#include <stdint.h>
+#include <tuple>
+#include <type_traits>
+#include "Led_Color.h"
+#include "Led_Palette.h"
+#include "Band_Frame.h"
+
+//! What an effect draws from, filled by the Led_Renderer for every frame
+struct Effect_Input {
+	const uint32_t* levels; // bar height per band after attack and decay, leds with BAND_FRAME_FRACTION_BITS fractional bits
+	const uint32_t* peaks; // peak marker height per band, same unit
+	const Band_Frame* frame; // latest analysis frame: levels without the envelope and the spectrum bars
+	bool newFrame; // frame arrived since the previous render
+	uint32_t now; // time of the render in us
+	uint32_t elapsed; // us since the previous render, 0 for the first
+};
+
+/** Class Effect_Set: compile time list of effects, one of them selected
+*
+*   Usage:
+*   \code
+*   Effect_Set<Vu_Bars<Config>, Waterfall<Config>> effects;
+*   effects.select(1);
+*   effects.render(input, leds, palette);
+*   \endcode
+*   An effect is a class with
+*   \code
+*   static const char* name();                                               // short name for reports
+*   void begin();                                                            // clear the state, called when selected
+*   void render(const Effect_Input& input, Rgb* leds, const Led_Palette& p); // draw every led of the frame
+*   \endcode
+*   render() of the set picks the selected effect with a chain of index compares that the compiler unrolls,
+*   the effect's own loop over the leds is then a direct, inlinable call.
+*
+*   \tparam Effects effect types, selected by their position in the list.
+*/
+template <class... Effects>
+class Effect_Set {
+	static_assert(sizeof...(Effects) > 0 && sizeof...(Effects) < 256, "1 to 255 effects");
+
+public:
+
+	static constexpr uint8_t count = sizeof...(Effects);
+
+	//! Constructor, the first effect is selected
+	Effect_Set() : current(0) {
+		beginAt<0>();
+	}
+
+	//! Select an effect and clear its state
+	/** \param index position in the list.
+	*   \return false if there is no such effect, the selection doesn't change.
+	*/
+	bool select(uint8_t index) {
+		if (index >= count) {
+			return false;
+		}
+		current = index;
+		beginAt<0>();
+		return true;
+	}
+
+	//! Position of the selected effect
+	uint8_t selected() const { return current; }
+
+	//! Name of an effect, nullptr if there is no such effect
+	static const char* name(uint8_t index) { return nameAt<0>(index); }
+
+	//! Draw a frame with the selected effect
+	/** \param input band levels, peaks and spectrum.
+	*   \param leds frame of Config::numLeds leds of the effects.
+	*   \param palette colours of the hues.
+	*/
+	void render(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) { renderAt<0>(input, leds, palette); }
+
+	//! An effect of the list, e.g. to tune it
+	template <uint8_t Index>
+	typename std::tuple_element<Index, std::tuple<Effects...>>::type& effect() { return std::get<Index>(effects); }
+
+private:
+	template <uint8_t Index>
+	typename std::enable_if<(Index < sizeof...(Effects))>::type renderAt(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) {
+		if (current == Index) {
+			std::get<Index>(effects).render(input, leds, palette);
+		}
+		else {
+			renderAt<Index + 1>(input, leds, palette);
+		}
+	}
+
+	template <uint8_t Index>
+	typename std::enable_if<(Index >= sizeof...(Effects))>::type renderAt(const Effect_Input&, Rgb*, const Led_Palette&) {
+	}
+
+	template <uint8_t Index>
+	typename std::enable_if<(Index < sizeof...(Effects))>::type beginAt() {
+		if (current == Index) {
+			std::get<Index>(effects).begin();
+		}
+		else {
+			beginAt<Index + 1>();
+		}
+	}
+
+	template <uint8_t Index>
+	typename std::enable_if<(Index >= sizeof...(Effects))>::type beginAt() {
+	}
+
+	template <uint8_t Index>
+	static typename std::enable_if<(Index < sizeof...(Effects)), const char*>::type nameAt(uint8_t index) {
+		return index == Index ? std::tuple_element<Index, std::tuple<Effects...>>::type::name() : nameAt<Index + 1>(index);
+	}
+
+	template <uint8_t Index>
+	static typename std::enable_if<(Index >= sizeof...(Effects)), const char*>::type nameAt(uint8_t) {
+		return nullptr;
+	}
+
+	std::tuple<Effects...> effects;
+	uint8_t current;
+};
+
+template <class... Effects>
+constexpr uint8_t Effect_Set<Effects...>::count;
+
+#endif // Effect_Set_H
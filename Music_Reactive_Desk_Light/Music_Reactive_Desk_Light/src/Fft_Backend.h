@@ -0,0 +1,43 @@
+/*
+ Name:		Fft_Backend.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Interface of the spectrum stage. The pipeline only needs the bins up to a maximum bin,
+ how they are computed (full FFT, pruned FFT, ...) is up to the backend.
+*/
+#ifndef Fft_Backend_H
+#define Fft_Backend_H
+
+#include "Dsp_Types.h"
+
+/** Class Fft_Backend: real FFT of a window, bins 0 up to maxBin
+*
+*   The output has the layout and scaling of arm_rfft_q15: real and imaginary interleaved,
+*   downscaled by fftSize / 2. Called once per frame, so a virtual call costs nothing.
+*/
+class Fft_Backend {
+
+public:
+
+	virtual ~Fft_Backend() {}
+
+	//! Set the sizes and allocate the buffers
+	/** \param fftSize number of input samples, a power of 2 from 64 to 8192.
+	*   \param maxBin number of output bins, from 1 to fftSize / 2.
+	*   \return false if the sizes are invalid or out of memory.
+	*/
+	virtual bool begin(uint32_t fftSize, uint32_t maxBin) = 0;
+
+	//! Compute bins 0 up to maxBin
+	/** \param input fftSize real samples, not modified.
+	*   \param output 2 * maxBin values.
+	*   \return false if begin() wasn't successful.
+	*/
+	virtual bool transform(const q15_t* input, q15_t* output) = 0;
+
+	//! Number of output bins
+	virtual uint32_t maxBin() const = 0;
+};
+
+#endif // Fft_Backend_H
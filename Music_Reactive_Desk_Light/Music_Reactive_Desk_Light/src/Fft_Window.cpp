@@ -0,0 +1,106 @@
+/*
+ Name:		Fft_Window.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Input conditioning for the FFT.
+*/
+
+#include "Fft_Window.h"
+#include <math.h>
+#include <string.h>
+
+/* Constructor
+*   No window until begin(), a gain of 1.
+*/
+Fft_Window::Fft_Window() : table(nullptr), window_length(0), window_type(WINDOW_TYPE::RECTANGULAR), gain_factor(1) {
+}
+
+Fft_Window::~Fft_Window() {
+	end();
+}
+
+void Fft_Window::end() {
+	delete[] table;
+	table = nullptr;
+	window_length = 0;
+}
+
+/* Compute the periodic window, w[n] for n = 0 .. length - 1 with period length
+*   The periodic form has exactly the sidelobes of the window on the FFT bins.
+*/
+bool Fft_Window::begin(uint32_t length, WINDOW_TYPE type) {
+	if (length < 2) {
+		return false;
+	}
+	end();
+
+	if (type != WINDOW_TYPE::RECTANGULAR) {
+		table = new q15_t[length];
+		if (table == nullptr) {
+			return false;
+		}
+		for (uint32_t n = 0; n < length; n++) {
+			double x = 2 * M_PI * n / length;
+			double w;
+			if (type == WINDOW_TYPE::HANN) {
+				w = 0.5 - 0.5 * cos(x);
+			}
+			else {
+				w = 0.42 - 0.5 * cos(x) + 0.08 * cos(2 * x);
+			}
+			long value = lround(32768.0 * w);
+			table[n] = (q15_t)(value > 32767 ? 32767 : (value < 0 ? 0 : value));
+		}
+	}
+
+	window_length = length;
+	window_type = type;
+	return true;
+}
+
+/* Subtract the bias, apply the gain and the window, in one pass
+*   On the Teensy a pair of samples is loaded as one word, the bias is removed with a saturating
+*   dual subtract and the results are packed back into one word. The tail and the host build
+*   do the same per sample, so both give identical results.
+*/
+void Fft_Window::apply(const q15_t* input, q15_t* output, uint32_t offset, uint32_t count, q15_t bias) const {
+	const q15_t* weights = table != nullptr ? table + offset : nullptr;
+	const int32_t gain = gain_factor;
+
+#if defined(ARDUINO) && defined(__ARM_FEATURE_DSP)
+	const int32_t biasPair = (int32_t)__PKHBT(bias, bias, 16);
+	uint32_t pairs = count >> 1;
+	while (pairs > 0) {
+		int32_t samples;
+		memcpy(&samples, input, sizeof(samples)); // unaligned word load, the offset may be odd
+		int32_t difference = (int32_t)__QSUB16(samples, biasPair);
+		int32_t low = __SSAT((int16_t)difference * gain, 16);
+		int32_t high = __SSAT((difference >> 16) * gain, 16);
+		if (weights != nullptr) {
+			int32_t window;
+			memcpy(&window, weights, sizeof(window));
+			low = ((int16_t)window * low) >> 15; // SMULBB
+			high = ((window >> 16) * high) >> 15; // SMULTB
+			weights += 2;
+		}
+		int32_t packed = (int32_t)__PKHBT(low, high, 16);
+		memcpy(output, &packed, sizeof(packed));
+		input += 2;
+		output += 2;
+		pairs--;
+	}
+	count &= 1;
+#endif
+
+	for (uint32_t i = 0; i < count; i++) {
+		int32_t value = input[i] - bias;
+		value = value > 32767 ? 32767 : (value < -32768 ? -32768 : value);
+		value *= gain;
+		value = value > 32767 ? 32767 : (value < -32768 ? -32768 : value);
+		if (weights != nullptr) {
+			value = (weights[i] * value) >> 15;
+		}
+		output[i] = (q15_t)value;
+	}
+}
@@ -0,0 +1,77 @@
+/*
+ Name:		Fft_Window.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Input conditioning for the FFT. Bias removal, gain, window and copy are done in a single
+ pass over the samples, instead of touching every sample in the interrupt, in a copy loop and again for the window.
+*/
+#ifndef Fft_Window_H
+#define Fft_Window_H
+
+#include "Dsp_Types.h"
+
+//! Window functions
+enum class WINDOW_TYPE : uint8_t {
+	RECTANGULAR, // no window, only bias and gain
+	HANN, // coherent gain 0.5, first sidelobe -31 dB
+	BLACKMAN // coherent gain 0.42, first sidelobe -58 dB
+};
+
+/** Class Fft_Window: fused bias removal, gain and window
+*
+*   output[i] = saturate((input[i] - bias) * gain) * window[offset + i]
+*   The window is a Q15 table computed once in begin(). On the Teensy two samples are processed at a time
+*   with the DSP SIMD instructions, a host build uses the same arithmetic one sample at a time.
+*   The window may be applied in pieces (offset), so a ring buffer can be unwrapped and windowed in one go.
+*/
+class Fft_Window {
+
+public:
+
+	//! Constructor
+	Fft_Window();
+
+	~Fft_Window();
+
+	//! Compute the window table
+	/** \param length window length, at least 2.
+	*   \param type window function, RECTANGULAR doesn't need a table.
+	*   \return false if the length is invalid or out of memory.
+	*/
+	bool begin(uint32_t length, WINDOW_TYPE type);
+
+	//! Set the gain applied before the window
+	/** \param gain integer factor, the result is saturated to 16 bits.
+	*/
+	void setGain(int16_t gain) { gain_factor = gain; }
+
+	//! Condition a piece of the window
+	/** \param input samples, may be the same as output.
+	*   \param output conditioned samples.
+	*   \param offset position of input[0] in the window.
+	*   \param count number of samples, offset + count at most the window length.
+	*   \param bias value subtracted from every sample, the DC level.
+	*/
+	void apply(const q15_t* input, q15_t* output, uint32_t offset, uint32_t count, q15_t bias) const;
+
+	//! Window length
+	uint32_t length() const { return window_length; }
+
+	//! Window function
+	WINDOW_TYPE type() const { return window_type; }
+
+	//! Gain applied before the window
+	int16_t gain() const { return gain_factor; }
+
+private:
+	//! Free the table
+	void end();
+
+	q15_t* table; // Q15 window, nullptr for RECTANGULAR
+	uint32_t window_length;
+	WINDOW_TYPE window_type;
+	int16_t gain_factor;
+};
+
+#endif // Fft_Window_H
@@ -0,0 +1,63 @@
+/*
+ Name:		Full_Rfft.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Spectrum stage with one full size real FFT.
+*/
+
+#include "Full_Rfft.h"
+#include <string.h>
+
+/* Constructor
+*   Nothing is allocated until begin().
+*/
+Full_Rfft::Full_Rfft(Fft_Engine& engine) : fft(engine), fft_size(0), max_bin(0), scratch(nullptr), spectrum(nullptr) {
+}
+
+Full_Rfft::~Full_Rfft() {
+	end();
+}
+
+void Full_Rfft::end() {
+	delete[] scratch;
+	delete[] spectrum;
+	scratch = nullptr;
+	spectrum = nullptr;
+	fft_size = 0;
+}
+
+/* Allocate the scratch copy and the full spectrum
+*
+*/
+bool Full_Rfft::begin(uint32_t fftSize, uint32_t maxBin) {
+	if (fftSize < 64 || fftSize > 8192 || (fftSize & (fftSize - 1)) != 0 || maxBin == 0 || maxBin > fftSize / 2) {
+		return false;
+	}
+	end();
+
+	scratch = new q15_t[fftSize];
+	spectrum = new q15_t[2 * fftSize];
+	if (scratch == nullptr || spectrum == nullptr) {
+		end();
+		return false;
+	}
+	fft_size = fftSize;
+	max_bin = maxBin;
+	return true;
+}
+
+/* Transform a copy of the input, keep bins 0 up to maxBin
+*
+*/
+bool Full_Rfft::transform(const q15_t* input, q15_t* output) {
+	if (fft_size == 0) {
+		return false;
+	}
+	memcpy(scratch, input, fft_size * sizeof(q15_t));
+	if (!fft.rfft(scratch, spectrum, fft_size)) {
+		return false;
+	}
+	memcpy(output, spectrum, 2 * max_bin * sizeof(q15_t));
+	return true;
+}
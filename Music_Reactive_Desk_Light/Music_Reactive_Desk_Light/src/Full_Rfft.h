@@ -0,0 +1,47 @@
+/*
+ Name:		Full_Rfft.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Spectrum stage with one full size real FFT, the reference for Pruned_Rfft.
+*/
+#ifndef Full_Rfft_H
+#define Full_Rfft_H
+
+#include "Dsp_Types.h"
+#include "Fft_Backend.h"
+#include "Fft_Engine.h"
+
+/** Class Full_Rfft: fftSize point real FFT, bins above maxBin are discarded
+*
+*   The input is copied first, the FFT uses its input as scratch.
+*/
+class Full_Rfft : public Fft_Backend {
+
+public:
+
+	//! Constructor
+	/** \param engine FFT engine, keeps the plan.
+	*/
+	Full_Rfft(Fft_Engine& engine);
+
+	~Full_Rfft();
+
+	bool begin(uint32_t fftSize, uint32_t maxBin) override;
+
+	bool transform(const q15_t* input, q15_t* output) override;
+
+	uint32_t maxBin() const override { return max_bin; }
+
+private:
+	//! Free the buffers
+	void end();
+
+	Fft_Engine& fft;
+	uint32_t fft_size;
+	uint32_t max_bin;
+	q15_t* scratch; // copy of the input
+	q15_t* spectrum; // all 2 * fftSize values
+};
+
+#endif // Full_Rfft_H
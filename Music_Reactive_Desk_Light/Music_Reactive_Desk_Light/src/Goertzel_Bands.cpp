@@ -0,0 +1,122 @@
+/*
+ Name:		Goertzel_Bands.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Band energy from a bank of Goertzel filters.
+*/
+
+#include "Goertzel_Bands.h"
+#include <math.h>
+
+/* Constructor
+*   No filters until begin().
+*/
+Goertzel_Bands::Goertzel_Bands() : num_filters(0), num_bands(0), block_length(0), sample_count(0), band_scale{}, band_magnitude{} {
+}
+
+/* Tune the filters to bins spread evenly over every band
+*   Filter i of a band with bins [first, end) and F filters sits at bin first + (i + 1/2) * (end - first) / F.
+*/
+bool Goertzel_Bands::begin(const Band_Map& map, uint8_t filtersPerBand) {
+	if (map.numBands() == 0 || filtersPerBand == 0) {
+		return false;
+	}
+
+	// 32 bits, a uint8_t wraps for e.g. 3 bands of 86 filters and would let them past the check
+	uint32_t count = 0;
+	for (uint8_t b = 0; b < map.numBands(); b++) {
+		uint32_t bins = map.band(b).endBin - map.band(b).firstBin;
+		count += bins < filtersPerBand ? bins : filtersPerBand;
+	}
+	if (count > GOERTZEL_MAX_FILTERS) {
+		return false;
+	}
+
+	num_filters = 0;
+	num_bands = map.numBands();
+	block_length = map.fftSize();
+	sample_count = 0;
+
+	for (uint8_t b = 0; b < num_bands; b++) {
+		uint32_t first = map.band(b).firstBin;
+		uint32_t bins = map.band(b).endBin - first;
+		uint32_t filterCount = bins < filtersPerBand ? bins : filtersPerBand;
+
+		for (uint32_t i = 0; i < filterCount; i++) {
+			uint32_t bin = first + ((2 * i + 1) * bins) / (2 * filterCount);
+			float w = 2 * (float)M_PI * bin / block_length;
+			Filter& filter = filters[num_filters++];
+			filter.cosine = cosf(w);
+			filter.sine = sinf(w);
+			filter.coeff = 2 * filter.cosine;
+			filter.s1 = 0;
+			filter.s2 = 0;
+			filter.band = b;
+		}
+		band_scale[b] = filterCount ? 1.0f / filterCount : 0;
+		band_magnitude[b] = 0;
+	}
+	return true;
+}
+
+/* Run the filters: s[n] = x[n] + 2 cos(w) s[n - 1] - s[n - 2]
+*   The samples are processed filter by filter, so the states stay in registers.
+*   Chunks are split at block boundaries.
+*/
+bool Goertzel_Bands::process(const q15_t* samples, uint32_t count) {
+	bool completed = false;
+
+	while (count > 0 && num_filters > 0) {
+		uint32_t chunk = block_length - sample_count;
+		if (chunk > count) {
+			chunk = count;
+		}
+
+		for (uint8_t f = 0; f < num_filters; f++) {
+			Filter& filter = filters[f];
+			float coeff = filter.coeff;
+			float s1 = filter.s1;
+			float s2 = filter.s2;
+			for (uint32_t i = 0; i < chunk; i++) {
+				float s0 = samples[i] + coeff * s1 - s2;
+				s2 = s1;
+				s1 = s0;
+			}
+			filter.s1 = s1;
+			filter.s2 = s2;
+		}
+
+		samples += chunk;
+		count -= chunk;
+		sample_count += chunk;
+		if (sample_count == block_length) {
+			finishBlock();
+			completed = true;
+		}
+	}
+	return completed;
+}
+
+/* After N samples the DFT value of the filter's bin is X = (s1 cos(w) - s2) + j s1 sin(w).
+*   The mean power of the filtered bins estimates the mean power of all bins in the band.
+*   arm_rfft_q15 scales X by 1 / (fftSize / 2), the same is done here.
+*/
+void Goertzel_Bands::finishBlock() {
+	float power[BAND_MAP_MAX_BANDS] = {};
+
+	for (uint8_t f = 0; f < num_filters; f++) {
+		Filter& filter = filters[f];
+		float re = filter.s1 * filter.cosine - filter.s2;
+		float im = filter.s1 * filter.sine;
+		power[filter.band] += re * re + im * im;
+		filter.s1 = 0;
+		filter.s2 = 0;
+	}
+
+	const float scale = (float)(1 << BAND_ENERGY_FRACTION_BITS) / (block_length / 2);
+	for (uint8_t b = 0; b < num_bands; b++) {
+		band_magnitude[b] = (q31_t)(sqrtf(power[b] * band_scale[b]) * scale);
+	}
+	sample_count = 0;
+}
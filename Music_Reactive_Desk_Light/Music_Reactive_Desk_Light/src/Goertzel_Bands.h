@@ -0,0 +1,79 @@
+/*
+ Name:		Goertzel_Bands.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Band energy from a bank of Goertzel filters, an alternative to the full FFT when only
+ a few band levels are needed. Samples are processed as they arrive, block by block.
+*/
+#ifndef Goertzel_Bands_H
+#define Goertzel_Bands_H
+
+#include "Dsp_Types.h"
+#include "Band_Map.h"
+#include "Band_Energy.h"
+
+#define GOERTZEL_MAX_FILTERS 32 // filters over all bands
+
+/** Class Goertzel_Bands: per band sums from a Goertzel filter bank
+*
+*   Every band gets a number of filters tuned to FFT bins spread evenly over its bin range.
+*   After fftSize samples each filter holds exactly the DFT value of its bin. The RMS magnitude of a band
+*   is estimated from the powers of those bins and scaled to the units of Band_Energy::magnitude(),
+*   with the scaling of arm_rfft_q15. So the same band to led mapping applies.
+*/
+class Goertzel_Bands {
+
+public:
+
+	//! Constructor
+	Goertzel_Bands();
+
+	//! Tune the filters
+	/** \param map bin ranges of the bands, also gives the block length (fftSize).
+	*   \param filtersPerBand filters in every band, bands with fewer bins get one per bin.
+	*   \return false if the map is empty or there are more than GOERTZEL_MAX_FILTERS filters.
+	*/
+	bool begin(const Band_Map& map, uint8_t filtersPerBand);
+
+	//! Run the filters over the samples
+	/** Samples may be passed in any chunk size, a block ends after every fftSize samples.
+	*   \param samples input samples.
+	*   \param count number of samples.
+	*   \return true if at least one block was completed, magnitude() then returns the latest one.
+	*/
+	bool process(const q15_t* samples, uint32_t count);
+
+	//! RMS magnitude of a band in the latest completed block
+	/** \param band index of the band.
+	*   \return same units as Band_Energy::magnitude().
+	*/
+	q31_t magnitude(uint8_t band) const { return band_magnitude[band]; }
+
+	//! Number of filters in use
+	uint8_t numFilters() const { return num_filters; }
+
+private:
+	struct Filter {
+		float coeff; // 2 cos(w)
+		float cosine;
+		float sine;
+		float s1; // state, s[n - 1]
+		float s2; // state, s[n - 2]
+		uint8_t band;
+	};
+
+	//! End of a block: store the band magnitudes and reset the filters
+	void finishBlock();
+
+	Filter filters[GOERTZEL_MAX_FILTERS];
+	uint8_t num_filters;
+	uint8_t num_bands;
+	uint32_t block_length;
+	uint32_t sample_count; // samples in the current block
+
+	float band_scale[BAND_MAP_MAX_BANDS]; // 1 / filters in the band
+	q31_t band_magnitude[BAND_MAP_MAX_BANDS];
+};
+
+#endif // Goertzel_Bands_H
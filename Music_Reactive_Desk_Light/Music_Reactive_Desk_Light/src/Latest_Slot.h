@@ -0,0 +1,85 @@
+/*
+ Name:		Latest_Slot.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Lock-free latest value exchange between one writer and one reader, e.g. the analysis and
+ the led renderer. The reader always gets the newest complete value, older ones are overwritten.
+*/
+#ifndef Latest_Slot_H
+#define Latest_Slot_H
+
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+
+/** Class Latest_Slot: triple buffer for one writer and one reader
+*
+*   Usage:
+*   \code
+*   slot.publish(frame); // writer
+*
+*   if (slot.update()) { // reader
+*       use(slot.value());
+*   }
+*   \endcode
+*   The writer fills its own buffer and swaps it with the middle one, the reader swaps its buffer with the
+*   middle one when the middle one holds a newer value. Both swaps are a single atomic exchange, so neither
+*   side ever waits and a value is never read while it is being written.
+*
+*   \tparam T trivially copyable value type.
+*/
+template <class T>
+class Latest_Slot {
+	static_assert(std::is_trivially_copyable<T>::value, "values are copied whole");
+
+public:
+
+	//! Constructor, value() is a zero T until the first update() that returns true
+	Latest_Slot() : buffers{}, middle(1), back(0), front(2), values_published(0) {
+	}
+
+	/*
+	* Writer side
+	*/
+
+	//! Make a value the latest
+	void publish(const T& value) {
+		buffers[back] = value;
+		back = middle.exchange(back | SLOT_FRESH, std::memory_order_acq_rel) & SLOT_INDEX; // release the value, acquire the free buffer
+		values_published++;
+	}
+
+	//! Number of values published
+	uint32_t published() const { return values_published; }
+
+	/*
+	* Reader side
+	*/
+
+	//! Take the latest value if there is a newer one than value()
+	/** \return true if value() changed.
+	*/
+	bool update() {
+		if ((middle.load(std::memory_order_relaxed) & SLOT_FRESH) == 0) {
+			return false;
+		}
+		front = middle.exchange(front, std::memory_order_acq_rel) & SLOT_INDEX;
+		return true;
+	}
+
+	//! Value taken by the last update()
+	const T& value() const { return buffers[front]; }
+
+private:
+	static const uint8_t SLOT_INDEX = 0x03;
+	static const uint8_t SLOT_FRESH = 0x04; // set by publish(), the middle buffer hasn't been read
+
+	T buffers[3];
+	std::atomic<uint8_t> middle; // index of the buffer between the two sides and SLOT_FRESH
+	uint8_t back; // written by the writer only
+	uint8_t front; // read by the reader only
+	volatile uint32_t values_published;
+};
+
+#endif // Latest_Slot_H
@@ -0,0 +1,115 @@
+/*
+ Name:		Led_Color.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: HSV conversion for host builds, the Teensy uses FastLED's.
+*/
+
+#include "Led_Color.h"
+
+#ifndef ARDUINO
+
+//! FastLED scale8: i * (scale + 1) / 256
+static inline uint8_t scale8(uint8_t i, uint8_t scale) {
+	return (uint8_t)(((uint16_t)i * (1 + (uint16_t)scale)) >> 8);
+}
+
+//! FastLED scale8_video: like scale8, but never scales a non zero value to 0
+static inline uint8_t scale8Video(uint8_t i, uint8_t scale) {
+	return (uint8_t)((((uint16_t)i * scale) >> 8) + ((i && scale) ? 1 : 0));
+}
+
+/* Port of hsv2rgb_rainbow
+*   The hue circle has 8 sections of 32 hues: red, orange, yellow, green, aqua, blue, purple, pink.
+*   Yellow gets extra width (FastLED's Y1 option), no green scaling.
+*/
+Rgb hsvColor(uint8_t hue, uint8_t saturation, uint8_t value) {
+	const uint8_t offset8 = (uint8_t)((hue & 0x1F) << 3); // position in the section, 0 to 248
+	const uint8_t third = scale8(offset8, 256 / 3); // max 85
+	const uint8_t twoThirds = scale8(offset8, (256 * 2) / 3); // max 170
+	uint8_t r, g, b;
+
+	switch (hue >> 5) {
+	case 0: // red to orange
+		r = 255 - third;
+		g = third;
+		b = 0;
+		break;
+	case 1: // orange to yellow
+		r = 171;
+		g = 85 + third;
+		b = 0;
+		break;
+	case 2: // yellow to green
+		r = 171 - twoThirds;
+		g = 170 + third;
+		b = 0;
+		break;
+	case 3: // green to aqua
+		r = 0;
+		g = 255 - third;
+		b = third;
+		break;
+	case 4: // aqua to blue
+		r = 0;
+		g = 171 - twoThirds;
+		b = 85 + twoThirds;
+		break;
+	case 5: // blue to purple
+		r = third;
+		g = 0;
+		b = 255 - third;
+		break;
+	case 6: // purple to pink
+		r = 85 + third;
+		g = 0;
+		b = 171 - third;
+		break;
+	default: // pink to red
+		r = 170 + third;
+		g = 0;
+		b = 85 - third;
+		break;
+	}
+
+	// desaturate towards white
+	if (saturation != 255) {
+		if (saturation == 0) {
+			r = 255;
+			g = 255;
+			b = 255;
+		}
+		else {
+			uint8_t desaturation = 255 - saturation;
+			desaturation = scale8Video(desaturation, desaturation);
+			const uint8_t saturationScale = 255 - desaturation;
+			if (r) r = scale8(r, saturationScale) + 1;
+			if (g) g = scale8(g, saturationScale) + 1;
+			if (b) b = scale8(b, saturationScale) + 1;
+			r += desaturation;
+			g += desaturation;
+			b += desaturation;
+		}
+	}
+
+	// scale down to the value, with a gamma like dimming curve
+	if (value != 255) {
+		value = scale8Video(value, value);
+		if (value == 0) {
+			r = 0;
+			g = 0;
+			b = 0;
+		}
+		else {
+			if (r) r = scale8(r, value) + 1;
+			if (g) g = scale8(g, value) + 1;
+			if (b) b = scale8(b, value) + 1;
+		}
+	}
+
+	Rgb color = { r, g, b };
+	return color;
+}
+
+#endif
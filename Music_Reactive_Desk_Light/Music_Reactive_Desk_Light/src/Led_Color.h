@@ -0,0 +1,50 @@
+/*
+ Name:		Led_Color.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Led colour type and HSV conversion. On the Teensy these are FastLED's CRGB and
+ hsv2rgb_rainbow, a host build gets a plain struct and a port of the same conversion,
+ so rendered frames are identical.
+*/
+#ifndef Led_Color_H
+#define Led_Color_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include "FastLED.h"
+
+typedef CRGB Rgb;
+
+//! FastLED rainbow hue to RGB
+inline Rgb hsvColor(uint8_t hue, uint8_t saturation, uint8_t value) {
+	CRGB color;
+	hsv2rgb_rainbow(CHSV(hue, saturation, value), color);
+	return color;
+}
+#else
+//! Led colour, the byte layout of CRGB
+struct Rgb {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+};
+
+//! Port of FastLED's hsv2rgb_rainbow
+/** \param hue 0 to 255 around the colour wheel, red at 0.
+*   \param saturation 0 (white) to 255.
+*   \param value 0 (black) to 255.
+*/
+Rgb hsvColor(uint8_t hue, uint8_t saturation, uint8_t value);
+#endif
+
+//! Colour dimmed to a fraction, channel * (scale + 1) / 256 like FastLED's scale8
+inline Rgb scaleColor(Rgb color, uint8_t scale) {
+	color.r = (uint8_t)(((uint16_t)color.r * (scale + 1)) >> 8);
+	color.g = (uint8_t)(((uint16_t)color.g * (scale + 1)) >> 8);
+	color.b = (uint8_t)(((uint16_t)color.b * (scale + 1)) >> 8);
+	return color;
+}
+
+#endif // Led_Color_H
@@ -0,0 +1,214 @@
+/*
+ Name:		Led_Effects.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The visualizers of the desk light: vu bars, spectrum, beat pulse, centre mirror and
+ waterfall. Each draws a whole led frame from the band levels and the spectrum bars, see Effect_Set.h.
+*/
+#ifndef Led_Effects_H
+#define Led_Effects_H
+
+#include <stdint.h>
+#include <string.h>
+#include "Effect_Set.h"
+#include "Pipeline_Params.h"
+
+#define EFFECT_SPECTRUM_FALL 600 // levels per second a spectrum led dims at most, a full led goes dark in 0.4 s
+#define EFFECT_BEAT_RISE 3 // a beat is a bass level above (1 + 1 / EFFECT_BEAT_RISE) times its average
+#define EFFECT_BEAT_MIN 6554 // and above 10 % of the segment, 65536 is a full segment
+#define EFFECT_BEAT_GAP_US 150000 // shortest time between two beats
+#define EFFECT_BEAT_FADE_US 300000 // time a pulse takes to fade out
+
+//! Height of a level in its segment, 65536 for a full segment
+inline uint32_t effectFraction(uint32_t level, uint16_t numLeds) {
+	return (uint32_t)(((uint64_t)level << (16 - BAND_FRAME_FRACTION_BITS)) / numLeds);
+}
+
+/** Class Vu_Bars: a bar per band segment with the hue running along the strip, and a peak marker above each bar
+*/
+template <class Config>
+class Vu_Bars {
+
+public:
+
+	static const char* name() { return "vu"; }
+
+	void begin() {}
+
+	void render(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) {
+		uint8_t hue = LED_FIRST_HUE;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const Led_Segment segment = Config::ledSegment(b);
+			uint32_t ledsOn = input.levels[b] >> BAND_FRAME_FRACTION_BITS;
+			uint32_t peak = input.peaks[b] >> BAND_FRAME_FRACTION_BITS;
+			ledsOn = ledsOn < segment.numLeds ? ledsOn : segment.numLeds;
+			peak = peak < segment.numLeds ? peak : segment.numLeds;
+			palette.fillBar(leds, segment, (uint16_t)ledsOn, hue);
+			if (peak > ledsOn) {
+				leds[segment.firstLed + peak - 1] = palette.color((uint8_t)(hue + peak - 1)); // its own colour, the gap below sets it apart
+			}
+			hue += segment.numLeds;
+		}
+	}
+};
+
+/** Class Spectrum_Effect: a spectrum bar per led, low to high frequencies along the strip, the level sets the brightness
+*
+*   A led follows its bar up at once and falls by at most EFFECT_SPECTRUM_FALL levels per second.
+*   Dark without a spectrum, e.g. with the Goertzel engine.
+*/
+template <class Config>
+class Spectrum_Effect {
+
+public:
+
+	static const char* name() { return "spectrum"; }
+
+	void begin() {
+		memset(levels, 0, sizeof(levels));
+	}
+
+	void render(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) {
+		const Band_Frame& frame = *input.frame;
+		const uint32_t fall = (uint32_t)((uint64_t)EFFECT_SPECTRUM_FALL * 256 * input.elapsed / 1000000); // levels with 8 fractional bits
+		uint8_t hue = LED_FIRST_HUE;
+		for (uint16_t i = 0; i < Config::numLeds; i++) {
+			const uint32_t bar = frame.spectrumBars > 0 ? (uint32_t)frame.spectrum[(uint32_t)i * frame.spectrumBars / Config::numLeds] << 8 : 0;
+			levels[i] = bar >= levels[i] ? bar : levels[i] - bar > fall ? levels[i] - fall : bar;
+			leds[i] = scaleColor(palette.color(hue++), (uint8_t)(levels[i] >> 8));
+		}
+	}
+
+private:
+	uint32_t levels[Config::numLeds]; // shown level of every led, 8 fractional bits
+};
+
+/** Class Beat_Pulse: the whole strip flashes on every bass beat and fades, the colour moves on with every beat
+*/
+template <class Config>
+class Beat_Pulse {
+
+public:
+
+	static const char* name() { return "pulse"; }
+
+	void begin() {
+		average = 0;
+		pulse = 0;
+		hue = LED_FIRST_HUE;
+		last_beat = 0;
+		beat_seen = false;
+	}
+
+	void render(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) {
+		if (input.newFrame) {
+			const uint32_t bass = effectFraction(input.frame->leds[0], Config::ledSegment(0).numLeds);
+			if (bass > average + average / EFFECT_BEAT_RISE && bass > EFFECT_BEAT_MIN && (!beat_seen || input.now - last_beat >= EFFECT_BEAT_GAP_US)) {
+				pulse = 255 << 8;
+				hue += 40;
+				last_beat = input.now;
+				beat_seen = true;
+			}
+			average = (uint32_t)((int32_t)average + ((int32_t)bass - (int32_t)average) / 8); // about the last 8 frames
+		}
+		const uint32_t fade = (uint32_t)((uint64_t)(255 << 8) * input.elapsed / EFFECT_BEAT_FADE_US);
+		pulse = pulse > fade ? pulse - fade : 0;
+
+		const Rgb color = scaleColor(palette.color(hue), (uint8_t)(pulse >> 8));
+		for (uint16_t i = 0; i < Config::numLeds; i++) {
+			leds[i] = color;
+		}
+	}
+
+private:
+	uint32_t average; // bass level, 65536 for a full segment
+	uint32_t pulse; // brightness with 8 fractional bits
+	uint8_t hue;
+	uint32_t last_beat; // time of the last beat in us
+	bool beat_seen;
+};
+
+/** Class Center_Mirror: the loudest band as a bar from the centre of the strip to both ends
+*/
+template <class Config>
+class Center_Mirror {
+
+public:
+
+	static const char* name() { return "mirror"; }
+
+	void begin() {}
+
+	void render(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) {
+		uint32_t loudest = 0;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const uint32_t fraction = effectFraction(input.levels[b], Config::ledSegment(b).numLeds);
+			loudest = fraction > loudest ? fraction : loudest;
+		}
+		const uint16_t center = Config::numLeds / 2;
+		const uint32_t half = (Config::numLeds + 1) / 2;
+		uint32_t lit = (uint32_t)(((uint64_t)loudest * half) >> 16);
+		lit = lit < half ? lit : half;
+
+		memset(leds, 0, Config::numLeds * sizeof(Rgb));
+		for (uint32_t d = 0; d < lit; d++) {
+			const Rgb color = palette.color((uint8_t)(LED_FIRST_HUE + 2 * d)); // twice the hue steps, both halves hold the whole bar
+			if (center + d < Config::numLeds) {
+				leds[center + d] = color;
+			}
+			if (d <= center) {
+				leds[center - d] = color;
+			}
+		}
+	}
+};
+
+/** Class Waterfall: every analysis frame adds the colour of its loudest band at the start of the strip
+*   and pushes the older ones along, a history of the last Config::numLeds frames
+*/
+template <class Config>
+class Waterfall {
+
+public:
+
+	static const char* name() { return "waterfall"; }
+
+	void begin() {
+		memset(history, 0, sizeof(history));
+	}
+
+	void render(const Effect_Input& input, Rgb* leds, const Led_Palette& palette) {
+		if (input.newFrame) {
+			uint8_t loudestBand = 0;
+			uint32_t loudest = 0;
+			for (uint8_t b = 0; b < Config::numBands; b++) {
+				const uint32_t fraction = effectFraction(input.frame->leds[b], Config::ledSegment(b).numLeds);
+				if (fraction > loudest) {
+					loudest = fraction;
+					loudestBand = b;
+				}
+			}
+			const Led_Segment segment = Config::ledSegment(loudestBand);
+			memmove(history + 1, history, (Config::numLeds - 1) * sizeof(Rgb));
+			history[0] = scaleColor(palette.color((uint8_t)(LED_FIRST_HUE + segment.firstLed + segment.numLeds / 2)), // the colour of the band in the vu bars
+				(uint8_t)(loudest < 65535 ? loudest >> 8 : 255));
+		}
+		memcpy(leds, history, sizeof(history));
+	}
+
+private:
+	Rgb history[Config::numLeds];
+};
+
+//! The effects of the desk light, in the order of LED_EFFECT
+template <class Config>
+struct Desk_Light_Effect_List {
+	typedef Effect_Set<Vu_Bars<Config>, Spectrum_Effect<Config>, Beat_Pulse<Config>, Center_Mirror<Config>, Waterfall<Config>> type;
+	static_assert(type::count == (uint8_t)LED_EFFECT::COUNT, "an effect for every LED_EFFECT");
+};
+
+template <class Config>
+using Desk_Light_Effects = typename Desk_Light_Effect_List<Config>::type;
+
+#endif // Led_Effects_H
@@ -0,0 +1,39 @@
+/*
+ Name:		Led_Palette.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Hue table and bar rendering.
+*/
+
+#include "Led_Palette.h"
+#include <string.h>
+
+Led_Palette::Led_Palette() {
+	memset(table, 0, sizeof(table));
+}
+
+void Led_Palette::begin(uint8_t saturation, uint8_t value) {
+	for (uint16_t hue = 0; hue < 256; hue++) {
+		table[hue] = hsvColor((uint8_t)hue, saturation, value);
+	}
+}
+
+/* The lit leds are a run of consecutive hues, one copy from the table or two where the hue wraps from 255 to 0.
+*   A dark led is black whatever its hue (hsvColor with value 0), so the rest of the bar is cleared.
+*/
+void Led_Palette::fillBar(Rgb* leds, const Led_Segment& segment, uint16_t ledsOn, uint8_t firstHue) const {
+	Rgb* led = leds + segment.firstLed;
+	if (ledsOn > segment.numLeds) {
+		ledsOn = segment.numLeds;
+	}
+	uint16_t hue = firstHue;
+	uint16_t done = 0;
+	while (done < ledsOn) {
+		const uint16_t run = ledsOn - done < 256 - hue ? ledsOn - done : 256 - hue;
+		memcpy(led + done, table + hue, run * sizeof(Rgb));
+		done += run;
+		hue = 0; // every later run starts at the wrap
+	}
+	memset(led + ledsOn, 0, (segment.numLeds - ledsOn) * sizeof(Rgb));
+}
@@ -0,0 +1,54 @@
+/*
+ Name:		Led_Palette.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Hue to RGB table for the led rendering. The 256 colours of a saturation and brightness
+ are converted once, rendering a bar is then block copies from the table and a clear of the dark leds.
+*/
+#ifndef Led_Palette_H
+#define Led_Palette_H
+
+#include <stdint.h>
+#include "Led_Color.h"
+#include "Pipeline_Config.h"
+
+#define LED_FIRST_HUE 100 // hue of the first led of the strip, the hue advances by one per led
+
+/** Class Led_Palette: precomputed hsvColor() of every hue
+*
+*   Usage:
+*   \code
+*   palette.begin(255, 255);
+*   palette.fillBar(leds, segment, ledsOn, hue); // same leds as hsvColor(hue + i, 255, i < ledsOn ? 255 : 0)
+*   \endcode
+*/
+class Led_Palette {
+
+public:
+
+	//! Constructor, the palette is black until begin()
+	Led_Palette();
+
+	//! Compute the table
+	/** \param saturation saturation of every colour, 0 (white) to 255.
+	*   \param value brightness of every colour, 0 (black) to 255.
+	*/
+	void begin(uint8_t saturation, uint8_t value);
+
+	//! Colour of a hue
+	Rgb color(uint8_t hue) const { return table[hue]; }
+
+	//! Render a bar: the first leds of a segment lit with consecutive hues, the rest black
+	/** \param leds led frame.
+	*   \param segment leds of the bar in the frame.
+	*   \param ledsOn leds lit, at most segment.numLeds.
+	*   \param firstHue hue of the first led of the segment, the hue advances by one per led, lit or not.
+	*/
+	void fillBar(Rgb* leds, const Led_Segment& segment, uint16_t ledsOn, uint8_t firstHue) const;
+
+private:
+	Rgb table[256];
+};
+
+#endif // Led_Palette_H
@@ -0,0 +1,256 @@
+/*
+ Name:		Led_Renderer.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Led output at its own frame rate, independent of the analysis. The bars glide between
+ the analysis frames, rise and fall with attack and decay rates and leave a peak marker behind.
+*/
+#ifndef Led_Renderer_H
+#define Led_Renderer_H
+
+#include <stdint.h>
+#include <string.h>
+#include "Led_Sink.h"
+#include "Led_Color.h"
+#include "Led_Palette.h"
+#include "Band_Frame.h"
+#include "Latest_Slot.h"
+#include "Stage_Profiler.h"
+#include "Effect_Set.h"
+#include "Led_Effects.h"
+
+//! Motion of the bars, rates of 0 follow the analysis at once
+struct Led_Envelope {
+	uint16_t attack; // leds per second a bar rises at most
+	uint16_t decay; // leds per second a bar falls at most
+	uint16_t peakHold; // ms the peak marker stays at the highest level
+	uint16_t peakDecay; // leds per second the peak marker falls after the hold
+};
+
+/** Class Led_Renderer: renders and shows the led frames on a fixed cadence with a selectable effect
+*
+*   Usage:
+*   \code
+*   pipeline.setLedOutput(false); // the renderer shows the frames
+*   renderer.begin((uint32_t)((uint64_t)Config::hopSize * 1000000 / source.sampleRate()), envelope);
+*   while (true) {
+*       pipeline.process();
+*       if (micros() - lastRender >= renderPeriod) {
+*           renderer.render(micros());
+*       }
+*   }
+*   \endcode
+*   The analysis publishes a Band_Frame per hop into a Latest_Slot, the renderer takes the newest one when it
+*   renders, they may run at any rates and in different threads or interrupts. Each new frame starts a glide
+*   from the bar position of the moment to the new level that takes one analysis frame, so the bars move
+*   continuously at the cost of one hop of latency. Attack and decay limit the speed of the bars on top of that.
+*   The peak marker is the led of the highest recent level.
+*   The selected effect draws the frame from these levels, see Led_Effects.h. The effect of the band frames
+*   (Pipeline_Params::effect) is selected when it changes, effects() selects directly.
+*   Frames equal to the previous one go to Led_Sink::repeat(), see Audio_Pipeline.
+*
+*   \tparam Config a Pipeline_Config, gives the leds and the band segments.
+*   \tparam Effects an Effect_Set.
+*/
+template <class Config, class Effects = Desk_Light_Effects<Config>>
+class Led_Renderer {
+
+public:
+
+	//! Constructor
+	/** \param input latest frame of the analysis, e.g. Audio_Pipeline::bandFrames().
+	*   \param output receives the led frames.
+	*/
+	Led_Renderer(Latest_Slot<Band_Frame>& input, Led_Sink& output) : slot(input), sink(output), envelope{}, frame_micros(0),
+		leds{}, shown{}, from{}, to{}, display{}, peak{}, peak_time{}, leds_on{}, peak_led{}, shown_valid(false), brightness(255),
+		effect(0), new_frame(false), arrival(0), last_render(0), rendered(false), frames_rendered(0), frames_unchanged(0), frames_received(0) {
+		palette.begin(255, 255); // full colours, the sink scales the brightness
+	}
+
+	//! Start from dark bars
+	/** \param frameMicros duration of an analysis frame (a hop) in us, the time a glide takes.
+	*   \param motion attack, decay and peak marker.
+	*/
+	void begin(uint32_t frameMicros, const Led_Envelope& motion) {
+		envelope = motion;
+		frame_micros = frameMicros;
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			from[b] = 0;
+			to[b] = 0;
+			display[b] = 0;
+			peak[b] = 0;
+			leds_on[b] = 0;
+			peak_led[b] = 0;
+		}
+		shown_valid = false;
+		new_frame = false;
+		rendered = false;
+		effect_set.select(effect_set.selected()); // clear the effect's state
+		frames_rendered = 0;
+		frames_unchanged = 0;
+		frames_received = 0;
+		stage_profiler.begin();
+	}
+
+	//! Render the bars at a point in time and output the frame
+	/** \param now time in us, e.g. micros(), may wrap around.
+	*   \return true if the frame was sent to the sink, false if it was unchanged.
+	*/
+	bool render(uint32_t now) {
+		const uint32_t start = Stage_Profiler::now();
+		if (slot.update()) {
+			take(slot.value(), now);
+		}
+		const uint32_t elapsed = rendered ? now - last_render : 0;
+		last_render = now;
+		rendered = true;
+
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const uint32_t goal = glide(b, now);
+			display[b] = approach(display[b], goal, goal > display[b] ? envelope.attack : envelope.decay, elapsed);
+			if (display[b] >= peak[b]) {
+				peak[b] = display[b];
+				peak_time[b] = now;
+			}
+			else if (now - peak_time[b] >= (uint32_t)envelope.peakHold * 1000) {
+				peak[b] = approach(peak[b], display[b], envelope.peakDecay, elapsed);
+			}
+
+			leds_on[b] = (uint16_t)(display[b] >> BAND_FRAME_FRACTION_BITS);
+			const uint16_t peakLeds = (uint16_t)(peak[b] >> BAND_FRAME_FRACTION_BITS);
+			peak_led[b] = peakLeds > leds_on[b] ? peakLeds : 0;
+		}
+		const Effect_Input input = { display, peak, &slot.value(), new_frame, now, elapsed };
+		effect_set.render(input, leds, palette);
+		new_frame = false;
+		uint32_t time = stage_profiler.lap(PIPELINE_STAGE::LED_FILL, start);
+
+		const bool changed = frameChanged();
+		if (changed) {
+			sink.show(leds, Config::numLeds);
+			time = stage_profiler.lap(PIPELINE_STAGE::SHOW, time);
+		}
+		else {
+			sink.repeat(leds, Config::numLeds);
+			time = Stage_Profiler::now();
+			frames_unchanged++;
+		}
+		stage_profiler.record(PIPELINE_STAGE::FRAME, time - start);
+		frames_rendered++;
+		return changed;
+	}
+
+	//! Led frame, rendered by render()
+	Rgb* ledFrame() { return leds; }
+
+	//! Number of leds lit in the segment of a band in the latest frame
+	uint16_t ledsOn(uint8_t band) const { return leds_on[band]; }
+
+	//! Position of the peak marker of a band in the latest frame, counted from 1, 0 if it isn't shown
+	uint16_t peakLed(uint8_t band) const { return peak_led[band]; }
+
+	//! Bar height of a band in leds with BAND_FRAME_FRACTION_BITS fractional bits
+	uint32_t level(uint8_t band) const { return display[band]; }
+
+	//! Number of frames rendered since begin()
+	uint32_t framesRendered() const { return frames_rendered; }
+
+	//! Number of rendered frames since begin() that were equal to the previous one and went to Led_Sink::repeat()
+	uint32_t framesUnchanged() const { return frames_unchanged; }
+
+	//! Number of analysis frames taken since begin(), frames published faster than the render rate are skipped
+	uint32_t framesReceived() const { return frames_received; }
+
+	//! Render timing: LED_FILL, SHOW and FRAME, cleared by begin()
+	Stage_Profiler& profiler() { return stage_profiler; }
+
+	//! The effects, the selected one draws the frames
+	Effects& effects() { return effect_set; }
+
+private:
+	//! Start the glide to a new analysis frame from where the bars are now
+	void take(const Band_Frame& frame, uint32_t now) {
+		for (uint8_t b = 0; b < Config::numBands; b++) {
+			const uint32_t full = (uint32_t)Config::ledSegment(b).numLeds << BAND_FRAME_FRACTION_BITS;
+			from[b] = glide(b, now);
+			to[b] = frame.leds[b] < full ? frame.leds[b] : full;
+		}
+		arrival = now;
+		if (frame.effect != effect) {
+			effect = frame.effect;
+			effect_set.select(effect); // an unknown effect keeps the current one
+		}
+		if (frame.brightness != brightness) {
+			brightness = frame.brightness;
+			sink.setBrightness(brightness);
+			shown_valid = false; // the strip only takes the brightness with the next frame sent
+		}
+		new_frame = true;
+		frames_received++;
+	}
+
+	//! Level of a band on the glide between the last two analysis frames
+	uint32_t glide(uint8_t band, uint32_t now) const {
+		const uint32_t elapsed = now - arrival;
+		if (elapsed >= frame_micros) {
+			return to[band];
+		}
+		return (uint32_t)((int64_t)from[band] + ((int64_t)to[band] - from[band]) * elapsed / frame_micros);
+	}
+
+	//! Move a level towards a goal by at most rate leds per second
+	static uint32_t approach(uint32_t level, uint32_t goal, uint16_t rate, uint32_t elapsed) {
+		if (rate == 0) {
+			return goal;
+		}
+		const uint64_t step = ((uint64_t)rate << BAND_FRAME_FRACTION_BITS) * elapsed / 1000000;
+		if (goal > level) {
+			return goal - level > step ? level + (uint32_t)step : goal;
+		}
+		return level - goal > step ? level - (uint32_t)step : goal;
+	}
+
+	//! Is the rendered frame different from the last one sent to the sink? Remembers it if so.
+	/** The effects draw anything, so the whole frame is compared, a few hundred bytes.
+	*/
+	bool frameChanged() {
+		if (shown_valid && memcmp(leds, shown, sizeof(leds)) == 0) {
+			return false;
+		}
+		memcpy(shown, leds, sizeof(leds));
+		shown_valid = true;
+		return true;
+	}
+
+	Latest_Slot<Band_Frame>& slot;
+	Led_Sink& sink;
+	Led_Envelope envelope;
+	uint32_t frame_micros;
+
+	Rgb leds[Config::numLeds];
+	Rgb shown[Config::numLeds]; // the last frame sent to the sink
+	Led_Palette palette;
+	Effects effect_set;
+	uint32_t from[Config::numBands]; // glide start, leds with BAND_FRAME_FRACTION_BITS fractional bits like all levels
+	uint32_t to[Config::numBands]; // latest analysis frame
+	uint32_t display[Config::numBands]; // bar height after attack and decay
+	uint32_t peak[Config::numBands];
+	uint32_t peak_time[Config::numBands]; // when the peak was last pushed up
+	uint16_t leds_on[Config::numBands];
+	uint16_t peak_led[Config::numBands];
+	bool shown_valid; // shown is what the strip shows
+	uint8_t brightness;
+	uint8_t effect; // effect of the latest band frame
+	bool new_frame; // a band frame was taken since the last render
+	uint32_t arrival; // time the latest analysis frame was taken
+	uint32_t last_render;
+	bool rendered; // last_render is valid
+
+	uint32_t frames_rendered;
+	uint32_t frames_unchanged;
+	uint32_t frames_received;
+	Stage_Profiler stage_profiler;
+};
+
+#endif // Led_Renderer_H
@@ -0,0 +1,43 @@
+/*
+ Name:		Led_Sink.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Interface of the output stage. On the Teensy a frame goes to the led strip,
+ on a host it is written to a file.
+*/
+#ifndef Led_Sink_H
+#define Led_Sink_H
+
+#include "Led_Color.h"
+
+/** Class Led_Sink: receives every rendered led frame
+*
+*   Called once per frame, not per led.
+*/
+class Led_Sink {
+
+public:
+
+	virtual ~Led_Sink() {}
+
+	//! Output a frame
+	/** \param leds colour of every led.
+	*   \param count number of leds.
+	*/
+	virtual void show(const Rgb* leds, uint16_t count) = 0;
+
+	//! Output a frame equal to the previous one
+	/** A sink that keeps showing its last frame, like the led strip, can skip it. By default it is shown again.
+	*   \param leds colour of every led.
+	*   \param count number of leds.
+	*/
+	virtual void repeat(const Rgb* leds, uint16_t count) { show(leds, count); }
+
+	//! Set the global brightness, applied when the frames are output
+	/** \param brightness 0 to 255, 255 is full.
+	*/
+	virtual void setBrightness(uint8_t) {}
+};
+
+#endif // Led_Sink_H
@@ -0,0 +1,141 @@
+/*
+ Name:		Pipeline_Config.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Compile time configuration of the analysis pipeline. FFT size, hop, sample rate, led count and
+ band edges are template parameters, the bin ranges and led segments follow from them as constexpr tables.
+ An inconsistent configuration doesn't compile.
+*/
+#ifndef Pipeline_Config_H
+#define Pipeline_Config_H
+
+#include <stdint.h>
+#include "Band_Map.h"
+
+//! Leds showing one band
+struct Led_Segment {
+	uint16_t firstLed;
+	uint16_t numLeds;
+};
+
+/** Struct Pipeline_Tables: sizes and constexpr tables of a configuration
+*
+*   The bin ranges are computed exactly like Band_Map::configure() at the nominal sample rate:
+*   the first band starts at bin 1 and every band ends at the first bin at or above its upper edge.
+*   C++14, so the tables are constexpr functions instead of constexpr arrays.
+*   Use Pipeline_Config, it validates the parameters.
+*/
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+struct Pipeline_Tables {
+
+	static constexpr uint32_t fftSize = FftSize;
+	static constexpr uint32_t hopSize = HopSize;
+	static constexpr uint32_t sampleRate = SampleRate;
+	static constexpr uint16_t numLeds = NumLeds;
+	static constexpr uint8_t numBands = sizeof...(BandUpper);
+	static constexpr uint16_t ledsPerBand = NumLeds / sizeof...(BandUpper);
+
+	//! Upper edge of a band in deciHz
+	static constexpr uint32_t bandUpper(uint8_t band) {
+		const uint32_t edges[] = { BandUpper... };
+		return edges[band];
+	}
+
+	//! First bin with a centre frequency of at least frequency (deciHz), clamped to fftSize / 2
+	static constexpr uint16_t binForFrequency(uint32_t frequency) {
+		const uint64_t step = (uint64_t)SampleRate * 10;
+		const uint64_t bin = ((uint64_t)frequency * FftSize + step - 1) / step;
+		return (uint16_t)(bin > FftSize / 2 ? FftSize / 2 : bin);
+	}
+
+	//! Bin range of a band
+	static constexpr Band_Range band(uint8_t index) {
+		uint16_t firstBin = 1; // skip DC
+		uint16_t endBin = 1;
+		for (uint8_t i = 0; i <= index; i++) {
+			firstBin = endBin;
+			endBin = binForFrequency(bandUpper(i));
+			if (endBin < firstBin) {
+				endBin = firstBin;
+			}
+		}
+		return Band_Range{ firstBin, endBin };
+	}
+
+	//! Leds of a band
+	static constexpr Led_Segment ledSegment(uint8_t index) {
+		return Led_Segment{ (uint16_t)(index * ledsPerBand), ledsPerBand };
+	}
+
+	//! Number of bins the spectrum needs, the end of the last band
+	static constexpr uint16_t maxBin() {
+		return band(numBands - 1).endBin;
+	}
+
+	//! Are the band edges ascending?
+	static constexpr bool edgesAscending() {
+		for (uint8_t i = 1; i < numBands; i++) {
+			if (bandUpper(i) <= bandUpper(i - 1)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//! Does every band contain at least one bin?
+	static constexpr bool bandsNotEmpty() {
+		for (uint8_t i = 0; i < numBands; i++) {
+			if (band(i).endBin <= band(i).firstBin) {
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+// definitions of the static members, needed when they are bound to a reference (C++14)
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+constexpr uint32_t Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...>::fftSize;
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+constexpr uint32_t Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...>::hopSize;
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+constexpr uint32_t Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...>::sampleRate;
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+constexpr uint16_t Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...>::numLeds;
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+constexpr uint8_t Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...>::numBands;
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+constexpr uint16_t Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...>::ledsPerBand;
+
+/** Struct Pipeline_Config: constexpr tables and static validation
+*
+*   Usage:
+*   \code
+*   typedef Pipeline_Config<8192, 1024, 40000, 117, 2500, 15000, 50000> Config;
+*   q15_t window[Config::fftSize];
+*   constexpr Band_Range bass = Config::band(0);
+*   \endcode
+*   The checks run when the configuration is first used.
+*
+*   \tparam FftSize window length, a power of 2 from 64 to 8192.
+*   \tparam HopSize samples between two windows, divides FftSize.
+*   \tparam SampleRate nominal conversions per second.
+*   \tparam NumLeds leds on the strip, an equal number per band.
+*   \tparam BandUpper upper edge of every band in deciHz, ascending and below the Nyquist frequency.
+*/
+template <uint32_t FftSize, uint32_t HopSize, uint32_t SampleRate, uint16_t NumLeds, uint32_t... BandUpper>
+struct Pipeline_Config : Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...> {
+	typedef Pipeline_Tables<FftSize, HopSize, SampleRate, NumLeds, BandUpper...> Tables;
+
+	static_assert(FftSize >= 64 && FftSize <= 8192 && (FftSize & (FftSize - 1)) == 0, "FftSize must be a power of 2 from 64 to 8192");
+	static_assert(HopSize > 0 && HopSize <= FftSize && FftSize % HopSize == 0, "HopSize must divide FftSize");
+	static_assert(SampleRate > 0, "SampleRate must not be 0");
+	static_assert(sizeof...(BandUpper) > 0 && sizeof...(BandUpper) <= BAND_MAP_MAX_BANDS, "1 to BAND_MAP_MAX_BANDS bands");
+	static_assert(NumLeds % sizeof...(BandUpper) == 0, "NumLeds must be divisible by the number of bands");
+	static_assert(Tables::edgesAscending(), "band edges must be ascending");
+	static_assert(Tables::bandUpper(sizeof...(BandUpper) - 1) <= (uint64_t)SampleRate * 5, "a band is beyond the Nyquist frequency");
+	static_assert(Tables::bandsNotEmpty(), "a band is narrower than a bin");
+};
+
+#endif // Pipeline_Config_H
@@ -0,0 +1,137 @@
+/*
+ Name:		Pruned_Rfft.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Real FFT that only computes the bins below a maximum bin.
+*/
+
+#include "Pruned_Rfft.h"
+#include <math.h>
+
+/* Constructor
+*   Nothing is allocated until begin().
+*/
+Pruned_Rfft::Pruned_Rfft(Fft_Engine& engine) : fft(engine), fft_size(0), max_bin(0), sub_size(0), sub_count(0), sub_count_bits(0),
+sine_table(nullptr), sub_input(nullptr), sub_output(nullptr), accumulator(nullptr) {
+}
+
+Pruned_Rfft::~Pruned_Rfft() {
+	end();
+}
+
+void Pruned_Rfft::end() {
+	delete[] sine_table;
+	delete[] sub_input;
+	delete[] sub_output;
+	delete[] accumulator;
+	sine_table = nullptr;
+	sub_input = nullptr;
+	sub_output = nullptr;
+	accumulator = nullptr;
+	fft_size = 0;
+}
+
+/* Choose the sub-FFT size and allocate everything
+*   A sub-FFT costs about M log2(M) butterflies, so all P of them fftSize * log2(M).
+*   Every output bin needs P complex multiply-accumulates. The M with the lowest total is used,
+*   the smallest sub-FFT is 32 points (the smallest CMSIS real FFT). Ties go to the larger M: the model
+*   leaves out the gather and the twiddle pass per sub-FFT, fewer sub-FFTs have fewer of them.
+*/
+bool Pruned_Rfft::begin(uint32_t fftSize, uint32_t maxBin) {
+	if (fftSize < 64 || fftSize > 8192 || (fftSize & (fftSize - 1)) != 0 || maxBin == 0 || maxBin > fftSize / 2) {
+		return false;
+	}
+	end();
+
+	uint32_t bestSize = fftSize / 2;
+	uint32_t bestCost = 0xFFFFFFFF;
+	uint8_t log2Size = 5;
+	for (uint32_t size = 32; size <= fftSize / 2; size <<= 1, log2Size++) {
+		uint32_t cost = fftSize * log2Size + maxBin * (fftSize / size) * 2;
+		if (cost <= bestCost) {
+			bestCost = cost;
+			bestSize = size;
+		}
+	}
+
+	fft_size = fftSize;
+	max_bin = maxBin;
+	sub_size = bestSize;
+	sub_count = fftSize / bestSize;
+	sub_count_bits = 0;
+	while ((1u << sub_count_bits) < sub_count) {
+		sub_count_bits++;
+	}
+
+	sine_table = new q15_t[fftSize / 4 + 1];
+	sub_input = new q15_t[sub_size];
+	sub_output = new q15_t[2 * sub_size];
+	accumulator = new q31_t[2 * maxBin];
+	if (sine_table == nullptr || sub_input == nullptr || sub_output == nullptr || accumulator == nullptr) {
+		end();
+		return false;
+	}
+
+	for (uint32_t i = 0; i <= fftSize / 4; i++) {
+		long value = lround(32768.0 * sin(2 * M_PI * i / fftSize));
+		sine_table[i] = (q15_t)(value > 32767 ? 32767 : value);
+	}
+	return true;
+}
+
+/* Compute bins 0 up to maxBin
+*   Y_p is scaled by M / 2 and X by fftSize / 2, so the sum over p is divided by P at the end.
+*   Bins of Y_p above M / 2 follow from conjugate symmetry, Y_p[M - r] = conj(Y_p[r]).
+*/
+bool Pruned_Rfft::transform(const q15_t* input, q15_t* output) {
+	if (fft_size == 0) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < 2 * max_bin; i++) {
+		accumulator[i] = 0;
+	}
+
+	const uint32_t mask = sub_size - 1;
+	for (uint32_t p = 0; p < sub_count; p++) {
+		for (uint32_t m = 0; m < sub_size; m++) {
+			sub_input[m] = input[p + m * sub_count];
+		}
+		fft.rfft(sub_input, sub_output, sub_size);
+
+		// twiddle index p * k, stepped instead of multiplied
+		uint32_t twiddle = 0;
+		for (uint32_t k = 0; k < max_bin; k++, twiddle += p) {
+			uint32_t r = k & mask;
+			int32_t yRe, yIm;
+			if (r <= sub_size / 2) {
+				yRe = sub_output[2 * r];
+				yIm = sub_output[2 * r + 1];
+			}
+			else {
+				yRe = sub_output[2 * (sub_size - r)];
+				yIm = -sub_output[2 * (sub_size - r) + 1];
+			}
+			int32_t c = cosine(twiddle);
+			int32_t s = sine(twiddle);
+			// Y * e^(-j w) = (yRe c + yIm s) + j (yIm c - yRe s), both sums fit in 32 bits, rounded so the
+			// P products don't add up a bias of half a bit
+			accumulator[2 * k] += (yRe * c + yIm * s + (1 << 14)) >> 15;
+			accumulator[2 * k + 1] += (yIm * c - yRe * s + (1 << 14)) >> 15;
+		}
+	}
+
+	const int32_t round = (1 << sub_count_bits) >> 1;
+	for (uint32_t i = 0; i < 2 * max_bin; i++) {
+		int32_t value = (accumulator[i] + round) >> sub_count_bits;
+		if (value > 32767) {
+			value = 32767;
+		}
+		else if (value < -32768) {
+			value = -32768;
+		}
+		output[i] = (q15_t)value;
+	}
+	return true;
+}
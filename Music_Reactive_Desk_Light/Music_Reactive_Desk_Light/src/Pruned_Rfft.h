@@ -0,0 +1,91 @@
+/*
+ Name:		Pruned_Rfft.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Real FFT that only computes the bins below a maximum bin. The bins above the treble band
+ are never visualized, so the work for them is skipped.
+*/
+#ifndef Pruned_Rfft_H
+#define Pruned_Rfft_H
+
+#include "Dsp_Types.h"
+#include "Fft_Engine.h"
+#include "Fft_Backend.h"
+
+/** Class Pruned_Rfft: output pruned real FFT by transform decomposition
+*
+*   The input is split into P interleaved subsequences x[p + P*m] of M = fftSize / P samples.
+*   Every subsequence gets an M point real FFT and the wanted bins are combined from those:
+*   X[k] = sum over p of e^(-j 2 pi p k / fftSize) * Y_p[k mod M].
+*   M is chosen to minimise the sub-FFT work plus the combining work for the requested bins.
+*   The output has the layout and scaling of Fft_Engine::rfft (and arm_rfft_q15) for bins 0 up to maxBin.
+*   The sub-FFT outputs and the Q15 twiddles are rounded, so a value can differ from the full transform by
+*   1 LSB, never more; the combining is done at 32 bits with rounded products, which keeps the rms error
+*   against the exact transform below 0.55 LSB (0.29 for rounding alone). test_pruned_rfft checks both.
+*/
+class Pruned_Rfft : public Fft_Backend {
+
+public:
+
+	//! Constructor
+	/** \param engine FFT engine used for the sub-FFTs, its plan cache keeps the M point plan.
+	*/
+	Pruned_Rfft(Fft_Engine& engine);
+
+	~Pruned_Rfft();
+
+	//! Set the sizes and allocate the tables and buffers
+	/** \param fftSize number of input samples, a power of 2 from 64 to 8192.
+	*   \param maxBin number of output bins, from 1 to fftSize / 2.
+	*   \return false if the sizes are invalid or out of memory.
+	*/
+	bool begin(uint32_t fftSize, uint32_t maxBin) override;
+
+	//! Compute bins 0 up to maxBin
+	/** \param input fftSize real samples, not modified.
+	*   \param output 2 * maxBin values, real and imaginary interleaved.
+	*   \return false if begin() wasn't successful.
+	*/
+	bool transform(const q15_t* input, q15_t* output) override;
+
+	//! Number of samples per sub-FFT (M)
+	uint32_t subSize() const { return sub_size; }
+
+	//! Number of sub-FFTs (P)
+	uint32_t subCount() const { return sub_count; }
+
+	//! Number of output bins
+	uint32_t maxBin() const override { return max_bin; }
+
+private:
+	//! Free the tables and buffers
+	void end();
+
+	//! sin(2 pi index / fftSize) in Q15, from the quarter wave table
+	q15_t sine(uint32_t index) const {
+		index &= fft_size - 1;
+		const uint32_t quarter = fft_size >> 2;
+		if (index <= quarter) return sine_table[index];
+		if (index <= 2 * quarter) return sine_table[2 * quarter - index];
+		if (index <= 3 * quarter) return -sine_table[index - 2 * quarter];
+		return -sine_table[fft_size - index];
+	}
+
+	//! cos(2 pi index / fftSize) in Q15
+	q15_t cosine(uint32_t index) const { return sine(index + (fft_size >> 2)); }
+
+	Fft_Engine& fft;
+	uint32_t fft_size;
+	uint32_t max_bin;
+	uint32_t sub_size;
+	uint32_t sub_count;
+	uint8_t sub_count_bits; // log2 of sub_count
+
+	q15_t* sine_table; // fftSize / 4 + 1 values
+	q15_t* sub_input; // gathered subsequence, M values
+	q15_t* sub_output; // spectrum of the subsequence, 2 * M values
+	q31_t* accumulator; // 2 * maxBin values
+};
+
+#endif // Pruned_Rfft_H
@@ -0,0 +1,46 @@
+/*
+ Name:		Sample_Source.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Interface of the capture stage. On the Teensy the samples come from the ADC,
+ on a host they come from an audio file.
+*/
+#ifndef Sample_Source_H
+#define Sample_Source_H
+
+#include "Dsp_Types.h"
+
+/** Class Sample_Source: stream of samples in ADC units
+*
+*   Samples are signed 12 bit ADC counts with the bias removed, before any gain.
+*   read() never blocks, it returns what is available. A source that captures in real time drops
+*   the samples it can't buffer and counts them, see samplesDropped().
+*/
+class Sample_Source {
+
+public:
+
+	virtual ~Sample_Source() {}
+
+	//! Read up to count samples
+	/** \param samples destination.
+	*   \param count maximum number of samples.
+	*   \return number of samples read, 0 if none are available yet.
+	*/
+	virtual uint32_t read(q15_t* samples, uint32_t count) = 0;
+
+	//! Samples per second
+	virtual uint32_t sampleRate() const = 0;
+
+	//! No more samples will come, e.g. the end of a file
+	virtual bool finished() const { return false; }
+
+	//! Samples the capture had to drop because they weren't read in time
+	virtual uint32_t samplesDropped() const { return 0; }
+
+	//! Capture interrupts that dropped samples
+	virtual uint32_t overruns() const { return 0; }
+};
+
+#endif // Sample_Source_H
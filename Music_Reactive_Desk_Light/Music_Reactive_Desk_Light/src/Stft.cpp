@@ -0,0 +1,123 @@
+/*
+ Name:		Stft.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Streaming short-time Fourier transform.
+*/
+
+#include "Stft.h"
+#include <string.h>
+
+/* Constructor
+*   Nothing is allocated until begin().
+*/
+Stft::Stft(Fft_Backend& backend) : fft(backend), fft_size(0), hop_size(0), history(nullptr), frame(nullptr), output(nullptr),
+write_index(0), hop_count(0), history_sum(0), filled(false), pending(false), frame_count(0) {
+}
+
+Stft::~Stft() {
+	end();
+}
+
+void Stft::end() {
+	delete[] history;
+	delete[] frame;
+	delete[] output;
+	history = nullptr;
+	frame = nullptr;
+	output = nullptr;
+	fft_size = 0;
+}
+
+/* Allocate the ring buffer, the window and the spectrum
+*   The backend only has to compute the bins up to maxBin.
+*/
+bool Stft::begin(uint32_t fftSize, uint32_t hopSize, uint32_t maxBin, WINDOW_TYPE windowType) {
+	if (hopSize == 0 || hopSize > fftSize) {
+		return false;
+	}
+	end();
+	if (!fft.begin(fftSize, maxBin) || !window.begin(fftSize, windowType)) {
+		return false;
+	}
+
+	history = new q15_t[fftSize];
+	frame = new q15_t[fftSize];
+	output = new q15_t[2 * maxBin];
+	if (history == nullptr || frame == nullptr || output == nullptr) {
+		end();
+		return false;
+	}
+	memset(history, 0, fftSize * sizeof(q15_t));
+
+	fft_size = fftSize;
+	hop_size = hopSize;
+	write_index = 0;
+	hop_count = 0;
+	history_sum = 0;
+	filled = false;
+	pending = false;
+	frame_count = 0;
+	return true;
+}
+
+/* Copy samples into the ring buffer, stop at the end of a hop
+*   The sum of the buffer is updated on the way, the new sample replaces the oldest one.
+*/
+uint32_t Stft::write(const q15_t* samples, uint32_t count) {
+	if (fft_size == 0) {
+		return count;
+	}
+
+	uint32_t taken = hop_size - hop_count;
+	if (taken > count) {
+		taken = count;
+	}
+
+	uint32_t remaining = taken;
+	while (remaining > 0) {
+		uint32_t chunk = fft_size - write_index; // up to the end of the ring
+		if (chunk > remaining) {
+			chunk = remaining;
+		}
+		q15_t* slot = history + write_index;
+		for (uint32_t i = 0; i < chunk; i++) {
+			history_sum += samples[i] - slot[i];
+			slot[i] = samples[i];
+		}
+		samples += chunk;
+		remaining -= chunk;
+		write_index += chunk;
+		if (write_index == fft_size) {
+			write_index = 0;
+			filled = true;
+		}
+	}
+
+	hop_count += taken;
+	if (hop_count == hop_size) {
+		hop_count = 0;
+		pending = true;
+	}
+	return taken;
+}
+
+/* Put the window in time order, condition it and transform it
+*   The oldest sample is at write_index. The mean of the window is removed as the DC bias.
+*/
+const q15_t* Stft::spectrum() {
+	if (fft_size == 0) {
+		return nullptr;
+	}
+
+	q15_t bias = (q15_t)(history_sum / (int32_t)fft_size);
+	uint32_t older = fft_size - write_index;
+	window.apply(history + write_index, frame, 0, older, bias);
+	window.apply(history, frame + older, older, write_index, bias);
+	fft.transform(frame, output);
+
+	pending = false;
+	frame_count++;
+	return output;
+}
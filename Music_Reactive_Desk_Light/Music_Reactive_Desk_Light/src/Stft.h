@@ -0,0 +1,111 @@
+/*
+ Name:		Stft.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Streaming short-time Fourier transform. Keeps the last fftSize samples in a ring buffer and
+ produces the spectrum of that window every hopSize samples, so spectra overlap and arrive much more often
+ than once per window.
+*/
+#ifndef Stft_H
+#define Stft_H
+
+#include "Dsp_Types.h"
+#include "Fft_Backend.h"
+#include "Fft_Window.h"
+
+/** Class Stft: overlapping spectra over a stream of samples
+*
+*   Usage:
+*   \code
+*   while (count > 0) {
+*       uint32_t used = stft.write(samples, count);
+*       samples += used;
+*       count -= used;
+*       if (stft.available()) {
+*           const q15_t* spectrum = stft.spectrum();
+*           ...
+*       }
+*   }
+*   \endcode
+*   When the samples come in blocks of exactly hopSize, every write takes the whole block.
+*   The raw samples are kept, the mean of the window (DC), the gain and the window function are applied
+*   while the ring buffer is unwrapped for the transform.
+*/
+class Stft {
+
+public:
+
+	//! Constructor
+	/** \param backend computes the spectrum of every window, e.g. Pruned_Rfft.
+	*/
+	Stft(Fft_Backend& backend);
+
+	~Stft();
+
+	//! Set the sizes and allocate the buffers
+	/** \param fftSize window length, a power of 2 from 64 to 8192.
+	*   \param hopSize samples between the start of two windows, from 1 to fftSize.
+	*   \param maxBin number of bins in every spectrum, from 1 to fftSize / 2.
+	*   \param window window function applied before the transform.
+	*   \return false if the sizes are invalid or out of memory.
+	*/
+	bool begin(uint32_t fftSize, uint32_t hopSize, uint32_t maxBin, WINDOW_TYPE window = WINDOW_TYPE::HANN);
+
+	//! Set the gain applied to the samples before the window
+	/** \param gain integer factor, see Fft_Window::setGain().
+	*/
+	void setGain(int16_t gain) { window.setGain(gain); }
+
+	//! Add samples to the stream
+	/** Samples are taken up to the end of the next hop.
+	*   \param samples input samples.
+	*   \param count number of samples.
+	*   \return number of samples taken. Less than count when a hop was completed, call spectrum() and pass the rest.
+	*/
+	uint32_t write(const q15_t* samples, uint32_t count);
+
+	//! Has a hop completed since the last spectrum?
+	/** Only after the first fftSize samples, before that the window isn't full.
+	*/
+	bool available() const { return pending && filled; }
+
+	//! Spectrum of the latest window
+	/** Layout and scaling of Fft_Engine::rfft for bins 0 up to maxBin.
+	*   \return pointer to 2 * maxBin values, valid until the next call.
+	*/
+	const q15_t* spectrum();
+
+	//! Window length
+	uint32_t fftSize() const { return fft_size; }
+
+	//! Samples between two spectra
+	uint32_t hopSize() const { return hop_size; }
+
+	//! Number of bins in every spectrum
+	uint32_t maxBin() const { return fft.maxBin(); }
+
+	//! Number of spectra computed since begin()
+	uint32_t frames() const { return frame_count; }
+
+private:
+	//! Free the buffers
+	void end();
+
+	Fft_Backend& fft;
+	Fft_Window window;
+	uint32_t fft_size;
+	uint32_t hop_size;
+
+	q15_t* history; // ring buffer with the last fftSize samples
+	q15_t* frame; // window in time order, input of the transform
+	q15_t* output; // spectrum
+	uint32_t write_index; // next position in history, also the oldest sample
+	uint32_t hop_count; // samples in the current hop
+	int32_t history_sum; // sum of the samples in history, for the DC level
+	bool filled; // history holds fftSize samples
+	bool pending; // a hop completed since the last spectrum
+	uint32_t frame_count;
+};
+
+#endif // Stft_H
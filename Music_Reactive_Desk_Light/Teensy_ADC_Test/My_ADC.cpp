@@ -15,17 +15,22 @@
 
 /* Constructor
 *   Point the registers to the correct ADC module
+*/
+My_ADC::My_ADC(uint8_t ADC_number) : My_ADC(ADC_number, ADC_number ? ADC1_START : ADC0_START, IMXRT_ADC_ETC) {
+}
+
+/* Constructor with the registers
 *   Copy the correct channel2sc1a
 *   Call init
 */
-My_ADC::My_ADC(uint8_t ADC_number) : ADC_num(ADC_number), channel2sc1a(ADC_num ? channel2sc1aADC1 : channel2sc1aADC0),
-adc_regs(ADC_num ? ADC1_START : ADC0_START)
+My_ADC::My_ADC(uint8_t ADC_number, ADC_REGS_t& regs, IMXRT_ADC_ETC_t& etc) : ADC_num(ADC_number), channel2sc1a(ADC_num ? channel2sc1aADC1 : channel2sc1aADC0)
 #ifdef ADC_USE_PDB
 	,
 	PDB0_CHnC1(ADC_num ? PDB0_CH1C1 : PDB0_CH0C1)
 #endif
 	,
-	XBAR_IN(ADC_num ? XBARA1_IN_QTIMER4_TIMER3 : XBARA1_IN_QTIMER4_TIMER0), XBAR_OUT(ADC_num ? XBARA1_OUT_ADC_ETC_TRIG10 : XBARA1_OUT_ADC_ETC_TRIG00), QTIMER4_INDEX(ADC_num ? 3 : 0), ADC_ETC_TRIGGER_INDEX(ADC_num ? 4 : 0), IRQ_ADC(ADC_num ? IRQ_NUMBER_t::IRQ_ADC2 : IRQ_NUMBER_t::IRQ_ADC1) {
+	XBAR_IN(ADC_num ? XBARA1_IN_QTIMER4_TIMER3 : XBARA1_IN_QTIMER4_TIMER0), XBAR_OUT(ADC_num ? XBARA1_OUT_ADC_ETC_TRIG10 : XBARA1_OUT_ADC_ETC_TRIG00), QTIMER4_INDEX(ADC_num ? 3 : 0), ADC_ETC_TRIGGER_INDEX(ADC_num ? 4 : 0), IRQ_ADC(ADC_num ? IRQ_NUMBER_t::IRQ_ADC2 : IRQ_NUMBER_t::IRQ_ADC1),
+	adc_regs(regs), adc_etc(etc) {
 	// call our init
 	analog_init();
 }
@@ -969,16 +974,16 @@ void My_ADC::startQuadTimer(uint32_t freq) {
 	singleMode();                                  // make sure continuous is turned off as you want the trigger to di it.
 
 	// setup adc_etc - BUGBUG have not used the preset values yet.
-	if (IMXRT_ADC_ETC.CTRL & ADC_ETC_CTRL_SOFTRST) { // SOFTRST
+	if (adc_etc.CTRL & ADC_ETC_CTRL_SOFTRST) { // SOFTRST
 		// Soft reset
-		atomic::clearBitFlag(IMXRT_ADC_ETC.CTRL, ADC_ETC_CTRL_SOFTRST);
+		atomic::clearBitFlag(adc_etc.CTRL, ADC_ETC_CTRL_SOFTRST);
 		delay(5); // give some time to be sure it is init
 	}
 	if (ADC_num == 0) { // BUGBUG - in real code, should probably know we init ADC or not..
-		IMXRT_ADC_ETC.CTRL |=
+		adc_etc.CTRL |=
 			(ADC_ETC_CTRL_TSC_BYPASS | ADC_ETC_CTRL_DMA_MODE_SEL | ADC_ETC_CTRL_TRIG_ENABLE(1 << ADC_ETC_TRIGGER_INDEX)); // 0x40000001;  // start with trigger 0
-		IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = ADC_ETC_TRIG_CTRL_TRIG_CHAIN(0);                                 // chainlength -1 only us
-		IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 =
+		adc_etc.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = ADC_ETC_TRIG_CTRL_TRIG_CHAIN(0);                                 // chainlength -1 only us
+		adc_etc.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 =
 			ADC_ETC_TRIG_CHAIN_IE0(1) /*| ADC_ETC_TRIG_CHAIN_B2B0 */
 			| ADC_ETC_TRIG_CHAIN_HWTS0(1) | ADC_ETC_TRIG_CHAIN_CSEL0(adc_pin_channel);
 
@@ -986,21 +991,21 @@ void My_ADC::startQuadTimer(uint32_t freq) {
 			// Not sure yet?
 		}
 		if (adc_regs.GC & ADC_GC_DMAEN) {
-			IMXRT_ADC_ETC.DMA_CTRL |= ADC_ETC_DMA_CTRL_TRIQ_ENABLE(ADC_ETC_TRIGGER_INDEX);
+			adc_etc.DMA_CTRL |= ADC_ETC_DMA_CTRL_TRIQ_ENABLE(ADC_ETC_TRIGGER_INDEX);
 		}
 	}
 	else {
 		// This is our second one... Try second trigger?
 		// Remove the BYPASS?
-		IMXRT_ADC_ETC.CTRL &= ~(ADC_ETC_CTRL_TSC_BYPASS);                                                       // 0x40000001;  // start with trigger 0
-		IMXRT_ADC_ETC.CTRL |= ADC_ETC_CTRL_DMA_MODE_SEL | ADC_ETC_CTRL_TRIG_ENABLE(1 << ADC_ETC_TRIGGER_INDEX); // Add trigger
-		IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = ADC_ETC_TRIG_CTRL_TRIG_CHAIN(0);                       // chainlength -1 only us
-		IMXRT_ADC_ETC.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 =
+		adc_etc.CTRL &= ~(ADC_ETC_CTRL_TSC_BYPASS);                                                       // 0x40000001;  // start with trigger 0
+		adc_etc.CTRL |= ADC_ETC_CTRL_DMA_MODE_SEL | ADC_ETC_CTRL_TRIG_ENABLE(1 << ADC_ETC_TRIGGER_INDEX); // Add trigger
+		adc_etc.TRIG[ADC_ETC_TRIGGER_INDEX].CTRL = ADC_ETC_TRIG_CTRL_TRIG_CHAIN(0);                       // chainlength -1 only us
+		adc_etc.TRIG[ADC_ETC_TRIGGER_INDEX].CHAIN_1_0 =
 			ADC_ETC_TRIG_CHAIN_IE0(1) /*| ADC_ETC_TRIG_CHAIN_B2B0 */
 			| ADC_ETC_TRIG_CHAIN_HWTS0(1) | ADC_ETC_TRIG_CHAIN_CSEL0(adc_pin_channel);
 
 		if (adc_regs.GC & ADC_GC_DMAEN) {
-			IMXRT_ADC_ETC.DMA_CTRL |= ADC_ETC_DMA_CTRL_TRIQ_ENABLE(ADC_ETC_TRIGGER_INDEX);
+			adc_etc.DMA_CTRL |= ADC_ETC_DMA_CTRL_TRIQ_ENABLE(ADC_ETC_TRIGGER_INDEX);
 		}
 	}
 
@@ -1042,4 +1047,98 @@ uint32_t My_ADC::getQuadTimerFrequency() {
 	//Serial.printf("My_ADC::getTimerFrequency H:%u L:%u H+L=%u pcs:%u freq:%u\n", high, low, highPlusLow, pcs, freq);
 	return freq;
 }
-#endif // ADC_USE_QUAD_TIMER
\ No newline at end of file
+#endif // ADC_USE_QUAD_TIMER
+
+//////////// STREAMING ////////////////
+
+#if defined(ADC_USE_DMA) && defined(ADC_USE_QUAD_TIMER)
+My_ADC* My_ADC::stream_adc[2] = { nullptr, nullptr };
+
+/* Start streaming conversions of the pin into memory by DMA
+*  The DMA copies R0 into the buffers after every conversion and wraps around at the end,
+*  interrupting at the half and at the end, so once per block.
+*/
+bool My_ADC::startStream(uint8_t pin, uint32_t rate, uint16_t* buffers, uint16_t blockSize, ADC_Block_Callback callback, uint8_t priority) {
+
+	// check whether the pin is correct
+	if (!checkPin(pin)) {
+		fail_flag |= ADC_ERROR::WRONG_PIN;
+		return false;
+	}
+	if (buffers == nullptr || blockSize == 0 || callback == nullptr) {
+		fail_flag |= ADC_ERROR::OTHER;
+		return false;
+	}
+
+	if (streaming) {
+		stopStream();
+	}
+
+	stream_buffers = buffers;
+	stream_block_size = blockSize;
+	stream_callback = callback;
+	stream_last_block = 1;
+	stream_blocks = 0;
+	stream_overruns = 0;
+	stream_adc[ADC_num] = this;
+
+	stream_dma.begin(true);
+	stream_dma.source((volatile uint16_t&)adc_regs.R0);
+	stream_dma.destinationBuffer(buffers, 2 * blockSize * sizeof(uint16_t));
+	stream_dma.interruptAtHalf();
+	stream_dma.interruptAtCompletion();
+	stream_dma.triggerAtHardwareEvent(ADC_num ? DMAMUX_SOURCE_ADC2 : DMAMUX_SOURCE_ADC1);
+	stream_dma.attachInterrupt(ADC_num ? stream_isr1 : stream_isr0);
+	NVIC_SET_PRIORITY(IRQ_DMA_CH0 + (stream_dma.channel & 15), priority);
+	stream_dma.enable();
+
+	// one DMA interrupt per block replaces the ADC interrupt per conversion
+	disableInterrupts();
+	enableDMA();
+
+	// select the pin, then let the timer trigger the conversions
+	startSingleRead(pin);
+	startQuadTimer(rate);
+
+	streaming = true;
+	return true;
+}
+
+/* Stop the stream
+*  Undo startStream(): timer, DMA request of the ADC and of the ADC_ETC trigger, DMA channel.
+*/
+void My_ADC::stopStream() {
+	if (!streaming) {
+		return;
+	}
+
+	stopQuadTimer();
+	disableDMA();
+	adc_etc.DMA_CTRL &= ~ADC_ETC_DMA_CTRL_TRIQ_ENABLE(ADC_ETC_TRIGGER_INDEX); // set by startQuadTimer() because DMA was enabled
+	stream_dma.disable();
+	stream_dma.detachInterrupt();
+
+	streaming = false;
+}
+
+/* DMA interrupt: find the block that was completed and pass it to the callback
+*  Blocks complete alternately, if the same block completes twice in a row the DMA wrapped around
+*  before this interrupt ran and the block in between was overwritten.
+*/
+void My_ADC::streamBlockComplete() {
+	stream_dma.clearInterrupt();
+
+	uint8_t block = completedStreamBlock((uintptr_t)stream_dma.destinationAddress());
+	if (block == stream_last_block) {
+		stream_overruns++;
+	}
+	stream_last_block = block;
+	stream_blocks++;
+
+	uint16_t* samples = stream_buffers + block * stream_block_size;
+	arm_dcache_delete(samples, stream_block_size * sizeof(uint16_t)); // the DMA wrote to memory, not to the cache
+	stream_callback(samples, stream_block_size);
+
+	asm("DSB");
+}
+#endif // ADC_USE_DMA && ADC_USE_QUAD_TIMER
@@ -10,6 +10,9 @@
 
 #include <settings_defines.h>
 #include <atomic.h>
+#ifdef ADC_USE_DMA
+#include <DMAChannel.h>
+#endif
 
 using ADC_Error::ADC_ERROR;
 using namespace ADC_settings;
@@ -24,6 +27,33 @@ class My_ADC {
 
 public:
 
+	//! Struct containing the registers controlling the ADC
+	struct ADC_REGS_t {
+		volatile uint32_t HC0;
+		volatile uint32_t HC1;
+		volatile uint32_t HC2;
+		volatile uint32_t HC3;
+		volatile uint32_t HC4;
+		volatile uint32_t HC5;
+		volatile uint32_t HC6;
+		volatile uint32_t HC7;
+		volatile uint32_t HS;
+		volatile uint32_t R0;
+		volatile uint32_t R1;
+		volatile uint32_t R2;
+		volatile uint32_t R3;
+		volatile uint32_t R4;
+		volatile uint32_t R5;
+		volatile uint32_t R6;
+		volatile uint32_t R7;
+		volatile uint32_t CFG;
+		volatile uint32_t GC;
+		volatile uint32_t GS;
+		volatile uint32_t CV;
+		volatile uint32_t OFS;
+		volatile uint32_t CAL;
+	};
+
 	//! Constructor
 	/** Pass the ADC number and the Channel number to SC1A number arrays.
 	*   \param ADC_number Number of the ADC module, from 0.
@@ -32,6 +62,15 @@ public:
 	*/
 	My_ADC(uint8_t ADC_number);
 
+	//! Constructor with the registers of the module
+	/** Only for testing: all register accesses of this object go to regs and etc instead of the hardware.
+	*   The QuadTimer, XBAR and clock registers are still the global ones.
+	*   \param ADC_number Number of the ADC module, from 0.
+	*   \param regs registers used in place of the ADC module.
+	*   \param etc registers used in place of the ADC_ETC.
+	*/
+	My_ADC(uint8_t ADC_number, ADC_REGS_t& regs, IMXRT_ADC_ETC_t& etc);
+
 	//! Starts the calibration sequence, waits until it's done and writes the results
 	/** Usually it's not necessary to call this function directly, but do it if the "environment" changed
 	*   significantly since the program was started.
@@ -443,6 +482,45 @@ public:
 	*/
 	uint32_t getQuadTimerFrequency();
 
+#if defined(ADC_USE_DMA) && defined(ADC_USE_QUAD_TIMER)
+	//////////// STREAMING ////////////////
+	//! Function called for every completed block of a stream
+	/** \param block the completed samples, valid until the DMA wraps around to this block again.
+	*   \param blockSize number of samples in the block.
+	*/
+	typedef void (*ADC_Block_Callback)(volatile uint16_t* block, uint16_t blockSize);
+
+	//! Start streaming conversions of the pin into memory by DMA
+	/** The QuadTimer triggers a conversion at rate, the DMA moves every result into buffers.
+	*   The buffers are used as two blocks of blockSize samples: while the DMA fills one block the callback
+	*   is called from the DMA interrupt with the other one. So there is one interrupt per block instead of one per conversion.
+	*   ADC interrupts are disabled, set the resolution, averaging and speeds BEFORE calling this function.
+	*   \param pin pin to read.
+	*   \param rate conversions per second.
+	*   \param buffers 2*blockSize samples. If they are in DMAMEM they must be aligned to 32 bytes and
+	*   blockSize must be a multiple of 16, the cache is invalidated before the callback.
+	*   \param blockSize number of samples per block.
+	*   \param callback called from the DMA interrupt for every completed block.
+	*   \param priority DMA interrupt priority, highest is 0, lowest is 255.
+	*   \return true if the stream was started, false if the pin or arguments are invalid.
+	*/
+	bool startStream(uint8_t pin, uint32_t rate, uint16_t* buffers, uint16_t blockSize, ADC_Block_Callback callback, uint8_t priority = 255);
+
+	//! Stop the stream, the timer and the DMA
+	void stopStream();
+
+	//! Is a stream running?
+	bool isStreaming() { return streaming; }
+
+	//! Number of blocks completed since the stream was started
+	uint32_t getStreamBlocks() { return stream_blocks; }
+
+	//! Number of blocks overwritten by the DMA before their callback ran
+	/** Counts at least one per overrun, a callback late by more than two blocks can't be detected.
+	*/
+	uint32_t getStreamOverruns() { return stream_overruns; }
+#endif
+
 	//////// OTHER STUFF ///////////
 
 	//! Store the config of the adc
@@ -542,6 +620,31 @@ private:
 	}
 #endif
 
+#if defined(ADC_USE_DMA) && defined(ADC_USE_QUAD_TIMER)
+	// stream state
+	DMAChannel stream_dma;
+	uint16_t* stream_buffers = nullptr;
+	uint16_t stream_block_size = 0;
+	ADC_Block_Callback stream_callback = nullptr;
+	uint8_t stream_last_block = 1; // block passed to the last callback, the DMA starts with block 0
+	volatile uint32_t stream_blocks = 0;
+	volatile uint32_t stream_overruns = 0;
+	volatile bool streaming = false;
+
+	//! Called from the DMA interrupt, pass the completed block to the callback
+	void streamBlockComplete();
+
+	//! Block the DMA is not writing at the moment, from the DMA destination address
+	uint8_t completedStreamBlock(uintptr_t destination) {
+		return destination < (uintptr_t)(stream_buffers + stream_block_size) ? 1 : 0;
+	}
+
+	// the DMA interrupt can't take arguments, so every ADC module has its own
+	static My_ADC* stream_adc[2];
+	static void stream_isr0() { stream_adc[0]->streamBlockComplete(); }
+	static void stream_isr1() { stream_adc[1]->streamBlockComplete(); }
+#endif
+
 	//! Initialize ADC
 	void analog_init();
 
@@ -568,36 +671,13 @@ private:
 	uint8_t ADC_ETC_TRIGGER_INDEX;
 	const IRQ_NUMBER_t IRQ_ADC; // IRQ number
 
-	//! Struct containing the registers controlling the ADC
-	struct ADC_REGS_t {
-		volatile uint32_t HC0;
-		volatile uint32_t HC1;
-		volatile uint32_t HC2;
-		volatile uint32_t HC3;
-		volatile uint32_t HC4;
-		volatile uint32_t HC5;
-		volatile uint32_t HC6;
-		volatile uint32_t HC7;
-		volatile uint32_t HS;
-		volatile uint32_t R0;
-		volatile uint32_t R1;
-		volatile uint32_t R2;
-		volatile uint32_t R3;
-		volatile uint32_t R4;
-		volatile uint32_t R5;
-		volatile uint32_t R6;
-		volatile uint32_t R7;
-		volatile uint32_t CFG;
-		volatile uint32_t GC;
-		volatile uint32_t GS;
-		volatile uint32_t CV;
-		volatile uint32_t OFS;
-		volatile uint32_t CAL;
-	};
 #define ADC0_START (*(ADC_REGS_t *)0x400C4000)
 #define ADC1_START (*(ADC_REGS_t *)0x400C8000)
 	ADC_REGS_t& adc_regs;
 
+	// trigger and DMA control shared by both ADC modules
+	IMXRT_ADC_ETC_t& adc_etc;
+
 	const uint8_t channel2sc1aADC0[28] = {
 		// new version, gives directly the sc1a number. 0x1F=31 deactivates the ADC.
 		7, 8, 12, 11, 6, 5, 15, 0, 13, 14, 1, 2, 31, 31, // 0-13, we treat them as A0-A13
@@ -0,0 +1,58 @@
+/*
+ Name:		Band_Map.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Maps frequency bands onto FFT bins.
+*/
+
+#include "Band_Map.h"
+
+/* Constructor
+*   Empty map until configure() is called.
+*/
+Band_Map::Band_Map() : sample_rate(0), fft_size(0), num_bands(0), bands{} {
+}
+
+/* Derive the bin ranges from the sample rate and FFT size
+*   Bin k has centre frequency k * sampleRate / fftSize, so the bins below an edge f (deciHz) are
+*   k < f * fftSize / (10 * sampleRate). The end bin is that bound rounded up, computed exactly in integers.
+*/
+bool Band_Map::configure(uint32_t sampleRate, uint32_t fftSize, const uint32_t* upperEdges, uint8_t numBands) {
+	if (sampleRate == 0 || fftSize < 4 || numBands == 0 || numBands > BAND_MAP_MAX_BANDS) {
+		return false;
+	}
+	for (uint8_t i = 1; i < numBands; i++) {
+		if (upperEdges[i] <= upperEdges[i - 1]) {
+			return false; // edges must be ascending
+		}
+	}
+
+	sample_rate = sampleRate;
+	fft_size = fftSize;
+	num_bands = numBands;
+
+	uint16_t firstBin = 1; // skip DC
+	for (uint8_t i = 0; i < numBands; i++) {
+		uint16_t endBin = binForFrequency(upperEdges[i]);
+		if (endBin < firstBin) {
+			endBin = firstBin; // band narrower than a bin
+		}
+		bands[i].firstBin = firstBin;
+		bands[i].endBin = endBin;
+		firstBin = endBin;
+	}
+	return true;
+}
+
+/* First bin with a centre frequency of at least frequency (deciHz)
+*   Clamped to the Nyquist bin, fftSize / 2.
+*/
+uint16_t Band_Map::binForFrequency(uint32_t frequency) const {
+	uint64_t step = (uint64_t)sample_rate * 10;
+	uint64_t bin = ((uint64_t)frequency * fft_size + step - 1) / step;
+	if (bin > fft_size / 2) {
+		bin = fft_size / 2;
+	}
+	return (uint16_t)bin;
+}
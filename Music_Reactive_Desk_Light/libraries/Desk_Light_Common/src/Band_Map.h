@@ -0,0 +1,73 @@
+/*
+ Name:		Band_Map.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Maps frequency bands onto FFT bins. The bin width and the bin range of every band
+ follow from the sample rate and the FFT size, so nothing has to be measured by hand.
+*/
+#ifndef Band_Map_H
+#define Band_Map_H
+
+#include <stdint.h>
+
+#define BAND_MAP_MAX_BANDS 8
+
+//! Range of FFT bins belonging to one band, firstBin up to but not including endBin
+struct Band_Range {
+	uint16_t firstBin;
+	uint16_t endBin;
+};
+
+/** Class Band_Map: bin ranges of adjacent frequency bands
+*
+*   Band i covers the bins with a centre frequency below upperEdges[i] that aren't in a lower band.
+*   The first band starts at bin 1, the DC bin is never part of a band. Frequencies are in deciHz.
+*/
+class Band_Map {
+
+public:
+
+	//! Constructor
+	/** Call configure() before using the map.
+	*/
+	Band_Map();
+
+	//! Derive the bin ranges
+	/** \param sampleRate sample rate in Hz.
+	*   \param fftSize number of samples per FFT.
+	*   \param upperEdges upper frequency of every band in deciHz, ascending.
+	*   \param numBands number of bands, at most BAND_MAP_MAX_BANDS.
+	*   \return false if the arguments are invalid, the map isn't changed then.
+	*/
+	bool configure(uint32_t sampleRate, uint32_t fftSize, const uint32_t* upperEdges, uint8_t numBands);
+
+	//! Width of one FFT bin in deciHz, rounded
+	uint32_t binWidth() const { return (uint32_t)(((uint64_t)sample_rate * 10 + fft_size / 2) / fft_size); }
+
+	//! Centre frequency of the bin in deciHz, rounded
+	uint32_t binFrequency(uint16_t bin) const { return (uint32_t)(((uint64_t)bin * sample_rate * 10 + fft_size / 2) / fft_size); }
+
+	//! First bin with a centre frequency of at least frequency (deciHz), at most the Nyquist bin
+	uint16_t binForFrequency(uint32_t frequency) const;
+
+	//! Bin range of the band
+	const Band_Range& band(uint8_t index) const { return bands[index]; }
+
+	//! Number of bands
+	uint8_t numBands() const { return num_bands; }
+
+	//! Sample rate in Hz
+	uint32_t sampleRate() const { return sample_rate; }
+
+	//! Number of samples per FFT
+	uint32_t fftSize() const { return fft_size; }
+
+private:
+	uint32_t sample_rate;
+	uint32_t fft_size;
+	uint8_t num_bands;
+	Band_Range bands[BAND_MAP_MAX_BANDS];
+};
+
+#endif // Band_Map_H
@@ -0,0 +1,25 @@
+/*
+ Name:		Dsp_Types.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: CMSIS DSP fixed point types. On the Teensy they come from arm_math.h,
+ a host build gets the same typedefs so the DSP code compiles on both.
+*/
+#ifndef Dsp_Types_H
+#define Dsp_Types_H
+
+#ifdef ARDUINO
+#include "arm_math.h"
+#else
+#include <stdint.h>
+
+typedef int8_t q7_t;
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+typedef int64_t q63_t;
+typedef float float32_t;
+typedef double float64_t;
+#endif
+
+#endif // Dsp_Types_H
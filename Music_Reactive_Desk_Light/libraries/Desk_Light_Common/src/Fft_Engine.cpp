@@ -0,0 +1,200 @@
+/*
+ Name:		Fft_Engine.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Real FFT with a small cache of plans.
+*/
+
+#include "Fft_Engine.h"
+#include <utility>
+
+#ifndef ARDUINO
+#include <math.h>
+#endif
+
+/* Constructor
+*   The cache starts empty, plans are built on first use.
+*/
+Fft_Engine::Fft_Engine() : num_plans(0), use_counter(0), plan_builds(0) {
+}
+
+/* Drop all plans
+*
+*/
+void Fft_Engine::clear() {
+	num_plans = 0;
+}
+
+/* Find the plan for this size and direction
+*   If it isn't cached a new plan is built, replacing the least recently used one when the cache is full.
+*/
+Fft_Engine::Plan* Fft_Engine::getPlan(uint32_t fftSize, bool inverse) {
+	use_counter++;
+
+	for (uint8_t i = 0; i < num_plans; i++) {
+		if (plans[i].size == fftSize && plans[i].inverse == inverse) {
+			plans[i].lastUse = use_counter;
+			return &plans[i];
+		}
+	}
+
+	Plan plan;
+	if (!buildPlan(plan, fftSize, inverse)) {
+		return nullptr; // unsupported size
+	}
+	plan_builds++;
+
+	uint8_t index = num_plans;
+	if (num_plans == FFT_ENGINE_MAX_PLANS) {
+		index = 0;
+		for (uint8_t i = 1; i < num_plans; i++) {
+			if (plans[i].lastUse < plans[index].lastUse) {
+				index = i;
+			}
+		}
+	}
+	else {
+		num_plans++;
+	}
+
+	plans[index] = std::move(plan);
+	plans[index].lastUse = use_counter;
+	return &plans[index];
+}
+
+bool Fft_Engine::transform(q15_t* input, q15_t* output, uint32_t fftSize, bool inverse) {
+	Plan* plan = getPlan(fftSize, inverse);
+	if (plan == nullptr) {
+		return false;
+	}
+
+#ifdef ARDUINO
+	arm_rfft_q15(&plan->instance, input, output);
+#else
+	const uint32_t n = fftSize;
+	const double scale = 2.0 / n; // arm_rfft_q15 downscales by fftSize / 2
+	work.resize(2 * n);
+
+	if (!inverse) {
+		for (uint32_t i = 0; i < n; i++) {
+			work[2 * i] = input[i];
+			work[2 * i + 1] = 0;
+		}
+	}
+	else {
+		// only bins 0 to n / 2 are used, the rest follows from conjugate symmetry
+		for (uint32_t k = 0; k <= n / 2; k++) {
+			work[2 * k] = input[2 * k];
+			work[2 * k + 1] = input[2 * k + 1];
+			if (k > 0 && k < n / 2) {
+				work[2 * (n - k)] = input[2 * k];
+				work[2 * (n - k) + 1] = -input[2 * k + 1];
+			}
+		}
+	}
+
+	complexFft(*plan, inverse);
+
+	uint32_t outputs = inverse ? n : 2 * n;
+	uint32_t stride = inverse ? 2 : 1; // the inverse keeps the real parts only
+	for (uint32_t i = 0; i < outputs; i++) {
+		double value = floor(work[i * stride] * scale + 0.5);
+		if (value > 32767) {
+			value = 32767;
+		}
+		else if (value < -32768) {
+			value = -32768;
+		}
+		output[i] = (q15_t)value;
+	}
+#endif
+	return true;
+}
+
+#ifdef ARDUINO
+/* Initialise the CMSIS instance
+*   arm_rfft_init_q15 only supports the sizes with precomputed tables.
+*/
+bool Fft_Engine::buildPlan(Plan& plan, uint32_t fftSize, bool inverse) {
+	if (arm_rfft_init_q15(&plan.instance, fftSize, inverse ? 1 : 0, 1) != ARM_MATH_SUCCESS) {
+		return false;
+	}
+	plan.size = fftSize;
+	plan.inverse = inverse;
+	return true;
+}
+#else
+/* Precompute the bit reversal permutation and the twiddle factors
+*   Sizes are limited to those of arm_rfft_q15, so the host and the Teensy accept the same input.
+*/
+bool Fft_Engine::buildPlan(Plan& plan, uint32_t fftSize, bool inverse) {
+	if (fftSize < 32 || fftSize > 8192 || (fftSize & (fftSize - 1)) != 0) {
+		return false;
+	}
+
+	uint32_t bits = 0;
+	while ((1u << bits) < fftSize) {
+		bits++;
+	}
+	plan.bitReverse.resize(fftSize);
+	for (uint32_t i = 0; i < fftSize; i++) {
+		uint32_t reversed = 0;
+		for (uint32_t b = 0; b < bits; b++) {
+			reversed |= ((i >> b) & 1) << (bits - 1 - b);
+		}
+		plan.bitReverse[i] = reversed;
+	}
+
+	plan.twiddles.resize(fftSize);
+	for (uint32_t k = 0; k < fftSize / 2; k++) {
+		double angle = 2 * M_PI * k / fftSize;
+		plan.twiddles[2 * k] = cos(angle);
+		plan.twiddles[2 * k + 1] = sin(angle);
+	}
+
+	plan.size = fftSize;
+	plan.inverse = inverse;
+	return true;
+}
+
+/* Iterative radix-2 decimation in time FFT of work
+*   Forward uses e^(-j 2 pi k n / N), inverse e^(+j 2 pi k n / N), neither is scaled.
+*/
+void Fft_Engine::complexFft(const Plan& plan, bool inverse) {
+	const uint32_t n = plan.size;
+	double* data = work.data();
+
+	for (uint32_t i = 0; i < n; i++) {
+		uint32_t j = plan.bitReverse[i];
+		if (j > i) {
+			double re = data[2 * i];
+			double im = data[2 * i + 1];
+			data[2 * i] = data[2 * j];
+			data[2 * i + 1] = data[2 * j + 1];
+			data[2 * j] = re;
+			data[2 * j + 1] = im;
+		}
+	}
+
+	const double sign = inverse ? 1 : -1;
+	for (uint32_t length = 2; length <= n; length <<= 1) {
+		uint32_t half = length >> 1;
+		uint32_t step = n / length; // twiddle index step for this stage
+		for (uint32_t start = 0; start < n; start += length) {
+			for (uint32_t k = 0; k < half; k++) {
+				double wr = plan.twiddles[2 * k * step];
+				double wi = sign * plan.twiddles[2 * k * step + 1];
+				double* a = data + 2 * (start + k);
+				double* b = data + 2 * (start + k + half);
+				double tr = b[0] * wr - b[1] * wi;
+				double ti = b[0] * wi + b[1] * wr;
+				b[0] = a[0] - tr;
+				b[1] = a[1] - ti;
+				a[0] += tr;
+				a[1] += ti;
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,99 @@
+/*
+ Name:		Fft_Engine.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Real FFT with a small cache of plans. A plan is built once per size and direction and reused
+ for every frame. On the Teensy the plans are CMSIS arm_rfft_instance_q15's, a host build uses a
+ reference implementation with the same data layout and scaling.
+*/
+#ifndef Fft_Engine_H
+#define Fft_Engine_H
+
+#include "Dsp_Types.h"
+
+#ifndef ARDUINO
+#include <vector>
+#endif
+
+#define FFT_ENGINE_MAX_PLANS 4 // plans kept at the same time, the least recently used one is replaced
+
+/** Class Fft_Engine: real FFT with plan cache
+*
+*   Data layout and scaling are those of arm_rfft_q15: the output holds fftSize complex values
+*   (real, imaginary interleaved) and the forward transform is downscaled by fftSize / 2,
+*   e.g. Q13.3 for 8192 points. The input buffer is used as scratch.
+*/
+class Fft_Engine {
+
+public:
+
+	//! Constructor
+	Fft_Engine();
+
+	//! Real FFT
+	/** \param input fftSize real samples, modified.
+	*   \param output 2 * fftSize values.
+	*   \param fftSize number of samples, a power of 2 from 32 to 8192.
+	*   \return false if the size isn't supported.
+	*/
+	bool rfft(q15_t* input, q15_t* output, uint32_t fftSize) {
+		return transform(input, output, fftSize, false);
+	}
+
+	//! Inverse real FFT
+	/** \param input 2 * fftSize values of a conjugate symmetric spectrum, modified.
+	*   \param output fftSize real samples, downscaled by fftSize / 2 like the forward transform.
+	*   \param fftSize number of samples, a power of 2 from 32 to 8192.
+	*   \return false if the size isn't supported.
+	*/
+	bool rifft(q15_t* input, q15_t* output, uint32_t fftSize) {
+		return transform(input, output, fftSize, true);
+	}
+
+	//! Number of plans built since construction
+	/** Stays constant while the same sizes are transformed, every increase is setup work on the hot path.
+	*/
+	uint32_t planBuilds() const { return plan_builds; }
+
+	//! Number of plans in the cache
+	uint8_t planCount() const { return num_plans; }
+
+	//! Drop all plans
+	void clear();
+
+private:
+	struct Plan {
+		uint32_t size;
+		bool inverse;
+		uint32_t lastUse; // for replacing the least recently used plan
+#ifdef ARDUINO
+		arm_rfft_instance_q15 instance;
+#else
+		std::vector<uint32_t> bitReverse; // bit reversed index of every complex sample
+		std::vector<double> twiddles; // cos, sin of 2 pi k / size for k < size / 2
+#endif
+	};
+
+	bool transform(q15_t* input, q15_t* output, uint32_t fftSize, bool inverse);
+
+	//! Find the plan, build it if it isn't cached
+	Plan* getPlan(uint32_t fftSize, bool inverse);
+
+	//! Initialise a plan for the size and direction
+	bool buildPlan(Plan& plan, uint32_t fftSize, bool inverse);
+
+	Plan plans[FFT_ENGINE_MAX_PLANS];
+	uint8_t num_plans;
+	uint32_t use_counter;
+	uint32_t plan_builds;
+
+#ifndef ARDUINO
+	//! Complex FFT of work in place, forward or inverse (without scaling)
+	void complexFft(const Plan& plan, bool inverse);
+
+	std::vector<double> work; // complex scratch buffer
+#endif
+};
+
+#endif // Fft_Engine_H
@@ -0,0 +1,33 @@
+/*
+ Name:		Frame_Telemetry.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Overrun counters of the pipeline and the compact telemetry record the desk light
+ reports them in.
+*/
+#ifndef Frame_Telemetry_H
+#define Frame_Telemetry_H
+
+#include <stdint.h>
+
+//! Counters of the pipeline since begin(), a frame is a hop of samples
+struct Frame_Counters {
+	uint32_t framesProduced; // hops of samples the capture produced, read by the pipeline or dropped
+	uint32_t framesProcessed; // hops the pipeline took from the capture and analysed
+	uint32_t windowsSkipped; // hops of samples the capture dropped, produced - processed - skipped are still buffered
+	uint32_t isrOverruns; // capture interrupts that couldn't store all their samples
+	uint32_t deadlineMisses; // hops that took longer to process than they last
+	uint32_t ledFrames; // led frames rendered
+	uint32_t ledFramesUnchanged; // led frames equal to the previous one, not sent to the strip
+};
+
+//! Periodic report of the counters, the payload of a TELEMETRY_TYPE::COUNTERS frame (see Telemetry_Protocol.h)
+struct __attribute__((packed)) Telemetry_Record {
+	uint16_t sequence; // incremented per record, a gap means records were lost
+	uint32_t millis; // time of the record
+	Frame_Counters counters;
+	uint16_t maxFillPercent; // highest fill level of the sample ring, in percent of its capacity
+};
+
+#endif // Frame_Telemetry_H
@@ -0,0 +1,39 @@
+/*
+ Name:		Pipeline_Params.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Parameters of the pipeline that can be changed while it runs, e.g. over the serial
+ command channel (see Command_Channel.h).
+*/
+#ifndef Pipeline_Params_H
+#define Pipeline_Params_H
+
+#include <stdint.h>
+#include "Dsp_Types.h"
+#include "Band_Map.h"
+#include "Spectrum_Bars.h"
+
+//! Visualizers of the Led_Renderer, in the order of Desk_Light_Effects (see Led_Effects.h)
+enum class LED_EFFECT : uint8_t {
+	VU_BARS, // a bar per band with peak markers
+	SPECTRUM, // the spectrum bars along the strip
+	BEAT_PULSE, // the whole strip flashes on bass beats
+	CENTER_MIRROR, // the loudest band grows from the centre to both ends
+	WATERFALL, // band colours scrolling along the strip
+	COUNT
+};
+
+//! Tunable parameters, see Audio_Pipeline::setParams()
+struct Pipeline_Params {
+	q31_t maxLevels[BAND_MAP_MAX_BANDS]; // level at which all leds of a band are on
+	uint32_t bandUpper[BAND_MAP_MAX_BANDS]; // upper edge of every band in deciHz, ascending
+	uint8_t numBands; // bands in use, fixed by the Pipeline_Config
+	uint8_t brightness; // global led brightness, 255 is full
+	uint16_t quietLeds; // a band with at most this many leds on is considered quiet and shown dark, 0 to show every level
+	uint8_t effect; // LED_EFFECT of a Led_Renderer
+	uint8_t spectrumBars; // bars of the spectrum in the band frames, 1 to SPECTRUM_BARS_MAX
+	uint8_t barSpacing; // BAR_SPACING of the spectrum bars
+};
+
+#endif // Pipeline_Params_H
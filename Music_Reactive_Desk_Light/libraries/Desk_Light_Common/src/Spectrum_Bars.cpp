@@ -0,0 +1,147 @@
+/*
+ Name:		Spectrum_Bars.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Log or mel spaced spectrum bars.
+*/
+
+#include "Spectrum_Bars.h"
+#include <math.h>
+#include <new>
+
+Spectrum_Bars::Spectrum_Bars() : weights(nullptr), first_bin(0), end_bin(0), num_bars(0), bar_spacing(BAR_SPACING::LOG), centres{}, segment_end{},
+	norm{}, floor_log2(0), scale(1) {
+	setRange(16, 8192);
+}
+
+Spectrum_Bars::~Spectrum_Bars() {
+	end();
+}
+
+void Spectrum_Bars::end() {
+	delete[] weights;
+	weights = nullptr;
+	first_bin = 0;
+	end_bin = 0;
+	num_bars = 0;
+}
+
+//! Position of a frequency on the scale of the spacing
+static float scalePosition(float frequency, BAR_SPACING spacing) {
+	return spacing == BAR_SPACING::MEL ? logf(1 + frequency / 7000) : logf(frequency); // mel up to a factor, frequency in deciHz
+}
+
+//! Frequency at a position of the scale
+static float scaleFrequency(float position, BAR_SPACING spacing) {
+	return spacing == BAR_SPACING::MEL ? (expf(position) - 1) * 7000 : expf(position);
+}
+
+/* Centres on the scale from lowEdge to the top of the spectrum, then the weights of every bin in between
+*   At low frequencies the scale is denser than the bins, there every centre is moved to one bin above the
+*   previous one. Centres pushed beyond the spectrum leave bars without bins, they stay dark.
+*   The weights are computed once here, so compute() needs no division and no search.
+*/
+bool Spectrum_Bars::begin(uint32_t sampleRate, uint32_t fftSize, uint32_t maxBin, uint16_t count, uint32_t lowEdge, BAR_SPACING spacing) {
+	if (sampleRate == 0 || fftSize < 4 || maxBin < 2 || maxBin > fftSize / 2 + 1 || count == 0 || count > SPECTRUM_BARS_MAX
+		|| spacing >= BAR_SPACING::COUNT) {
+		return false;
+	}
+	const float binDeciHz = sampleRate * 10.0f / fftSize;
+	const float low = lowEdge > binDeciHz ? lowEdge / binDeciHz : 1.0f; // never below bin 1, DC isn't shown
+	const float top = (float)maxBin; // the last bin still gets a share of the highest bar
+	if (low >= top) {
+		return false;
+	}
+	end();
+	first_bin = (uint16_t)ceilf(low);
+	end_bin = (uint16_t)maxBin;
+	weights = new (std::nothrow) uint16_t[end_bin - first_bin];
+	if (weights == nullptr) {
+		end();
+		return false;
+	}
+
+	const float start = scalePosition(low * binDeciHz, spacing);
+	const float step = (scalePosition(top * binDeciHz, spacing) - start) / (count + 1);
+	centres[0] = low;
+	for (uint16_t j = 1; j <= count; j++) {
+		float centre = scaleFrequency(start + j * step, spacing) / binDeciHz;
+		centre = centre > centres[j - 1] + 1 ? centre : centres[j - 1] + 1;
+		centres[j] = centre < top ? centre : top;
+	}
+	centres[count + 1] = top;
+
+	uint32_t area[SPECTRUM_BARS_MAX + 2] = {}; // sum of the weights of the low edge, every bar and the top
+	uint16_t k = first_bin;
+	for (uint16_t j = 0; j <= count; j++) {
+		uint32_t end = (uint32_t)ceilf(centres[j + 1]); // first bin at or above the next centre
+		end = end > k ? end : k;
+		end = end < end_bin ? end : end_bin;
+		for (; k < end; k++) {
+			const float upper = (k - centres[j]) / (centres[j + 1] - centres[j]);
+			long weight = lroundf(upper * 65536);
+			weight = weight < 65535 ? weight : 65535;
+			weights[k - first_bin] = (uint16_t)weight;
+			area[j] += 65536 - (uint32_t)weight;
+			area[j + 1] += (uint32_t)weight;
+		}
+		segment_end[j] = (uint16_t)end;
+	}
+	for (uint16_t i = 0; i < count; i++) {
+		norm[i] = area[i + 1] > 0 ? 1.0f / area[i + 1] : 0;
+	}
+	num_bars = count;
+	bar_spacing = spacing;
+	return true;
+}
+
+/* The segment of the bin gives its two bars, the bar above the segment gets the stored weight
+*
+*/
+float Spectrum_Bars::binWeight(uint16_t bar, uint32_t bin) const {
+	if (bin < first_bin || bin >= end_bin || bar >= num_bars) {
+		return 0;
+	}
+	uint16_t j = 0;
+	while (bin >= segment_end[j]) {
+		j++;
+	}
+	const float upper = weights[bin - first_bin] / 65536.0f;
+	return bar == j ? upper : bar + 1 == j ? 1 - upper : 0;
+}
+
+void Spectrum_Bars::setRange(uint32_t floor, uint32_t top) {
+	floor = floor > 0 ? floor : 1;
+	top = top > floor ? top : floor + 1;
+	floor_log2 = log2f((float)floor);
+	scale = 255.0f / (log2f((float)top) - floor_log2);
+}
+
+/* One pass over the bins, a segment of bins between two centres at a time
+*   Within a segment the bar above gets power * weight and the bar below power * (65536 - weight), so the sum of
+*   the powers and the weighted sum are all a segment needs, both stay in registers. A bin power is at most 2^31,
+*   with a 16 bit weight the 64 bit sums take any number of bins. One logarithm per bar, log2 of the magnitude
+*   is half that of the power.
+*/
+void Spectrum_Bars::compute(const q15_t* spectrum, uint8_t* levels) const {
+	uint64_t rising = 0; // weighted sum of the bar from the segment below its centre
+	uint32_t k = first_bin;
+	for (uint16_t j = 0; j <= num_bars; j++) {
+		uint64_t total = 0;
+		uint64_t weighted = 0;
+		for (; k < segment_end[j]; k++) {
+			const int32_t re = spectrum[2 * k];
+			const int32_t im = spectrum[2 * k + 1];
+			const uint32_t power = (uint32_t)(re * re) + (uint32_t)(im * im);
+			total += power;
+			weighted += (uint64_t)power * weights[k - first_bin];
+		}
+		if (j > 0) {
+			const float power = (float)(rising + (total << 16) - weighted) * norm[j - 1];
+			const float level = power > 0 ? (0.5f * log2f(power) - floor_log2) * scale : 0;
+			levels[j - 1] = level <= 0 ? 0 : level >= 255 ? 255 : (uint8_t)level;
+		}
+		rising = weighted;
+	}
+}
@@ -0,0 +1,101 @@
+/*
+ Name:		Spectrum_Bars.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: The spectrum condensed to up to 128 bands on a logarithmic or mel frequency scale, with
+ levels in dB mapped to 0 to 255. The input of the spectrum effects, one bar per led.
+*/
+#ifndef Spectrum_Bars_H
+#define Spectrum_Bars_H
+
+#include <stdint.h>
+#include "Dsp_Types.h"
+
+#define SPECTRUM_BARS_MAX 128
+
+//! Frequency scales the bars are spaced on
+enum class BAR_SPACING : uint8_t {
+	LOG, // equal ratio between neighbouring bars
+	MEL, // equal steps in mel, close to linear below 700 Hz
+	COUNT
+};
+
+/** Class Spectrum_Bars: log or mel spaced bars from the bins of a spectrum
+*
+*   Usage:
+*   \code
+*   bars.begin(40000, 8192, 1025, 117, 300, BAR_SPACING::LOG);
+*   bars.compute(stft.spectrum(), levels);
+*   \endcode
+*   The bar centres are count points evenly spaced on the scale between the low edge and the top of the
+*   spectrum, at least one bin apart. Every bar is a triangular filter from the centre of the bar below to the
+*   centre of the bar above, so a bin belongs to at most two neighbouring bars and the weights of a bin add up
+*   to 1. begin() stores the weight of the upper bar for every bin and where the bins between two centres end,
+*   compute() then walks the spectrum once. The level of a bar is its weighted mean power as a magnitude, in dB
+*   between the floor and the top of setRange(), 0 to 255.
+*/
+class Spectrum_Bars {
+
+public:
+
+	//! Constructor
+	Spectrum_Bars();
+
+	//! Destructor
+	~Spectrum_Bars();
+
+	//! Compute the bin weights of the bars
+	/** \param sampleRate sample rate in Hz.
+	*   \param fftSize number of samples per FFT.
+	*   \param maxBin number of bins of the spectrum, the upper edge of the last bar.
+	*   \param count number of bars, at most SPECTRUM_BARS_MAX.
+	*   \param lowEdge lower edge of the first bar in deciHz.
+	*   \param spacing frequency scale of the bar centres.
+	*   \return false if a parameter is out of range or the weight table can't be allocated.
+	*/
+	bool begin(uint32_t sampleRate, uint32_t fftSize, uint32_t maxBin, uint16_t count, uint32_t lowEdge, BAR_SPACING spacing);
+
+	//! Free the weight table
+	void end();
+
+	//! Magnitudes shown dark and at full level
+	/** \param floor magnitude of level 0, q15 bin magnitude.
+	*   \param top magnitude of level 255, above floor.
+	*/
+	void setRange(uint32_t floor, uint32_t top);
+
+	//! Levels of the bars
+	/** \param spectrum bins as real, imaginary pairs, the layout of Fft_Engine::rfft.
+	*   \param levels count() levels, 0 to 255.
+	*/
+	void compute(const q15_t* spectrum, uint8_t* levels) const;
+
+	//! Number of bars
+	uint16_t count() const { return num_bars; }
+
+	//! Frequency scale of the bars
+	BAR_SPACING spacing() const { return bar_spacing; }
+
+	//! Centre of a bar in bins, fractional
+	float centreBin(uint16_t bar) const { return centres[bar + 1]; }
+
+	//! Share of a bin's power that goes to a bar, 0 to 1
+	/** Between the first and the last centre the shares of a bin add up to 1.
+	*/
+	float binWeight(uint16_t bar, uint32_t bin) const;
+
+private:
+	uint16_t* weights; // weight of the bar above every bin from first_bin to end_bin in 1/65536, the bar below gets the rest
+	uint16_t first_bin;
+	uint16_t end_bin;
+	uint16_t num_bars;
+	BAR_SPACING bar_spacing;
+	float centres[SPECTRUM_BARS_MAX + 2]; // low edge, bar centres and top in bins
+	uint16_t segment_end[SPECTRUM_BARS_MAX + 1]; // end of the bins from centre j up to centre j + 1
+	float norm[SPECTRUM_BARS_MAX]; // 1 / the sum of the weights of a bar
+	float floor_log2; // log2 of the floor magnitude
+	float scale; // levels per octave of magnitude
+};
+
+#endif // Spectrum_Bars_H
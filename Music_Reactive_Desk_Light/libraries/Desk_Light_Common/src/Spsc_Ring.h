@@ -0,0 +1,222 @@
+/*
+ Name:		Spsc_Ring.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Lock-free single producer, single consumer ring buffer. The ADC interrupt writes blocks of
+ samples, the main loop reads them in blocks of its own size. No interrupts are disabled and nothing blocks.
+*/
+#ifndef Spsc_Ring_H
+#define Spsc_Ring_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+/** Class Spsc_Ring: lock-free ring buffer for one producer and one consumer
+*
+*   The producer only stores head, the consumer only stores tail. Both indices run freely and are masked
+*   on access, so head - tail is always the fill level, also after they wrap around 2^32.
+*   The producer publishes the items with a release store of head, the consumer sees them with an acquire load.
+*   The consumer frees the slots with a release store of tail, the producer checks it with an acquire load.
+*   When the ring is full, the producer drops the items it can't store and counts them, it never waits.
+*
+*   \tparam T trivially copyable item type.
+*   \tparam Capacity number of items, a power of 2.
+*/
+template <class T, uint32_t Capacity>
+class Spsc_Ring {
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+	static_assert(std::is_trivially_copyable<T>::value, "items are copied with memcpy");
+
+public:
+
+	//! Constructor
+	Spsc_Ring() : head(0), tail(0), items_written(0), items_dropped(0), write_overruns(0), max_fill(0) {
+	}
+
+	/*
+	* Producer side, e.g. the ADC interrupt
+	*/
+
+	//! Store one item
+	/** \return false if the ring is full, the item is dropped.
+	*/
+	bool push(const T& item) {
+		return write(&item, 1) == 1;
+	}
+
+	//! Store a block of items
+	/** Stores as many items as fit, the rest is dropped and counted.
+	*   \param data items to store.
+	*   \param count number of items.
+	*   \return number of items stored.
+	*/
+	uint32_t write(const T* data, uint32_t count) {
+		const uint32_t currentHead = head.load(std::memory_order_relaxed); // only written here
+		const uint32_t fill = currentHead - tail.load(std::memory_order_acquire);
+		uint32_t stored = Capacity - fill;
+		if (stored > count) {
+			stored = count;
+		}
+
+		copyIn(currentHead, data, stored);
+		head.store(currentHead + stored, std::memory_order_release);
+
+		items_written += stored;
+		if (stored < count) {
+			items_dropped += count - stored;
+			write_overruns++;
+		}
+		if (fill + stored > max_fill) {
+			max_fill = fill + stored;
+		}
+		return stored;
+	}
+
+	/*
+	* Consumer side, e.g. the main loop
+	*/
+
+	//! Number of items that can be read
+	uint32_t available() const {
+		return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+	}
+
+	//! Read up to count items
+	/** \param data destination.
+	*   \param count maximum number of items.
+	*   \return number of items read.
+	*/
+	uint32_t read(T* data, uint32_t count) {
+		const uint32_t currentTail = tail.load(std::memory_order_relaxed); // only written here
+		uint32_t taken = head.load(std::memory_order_acquire) - currentTail;
+		if (taken > count) {
+			taken = count;
+		}
+
+		copyOut(currentTail, data, taken);
+		tail.store(currentTail + taken, std::memory_order_release);
+		return taken;
+	}
+
+	//! Read exactly count items
+	/** \param data destination.
+	*   \param count number of items, at most Capacity.
+	*   \return false if fewer items are available, nothing is read then.
+	*/
+	bool readBlock(T* data, uint32_t count) {
+		const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+		if (head.load(std::memory_order_acquire) - currentTail < count) {
+			return false;
+		}
+
+		copyOut(currentTail, data, count);
+		tail.store(currentTail + count, std::memory_order_release);
+		return true;
+	}
+
+	//! Copy up to count items without reading them
+	/** With discard() the consumer can hand items on and keep those the next stage didn't take.
+	*   Consumer side only like read(): the items stay valid until the same thread discards them, a second
+	*   reader could free the slots in between and the producer overwrite them.
+	*   \param data destination.
+	*   \param count maximum number of items.
+	*   \return number of items copied.
+	*/
+	uint32_t peek(T* data, uint32_t count) const {
+		const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+		uint32_t taken = head.load(std::memory_order_acquire) - currentTail;
+		if (taken > count) {
+			taken = count;
+		}
+		copyOut(currentTail, data, taken);
+		return taken;
+	}
+
+	//! Read up to count items without copying them, e.g. those handed on after peek()
+	/** Consumer side only, by the thread that peeked.
+	*   \return number of items discarded.
+	*/
+	uint32_t discard(uint32_t count) {
+		const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+		uint32_t taken = head.load(std::memory_order_acquire) - currentTail;
+		if (taken > count) {
+			taken = count;
+		}
+		tail.store(currentTail + taken, std::memory_order_release);
+		return taken;
+	}
+
+	//! Discard all items that have been written
+	void clear() {
+		tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	/*
+	* Counters, written by the producer
+	*/
+
+	//! Number of items the ring can hold
+	static constexpr uint32_t capacity() { return Capacity; }
+
+	//! Number of items stored since the last reset
+	uint32_t itemsWritten() const { return items_written; }
+
+	//! Number of items dropped because the ring was full (overruns)
+	uint32_t itemsDropped() const { return items_dropped; }
+
+	//! Number of writes that dropped items
+	uint32_t overruns() const { return write_overruns; }
+
+	//! Highest fill level seen by the producer
+	uint32_t maxFill() const { return max_fill; }
+
+	//! Reset the counters
+	/** The producer may update a counter at the same time, call it while the producer is stopped for exact counts.
+	*/
+	void resetCounters() {
+		items_written = 0;
+		items_dropped = 0;
+		write_overruns = 0;
+		max_fill = 0;
+	}
+
+private:
+	static const uint32_t MASK = Capacity - 1;
+
+	//! Copy count items into the slots from index on, in two parts if they wrap
+	void copyIn(uint32_t index, const T* data, uint32_t count) {
+		const uint32_t first = index & MASK;
+		uint32_t part = Capacity - first;
+		if (part > count) {
+			part = count;
+		}
+		memcpy(buffer + first, data, part * sizeof(T));
+		memcpy(buffer, data + part, (count - part) * sizeof(T));
+	}
+
+	//! Copy count items out of the slots from index on
+	void copyOut(uint32_t index, T* data, uint32_t count) const {
+		const uint32_t first = index & MASK;
+		uint32_t part = Capacity - first;
+		if (part > count) {
+			part = count;
+		}
+		memcpy(data, buffer + first, part * sizeof(T));
+		memcpy(data + part, buffer, (count - part) * sizeof(T));
+	}
+
+	T buffer[Capacity];
+	std::atomic<uint32_t> head; // next slot to write, stored by the producer
+	std::atomic<uint32_t> tail; // next slot to read, stored by the consumer
+
+	// producer counters
+	volatile uint32_t items_written;
+	volatile uint32_t items_dropped;
+	volatile uint32_t write_overruns;
+	volatile uint32_t max_fill;
+};
+
+#endif // Spsc_Ring_H
@@ -0,0 +1,76 @@
+/*
+ Name:		Stage_Profiler.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Durations of the pipeline stages with percentile reporting.
+*/
+
+#include "Stage_Profiler.h"
+#include <string.h>
+
+/* Constructor
+*   Recording starts enabled, begin() starts the cycle counter.
+*/
+Stage_Profiler::Stage_Profiler() : enabled(true) {
+	memset(rings, 0, sizeof(rings));
+}
+
+void Stage_Profiler::begin() {
+#ifdef ARDUINO
+	ARM_DEMCR |= ARM_DEMCR_TRCENA;
+	ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
+#endif
+	memset(rings, 0, sizeof(rings));
+}
+
+uint32_t Stage_Profiler::ticksPerSecond() {
+#ifdef ARDUINO
+	return F_CPU_ACTUAL;
+#else
+	return 1000000000;
+#endif
+}
+
+/* Sort a copy of the ring, percentile p is the value at index ceil(p * count) - 1
+*   Insertion sort, the ring is small and this only runs when a report is asked for.
+*/
+Stage_Stats Stage_Profiler::stats(PIPELINE_STAGE stage) const {
+	const Stage_Ring& ring = rings[(uint8_t)stage];
+	Stage_Stats result = { 0, 0, 0, 0, 0 };
+	const uint32_t count = ring.count < STAGE_PROFILER_SAMPLES ? ring.count : STAGE_PROFILER_SAMPLES;
+	if (count == 0) {
+		return result;
+	}
+
+	uint32_t sorted[STAGE_PROFILER_SAMPLES];
+	for (uint32_t i = 0; i < count; i++) {
+		const uint32_t value = ring.ticks[i];
+		uint32_t j = i;
+		while (j > 0 && sorted[j - 1] > value) {
+			sorted[j] = sorted[j - 1];
+			j--;
+		}
+		sorted[j] = value;
+	}
+
+	result.count = count;
+	result.min = sorted[0];
+	result.p50 = sorted[(count * 50 + 99) / 100 - 1];
+	result.p99 = sorted[(count * 99 + 99) / 100 - 1];
+	result.max = sorted[count - 1];
+	return result;
+}
+
+const char* Stage_Profiler::stageName(PIPELINE_STAGE stage) {
+	switch (stage) {
+	case PIPELINE_STAGE::CAPTURE_WAIT: return "capture wait";
+	case PIPELINE_STAGE::COPY: return "copy";
+	case PIPELINE_STAGE::FFT: return "fft";
+	case PIPELINE_STAGE::BANDS: return "bands";
+	case PIPELINE_STAGE::LED_FILL: return "led fill";
+	case PIPELINE_STAGE::SHOW: return "show";
+	case PIPELINE_STAGE::FRAME: return "frame";
+	default: return "?";
+	}
+}
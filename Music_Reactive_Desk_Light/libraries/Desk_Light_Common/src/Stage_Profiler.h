@@ -0,0 +1,124 @@
+/*
+ Name:		Stage_Profiler.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Durations of the pipeline stages, kept in fixed size rings and reported as
+ min / p50 / p99 / max. Cheap enough to stay enabled on the desk light.
+*/
+#ifndef Stage_Profiler_H
+#define Stage_Profiler_H
+
+#include <stdint.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+#define STAGE_PROFILER_SAMPLES 256 // durations kept per stage, a power of 2
+
+//! Stages of a frame
+enum class PIPELINE_STAGE : uint8_t {
+	CAPTURE_WAIT, // end of the previous hop up to a complete hop
+	COPY, // samples from the source and into the STFT history
+	FFT, // window and transform
+	BANDS, // band powers and magnitudes, or the Goertzel filters
+	LED_FILL, // render the led frame
+	SHOW, // the led sink, FastLED.show() on the desk light
+	FRAME, // complete hop up to the end of the show
+	COUNT
+};
+
+//! Statistics of a stage in ticks, see Stage_Profiler::ticksPerSecond()
+struct Stage_Stats {
+	uint32_t count; // durations the statistics are taken from
+	uint32_t min;
+	uint32_t p50;
+	uint32_t p99;
+	uint32_t max;
+};
+
+/** Class Stage_Profiler: per stage timing without allocation
+*
+*   Usage:
+*   \code
+*   uint32_t start = Stage_Profiler::now();
+*   fft.transform(frame, output);
+*   start = profiler.lap(PIPELINE_STAGE::FFT, start);
+*   \endcode
+*   The clock is the DWT cycle counter on the Teensy (one tick per cpu cycle) and the monotonic clock
+*   in nanoseconds on the host. Ticks are 32 bit, a duration is the difference of two readings so the
+*   wrap around doesn't matter as long as a stage takes less than 2^32 ticks (7 s at 600 MHz).
+*   Every stage keeps the last STAGE_PROFILER_SAMPLES durations, recording is a clock read and a store.
+*   The statistics are only computed when stats() is called, that sorts a copy of the ring.
+*/
+class Stage_Profiler {
+
+public:
+
+	//! Constructor
+	Stage_Profiler();
+
+	//! Start the cycle counter and clear the rings
+	void begin();
+
+	//! Clock reading in ticks
+	static inline uint32_t now() {
+#ifdef ARDUINO
+		return ARM_DWT_CYCCNT;
+#else
+		return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	//! Clock ticks per second
+	static uint32_t ticksPerSecond();
+
+	//! Store a duration
+	void record(PIPELINE_STAGE stage, uint32_t ticks) {
+		if (!enabled) {
+			return;
+		}
+		Stage_Ring& ring = rings[(uint8_t)stage];
+		ring.ticks[ring.count & (STAGE_PROFILER_SAMPLES - 1)] = ticks;
+		ring.count++;
+	}
+
+	//! Store the time since start and return the current time as the start of the next stage
+	uint32_t lap(PIPELINE_STAGE stage, uint32_t start) {
+		const uint32_t time = now();
+		record(stage, time - start);
+		return time;
+	}
+
+	//! Statistics of the last STAGE_PROFILER_SAMPLES durations of a stage
+	Stage_Stats stats(PIPELINE_STAGE stage) const;
+
+	//! Number of durations recorded for a stage since begin()
+	uint32_t recorded(PIPELINE_STAGE stage) const { return rings[(uint8_t)stage].count; }
+
+	//! Pause or resume the recording
+	void setEnabled(bool on) { enabled = on; }
+
+	//! Recording or not
+	bool isEnabled() const { return enabled; }
+
+	//! Short name of a stage for reports
+	static const char* stageName(PIPELINE_STAGE stage);
+
+	//! Ticks in microseconds
+	static float toMicros(uint32_t ticks) { return ticks * (1e6f / ticksPerSecond()); }
+
+private:
+	//! Last durations of a stage
+	struct Stage_Ring {
+		uint32_t ticks[STAGE_PROFILER_SAMPLES];
+		uint32_t count; // durations written, the next goes to count % STAGE_PROFILER_SAMPLES
+	};
+
+	Stage_Ring rings[(uint8_t)PIPELINE_STAGE::COUNT];
+	bool enabled;
+};
+
+#endif // Stage_Profiler_H
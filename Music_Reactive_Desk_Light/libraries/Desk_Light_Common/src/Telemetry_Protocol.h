@@ -0,0 +1,104 @@
+/*
+ Name:		Telemetry_Protocol.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Binary telemetry of the desk light: frame layout, message types and payloads.
+ Shared by the sender on the Teensy (Telemetry_Writer) and the decoder of the host build.
+*/
+#ifndef Telemetry_Protocol_H
+#define Telemetry_Protocol_H
+
+#include <stdint.h>
+#include "Dsp_Types.h"
+#include "Stage_Profiler.h"
+#include "Frame_Telemetry.h"
+#include "Pipeline_Params.h"
+
+/*
+* A frame is
+*   type (1 byte) | sequence (1 byte) | payload (0 to TELEMETRY_MAX_PAYLOAD bytes) | crc (2 bytes)
+* COBS encoded and followed by a 0 byte. The 0 only appears as the delimiter, a receiver that starts in the
+* middle of the stream or loses bytes syncs on the next 0. The crc is CRC-16/CCITT-FALSE of type, sequence
+* and payload. The sequence counts every frame the sender queues, a gap means frames were lost.
+* All values are little endian, like the Teensy and the hosts.
+*/
+#define TELEMETRY_MAX_PAYLOAD 512
+#define TELEMETRY_MAX_FRAME (TELEMETRY_MAX_PAYLOAD + 4)
+#define TELEMETRY_MAX_ENCODED (TELEMETRY_MAX_FRAME + TELEMETRY_MAX_FRAME / 254 + 2) // COBS overhead and the delimiter
+
+//! Message types
+enum class TELEMETRY_TYPE : uint8_t {
+	BANDS = 1, // Telemetry_Frame_Header, then count q31_t band levels
+	LEDS = 2, // Telemetry_Frame_Header, then count uint16_t leds lit per band
+	SPECTRUM = 3, // Telemetry_Spectrum_Header, then bins uint16_t magnitudes
+	PROFILE = 4, // Telemetry_Profile_Header, then stages Telemetry_Stage
+	COUNTERS = 5, // Telemetry_Record
+	PARAMS = 6 // Telemetry_Params_Header, then bands Telemetry_Band_Params
+};
+
+//! Status of a PARAMS frame
+#define TELEMETRY_PARAMS_CURRENT 0 // answer to get, or the parameters a set will apply
+#define TELEMETRY_PARAMS_INVALID 1 // the command was rejected, the parameters are unchanged
+
+//! Start of the BANDS and LEDS payloads
+struct __attribute__((packed)) Telemetry_Frame_Header {
+	uint32_t frame; // led frame the values belong to
+	uint8_t count; // number of bands
+};
+
+//! Start of a SPECTRUM payload, a spectrum larger than a payload is sent in several chunks
+struct __attribute__((packed)) Telemetry_Spectrum_Header {
+	uint32_t frame; // led frame the spectrum belongs to
+	uint32_t binMilliHz; // width of a bin in mHz
+	uint16_t totalBins; // bins of the whole spectrum, before decimation
+	uint16_t firstBin; // first bin of this chunk, before decimation
+	uint16_t bins; // magnitudes in this chunk
+	uint8_t decimation; // bins per magnitude, the magnitude is the largest of them
+};
+
+//! Start of a PROFILE payload
+struct __attribute__((packed)) Telemetry_Profile_Header {
+	uint32_t ticksPerSecond; // unit of the durations, see Stage_Profiler::ticksPerSecond()
+	uint8_t stages;
+};
+
+//! Statistics of one stage in a PROFILE payload
+struct __attribute__((packed)) Telemetry_Stage {
+	uint8_t stage; // PIPELINE_STAGE
+	Stage_Stats stats;
+};
+
+//! Start of a PARAMS payload
+struct __attribute__((packed)) Telemetry_Params_Header {
+	uint8_t status; // TELEMETRY_PARAMS_CURRENT or TELEMETRY_PARAMS_INVALID
+	uint8_t brightness;
+	uint16_t quietLeds;
+	uint8_t effect; // LED_EFFECT
+	uint8_t spectrumBars;
+	uint8_t barSpacing; // BAR_SPACING
+	uint8_t bands;
+};
+
+//! Parameters of one band in a PARAMS payload
+struct __attribute__((packed)) Telemetry_Band_Params {
+	q31_t maxLevel;
+	uint32_t upperEdge; // deciHz
+};
+
+//! Update a CRC-16/CCITT-FALSE (polynomial 0x1021, start 0xFFFF) with a block of bytes
+/** \param crc crc so far, 0xFFFF for the first block.
+*   \param data bytes.
+*   \param count number of bytes.
+*   \return crc including data.
+*/
+inline uint16_t telemetryCrc(uint16_t crc, const uint8_t* data, uint32_t count) {
+	for (uint32_t i = 0; i < count; i++) {
+		uint8_t x = (uint8_t)(crc >> 8) ^ data[i];
+		x ^= x >> 4;
+		crc = (uint16_t)((crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x); // the 8 shift and xor steps folded
+	}
+	return crc;
+}
+
+#endif // Telemetry_Protocol_H
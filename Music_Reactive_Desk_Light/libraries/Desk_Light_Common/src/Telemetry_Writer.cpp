@@ -0,0 +1,184 @@
+/*
+ Name:		Telemetry_Writer.cpp
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Framing, COBS encoding and the non-blocking output of the telemetry.
+*/
+
+#include "Telemetry_Writer.h"
+#include <string.h>
+#include <math.h>
+
+#define TELEMETRY_PUMP_CHUNK 64 // bytes moved from the queue to the port at a time
+
+/* Constructor
+*   The stream starts with a delimiter, so a receiver that was listening before gets the first frame too.
+*/
+Telemetry_Writer::Telemetry_Writer() : sequence(0), frames_sent(0), frames_dropped(0) {
+	queue.push(0);
+}
+
+bool Telemetry_Writer::send(TELEMETRY_TYPE type, const void* payload, uint32_t length) {
+	if (length > TELEMETRY_MAX_PAYLOAD) {
+		frames_dropped++;
+		return false;
+	}
+	memcpy(frame + 2, payload, length);
+	return queueFrame(type, length);
+}
+
+bool Telemetry_Writer::sendBands(uint32_t frameNumber, const q31_t* levels, uint8_t count) {
+	const Telemetry_Frame_Header header = { frameNumber, count };
+	const uint32_t length = sizeof(header) + count * sizeof(q31_t);
+	if (length > TELEMETRY_MAX_PAYLOAD) {
+		frames_dropped++;
+		return false;
+	}
+	memcpy(frame + 2, &header, sizeof(header));
+	memcpy(frame + 2 + sizeof(header), levels, count * sizeof(q31_t));
+	return queueFrame(TELEMETRY_TYPE::BANDS, length);
+}
+
+bool Telemetry_Writer::sendLeds(uint32_t frameNumber, const uint16_t* ledsOn, uint8_t count) {
+	const Telemetry_Frame_Header header = { frameNumber, count };
+	const uint32_t length = sizeof(header) + count * sizeof(uint16_t);
+	if (length > TELEMETRY_MAX_PAYLOAD) {
+		frames_dropped++;
+		return false;
+	}
+	memcpy(frame + 2, &header, sizeof(header));
+	memcpy(frame + 2 + sizeof(header), ledsOn, count * sizeof(uint16_t));
+	return queueFrame(TELEMETRY_TYPE::LEDS, length);
+}
+
+/* Magnitude of every group of decimation bins, the largest in the group so peaks survive the decimation
+*   Compares the powers and takes one square root per group. A q15 magnitude is at most 46341, it fits 16 bits.
+*   Chunks hold as many magnitudes as fit in a payload, every chunk is a frame of its own.
+*/
+bool Telemetry_Writer::sendSpectrum(uint32_t frameNumber, const q15_t* spectrum, uint32_t bins, uint32_t binMilliHz, uint8_t decimation) {
+	if (decimation == 0) {
+		decimation = 1;
+	}
+	if (bins > UINT16_MAX) {
+		bins = UINT16_MAX;
+	}
+	const uint32_t perChunk = (TELEMETRY_MAX_PAYLOAD - sizeof(Telemetry_Spectrum_Header)) / sizeof(uint16_t);
+	const uint32_t magnitudes = (bins + decimation - 1) / decimation;
+	bool complete = true;
+
+	for (uint32_t first = 0; first < magnitudes; first += perChunk) {
+		const uint32_t count = magnitudes - first < perChunk ? magnitudes - first : perChunk;
+		const Telemetry_Spectrum_Header header = { frameNumber, binMilliHz, (uint16_t)bins, (uint16_t)(first * decimation), (uint16_t)count,
+			decimation };
+		memcpy(frame + 2, &header, sizeof(header));
+		uint8_t* output = frame + 2 + sizeof(header);
+
+		for (uint32_t m = 0; m < count; m++) {
+			const uint32_t start = (first + m) * decimation;
+			const uint32_t end = start + decimation < bins ? start + decimation : bins;
+			uint32_t peak = 0;
+			for (uint32_t k = start; k < end; k++) {
+				const int32_t re = spectrum[2 * k];
+				const int32_t im = spectrum[2 * k + 1];
+				const uint32_t power = (uint32_t)(re * re) + (uint32_t)(im * im);
+				peak = power > peak ? power : peak;
+			}
+			const uint16_t magnitude = (uint16_t)sqrtf((float)peak);
+			memcpy(output + m * sizeof(uint16_t), &magnitude, sizeof(magnitude));
+		}
+		complete &= queueFrame(TELEMETRY_TYPE::SPECTRUM, sizeof(header) + count * sizeof(uint16_t));
+	}
+	return complete;
+}
+
+bool Telemetry_Writer::sendProfile(const Stage_Profiler& profiler) {
+	const Telemetry_Profile_Header header = { Stage_Profiler::ticksPerSecond(), (uint8_t)PIPELINE_STAGE::COUNT };
+	memcpy(frame + 2, &header, sizeof(header));
+	uint8_t* output = frame + 2 + sizeof(header);
+	for (uint8_t s = 0; s < (uint8_t)PIPELINE_STAGE::COUNT; s++) {
+		Telemetry_Stage stage;
+		stage.stage = s;
+		stage.stats = profiler.stats((PIPELINE_STAGE)s);
+		memcpy(output + s * sizeof(stage), &stage, sizeof(stage));
+	}
+	return queueFrame(TELEMETRY_TYPE::PROFILE, sizeof(header) + (uint8_t)PIPELINE_STAGE::COUNT * sizeof(Telemetry_Stage));
+}
+
+bool Telemetry_Writer::sendCounters(const Telemetry_Record& record) {
+	return send(TELEMETRY_TYPE::COUNTERS, &record, sizeof(record));
+}
+
+bool Telemetry_Writer::sendParams(const Pipeline_Params& params, uint8_t status) {
+	const Telemetry_Params_Header header = { status, params.brightness, params.quietLeds, params.effect, params.spectrumBars, params.barSpacing,
+		params.numBands };
+	memcpy(frame + 2, &header, sizeof(header));
+	uint8_t* output = frame + 2 + sizeof(header);
+	for (uint8_t b = 0; b < params.numBands; b++) {
+		const Telemetry_Band_Params band = { params.maxLevels[b], params.bandUpper[b] };
+		memcpy(output + b * sizeof(band), &band, sizeof(band));
+	}
+	return queueFrame(TELEMETRY_TYPE::PARAMS, sizeof(header) + params.numBands * sizeof(Telemetry_Band_Params));
+}
+
+/* COBS: every run of up to 254 non-zero bytes is preceded by a code byte, its length + 1. A code below 0xFF
+*   stands for the run followed by a 0, so no 0 is left in the encoded frame and a single 0 ends it.
+*   The frame is only queued if it fits whole, the sequence number advances either way.
+*/
+bool Telemetry_Writer::queueFrame(TELEMETRY_TYPE type, uint32_t length) {
+	frame[0] = (uint8_t)type;
+	frame[1] = sequence++;
+	const uint16_t crc = telemetryCrc(0xFFFF, frame, length + 2);
+	frame[length + 2] = (uint8_t)crc;
+	frame[length + 3] = (uint8_t)(crc >> 8);
+	length += 4;
+
+	uint32_t code = 0; // position of the code byte of the current run
+	uint32_t size = 1;
+	for (uint32_t i = 0; i < length; i++) {
+		if (frame[i] == 0) {
+			encoded[code] = (uint8_t)(size - code);
+			code = size++;
+		}
+		else {
+			encoded[size++] = frame[i];
+			if (size - code == 0xFF) {
+				encoded[code] = 0xFF;
+				code = size++;
+			}
+		}
+	}
+	encoded[code] = (uint8_t)(size - code);
+	encoded[size++] = 0;
+
+	if (queue.capacity() - queue.available() < size) {
+		frames_dropped++;
+		return false;
+	}
+	queue.write(encoded, size);
+	frames_sent++;
+	return true;
+}
+
+/* Bytes leave the queue only once the port has taken them
+*   A port may write fewer bytes than it said it could take, the rest stays queued for the next pump()
+*   instead of being lost in the middle of a frame.
+*/
+uint32_t Telemetry_Writer::pump(Telemetry_Port& port) {
+	uint32_t written = 0;
+	uint8_t chunk[TELEMETRY_PUMP_CHUNK];
+	while (true) {
+		uint32_t count = port.writable();
+		count = count < TELEMETRY_PUMP_CHUNK ? count : TELEMETRY_PUMP_CHUNK;
+		count = queue.peek(chunk, count);
+		if (count == 0) {
+			return written;
+		}
+		const uint32_t taken = port.write(chunk, count);
+		queue.discard(taken);
+		written += taken;
+		if (taken < count) {
+			return written; // the port is full
+		}
+	}
+}
@@ -0,0 +1,120 @@
+/*
+ Name:		Telemetry_Writer.h
+ Created:	10/16/2026
+ Author:	lesley wagner
+
+ Description: Sender of the binary telemetry. Frames are encoded into a queue and leave it only as fast
+ as the port can take them, so the analysis loop never waits for the serial port.
+*/
+#ifndef Telemetry_Writer_H
+#define Telemetry_Writer_H
+
+#include <stdint.h>
+#include "Dsp_Types.h"
+#include "Spsc_Ring.h"
+#include "Telemetry_Protocol.h"
+
+#define TELEMETRY_QUEUE_SIZE 4096 // bytes of encoded frames waiting for the port, a power of 2
+
+/** Class Telemetry_Port: byte output of the telemetry, e.g. the USB serial port
+*/
+class Telemetry_Port {
+
+public:
+
+	virtual ~Telemetry_Port() {}
+
+	//! Number of bytes write() takes without blocking
+	virtual uint32_t writable() = 0;
+
+	//! Write bytes
+	/** \param data bytes.
+	*   \param count number of bytes, at most writable().
+	*   \return number of bytes written.
+	*/
+	virtual uint32_t write(const uint8_t* data, uint32_t count) = 0;
+};
+
+/** Class Telemetry_Writer: framed telemetry without blocking
+*
+*   Usage:
+*   \code
+*   if (pipeline.process()) {
+*       telemetry.sendBands(frame, levels, Config::numBands);
+*   }
+*   telemetry.pump(port);
+*   \endcode
+*   The send functions encode a frame (see Telemetry_Protocol.h) into the queue. A frame that doesn't fit
+*   is dropped whole and counted, the receiver sees the gap in the sequence numbers. pump() moves as many
+*   queued bytes to the port as it takes without blocking, call it once per loop.
+*/
+class Telemetry_Writer {
+
+public:
+
+	//! Constructor
+	Telemetry_Writer();
+
+	//! Queue a frame
+	/** \param type message type.
+	*   \param payload payload bytes.
+	*   \param length payload length, at most TELEMETRY_MAX_PAYLOAD.
+	*   \return false if the frame was dropped because the queue is full or the payload is too long.
+	*/
+	bool send(TELEMETRY_TYPE type, const void* payload, uint32_t length);
+
+	//! Queue the band levels of a frame
+	bool sendBands(uint32_t frame, const q31_t* levels, uint8_t count);
+
+	//! Queue the leds lit per band of a frame
+	bool sendLeds(uint32_t frame, const uint16_t* ledsOn, uint8_t count);
+
+	//! Queue the magnitudes of a spectrum, in as many frames as needed
+	/** \param frame led frame of the spectrum.
+	*   \param spectrum bins as real, imaginary pairs, the layout of Fft_Engine::rfft.
+	*   \param bins number of bins.
+	*   \param binMilliHz width of a bin in mHz.
+	*   \param decimation bins per magnitude, 1 for the full spectrum.
+	*   \return false if a chunk was dropped.
+	*/
+	bool sendSpectrum(uint32_t frame, const q15_t* spectrum, uint32_t bins, uint32_t binMilliHz, uint8_t decimation);
+
+	//! Queue the statistics of every stage
+	bool sendProfile(const Stage_Profiler& profiler);
+
+	//! Queue a counters record
+	bool sendCounters(const Telemetry_Record& record);
+
+	//! Queue the tunable parameters
+	/** \param params parameters, e.g. Audio_Pipeline::params().
+	*   \param status TELEMETRY_PARAMS_CURRENT or TELEMETRY_PARAMS_INVALID for a rejected command.
+	*/
+	bool sendParams(const Pipeline_Params& params, uint8_t status);
+
+	//! Move queued bytes to the port, as many as it takes without blocking
+	/** \return number of bytes written.
+	*/
+	uint32_t pump(Telemetry_Port& port);
+
+	//! Bytes waiting for the port
+	uint32_t queued() const { return queue.available(); }
+
+	//! Frames queued since construction
+	uint32_t framesSent() const { return frames_sent; }
+
+	//! Frames dropped because the queue was full
+	uint32_t framesDropped() const { return frames_dropped; }
+
+private:
+	//! Add type, sequence and crc to the payload in frame[], encode and queue it
+	bool queueFrame(TELEMETRY_TYPE type, uint32_t length);
+
+	Spsc_Ring<uint8_t, TELEMETRY_QUEUE_SIZE> queue; // producer and consumer are both the loop, the ring keeps the copies simple
+	uint8_t frame[TELEMETRY_MAX_FRAME]; // type, sequence, payload and crc of the frame being built
+	uint8_t encoded[TELEMETRY_MAX_ENCODED];
+	uint8_t sequence;
+	uint32_t frames_sent;
+	uint32_t frames_dropped;
+};
+
+#endif // Telemetry_Writer_H